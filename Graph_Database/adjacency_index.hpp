@@ -0,0 +1,431 @@
+#ifndef ADJACENCY_INDEX_HPP
+#define ADJACENCY_INDEX_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <span>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Compressed sparse row (CSR) index of edges grouped by their source vertex.
+ * @note Edges of the i-th vertex are the indices targets[offsets[i]] .. targets[offsets[i + 1]] in insertion order.
+ * @note New edges go to a delta buffer first, which is merged into the CSR arrays on the next read.
+ * The merge is guarded by a mutex behind an atomic flag, so any number of threads may read an index
+ * which is not being modified, the first of them merges and the others wait for it.
+ * @note A sorted index orders the edges of every vertex by a key given with each edge, ties by the edge index,
+ * and keeps the keys in an array parallel to the targets.
+ * @note A merge of k edges costs O(k) when they extend the last rows. Otherwise every touched row of degree d
+ * is copied out of the CSR arrays once and patched in O(d + k), and the arrays are only rebuilt in O(V + E)
+ * once the patched edges exceed 1/rebuild_ratio of V + E, so interleaved inserts and reads stay linear overall.
+ */
+class adjacency_index {
+public:
+    /**
+     * @param sorted Whether the edges of a vertex are ordered by their keys rather than by insertion.
+     */
+    explicit adjacency_index(bool sorted = false) : sorted(sorted) {}
+
+    adjacency_index(const adjacency_index& other) : sorted(other.sorted)
+    {
+        other.merge();
+        offsets = other.offsets;
+        targets = other.targets;
+        keys = other.keys;
+        patch_slot = other.patch_slot;
+        patches = other.patches;
+        patched_edges = other.patched_edges;
+    }
+
+    adjacency_index(adjacency_index&& other) noexcept
+        : offsets(std::move(other.offsets)), targets(std::move(other.targets)), keys(std::move(other.keys)),
+        patch_slot(std::move(other.patch_slot)), patches(std::move(other.patches)), patched_edges(other.patched_edges),
+        delta(std::move(other.delta)), pending(other.pending.load(std::memory_order_relaxed)), sorted(other.sorted)
+    {
+    }
+
+    adjacency_index& operator=(const adjacency_index& other)
+    {
+        if (this != &other) {
+            adjacency_index copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    adjacency_index& operator=(adjacency_index&& other) noexcept
+    {
+        offsets = std::move(other.offsets);
+        targets = std::move(other.targets);
+        keys = std::move(other.keys);
+        patch_slot = std::move(other.patch_slot);
+        patches = std::move(other.patches);
+        patched_edges = other.patched_edges;
+        delta = std::move(other.delta);
+        pending.store(other.pending.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        sorted = other.sorted;
+        return *this;
+    }
+
+    /**
+     * @brief Registers a new vertex without any edges.
+     */
+    void add_vertex()
+    {
+        offsets.push_back(offsets.back());
+    }
+
+    /**
+     * @brief Registers n new vertexes without any edges at once.
+     */
+    void add_vertices(size_t n)
+    {
+        size_t last = offsets.back();
+        offsets.resize(offsets.size() + n, last);
+    }
+
+    /**
+     * @brief Preallocates the arrays for the given total number of vertexes and edges.
+     */
+    void reserve(size_t vertices, size_t edges)
+    {
+        offsets.reserve(vertices + 1);
+        targets.reserve(edges);
+        if (sorted) {
+            keys.reserve(edges);
+        }
+    }
+
+    /**
+     * @brief Registers a new edge going from the vertex src.
+     * @param src A dense index of the source vertex.
+     * @param edge A dense index of the edge.
+     * @param key The sort key of the edge, ignored unless the index is sorted.
+     */
+    void add_edge(size_t src, size_t edge, size_t key = 0)
+    {
+        delta.push_back({ src, edge, key });
+        pending.store(true, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns the dense indices of all forward edges of the vertex v in insertion order, or by key if sorted.
+     */
+    std::span<const size_t> neighbors(size_t v) const
+    {
+        merge();
+        if (const patched_row* row = patch_of(v)) {
+            return row->targets;
+        }
+        return std::span<const size_t>(targets.data() + offsets[v], targets.data() + offsets[v + 1]);
+    }
+
+    /**
+     * @brief Returns the keys of the edges of the vertex v in non-decreasing order, available if the index is sorted.
+     */
+    std::span<const size_t> neighbor_keys(size_t v) const
+    {
+        merge();
+        if (const patched_row* row = patch_of(v)) {
+            return row->keys;
+        }
+        return std::span<const size_t>(keys.data() + offsets[v], keys.data() + offsets[v + 1]);
+    }
+
+    /**
+     * @brief Checks whether the edges of every vertex are ordered by their keys.
+     */
+    bool is_sorted() const
+    {
+        return sorted;
+    }
+
+    /**
+     * @brief Returns the number of forward edges of the vertex v.
+     */
+    size_t degree(size_t v) const
+    {
+        return neighbors(v).size();
+    }
+
+    /**
+     * @brief Returns the number of registered vertexes.
+     */
+    size_t vertex_count() const
+    {
+        return offsets.size() - 1;
+    }
+
+    /**
+     * @brief Returns the offsets of the whole index in CSR form, offsets[v] is the position of the first edge of v
+     * in targets_array().
+     * @note It is a copy, the patched rows leave the stored arrays as they are, read single rows with neighbors().
+     */
+    std::vector<size_t> offsets_array() const
+    {
+        merge();
+        std::vector<size_t> result(offsets.size(), 0);
+        for (size_t v = 0; v < vertex_count(); ++v) {
+            result[v + 1] = result[v] + neighbors(v).size();
+        }
+        return result;
+    }
+
+    /**
+     * @brief Returns the edge indices of the whole index grouped by the source vertex, see offsets_array().
+     */
+    std::vector<size_t> targets_array() const
+    {
+        merge();
+        if (patches.empty()) {
+            return targets;
+        }
+        std::vector<size_t> result;
+        result.reserve(targets.size() + patched_edges);
+        for (size_t v = 0; v < vertex_count(); ++v) {
+            std::span<const size_t> row = neighbors(v);
+            result.insert(result.end(), row.begin(), row.end());
+        }
+        return result;
+    }
+
+    /**
+     * @brief Replaces the whole index of an unsorted index with already built CSR arrays.
+     */
+    void assign(std::vector<size_t> new_offsets, std::vector<size_t> new_targets)
+    {
+        offsets = std::move(new_offsets);
+        targets = std::move(new_targets);
+        patch_slot.clear();
+        patches.clear();
+        patched_edges = 0;
+        delta.clear();
+        pending.store(false, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Merges the delta buffer into the CSR arrays.
+     * @note Safe to call from concurrent readers, see the class notes.
+     */
+    void merge() const
+    {
+        if (!pending.load(std::memory_order_acquire)) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(merge_mutex);
+        if (!pending.load(std::memory_order_relaxed)) {
+            return;
+        }
+        if (patches.empty() && is_append_only()) {
+            append_delta();
+        }
+        else if ((patched_edges + delta.size()) * rebuild_ratio > vertex_count() + targets.size()) {
+            rebuild_with_delta();
+        }
+        else {
+            patch_delta();
+        }
+        if (sorted) {
+            sort_delta_vertices();
+        }
+        delta.clear();
+        pending.store(false, std::memory_order_release);
+    }
+
+private:
+    struct delta_edge {
+        size_t src;
+        size_t edge;
+        size_t key;
+    };
+
+    /**
+     * @brief A row moved out of the CSR arrays to take new edges, until the next rebuild.
+     */
+    struct patched_row {
+        std::vector<size_t> targets;
+        std::vector<size_t> keys;
+    };
+
+    static constexpr size_t npos = static_cast<size_t>(-1);
+    static constexpr size_t rebuild_ratio = 8;
+
+    const patched_row* patch_of(size_t v) const
+    {
+        return v < patch_slot.size() && patch_slot[v] != npos ? &patches[patch_slot[v]] : nullptr;
+    }
+
+    /**
+     * @brief Checks whether the delta only adds edges behind the last edge of the CSR arrays.
+     * @note It is the case of ingesting edges grouped by the source vertex.
+     */
+    bool is_append_only() const
+    {
+        size_t last = delta.front().src;
+        if (offsets[last + 1] != targets.size()) {
+            return false;
+        }
+        for (auto&& [src, e, key] : delta) {
+            if (src < last) {
+                return false;
+            }
+            last = src;
+        }
+        return true;
+    }
+
+    void append_delta() const
+    {
+        size_t first = delta.front().src;
+        size_t d = 0;
+        for (size_t v = first; v < vertex_count(); ++v) {
+            for (; d < delta.size() && delta[d].src == v; ++d) {
+                targets.push_back(delta[d].edge);
+                if (sorted) {
+                    keys.push_back(delta[d].key);
+                }
+            }
+            offsets[v + 1] = targets.size();
+        }
+    }
+
+    /**
+     * @brief Appends the delta to the rows it touches, moving each of them out of the CSR arrays first.
+     */
+    void patch_delta() const
+    {
+        patch_slot.resize(vertex_count(), npos);
+        for (auto&& [src, e, key] : delta) {
+            if (patch_slot[src] == npos) {
+                patch_slot[src] = patches.size();
+                patched_row& row = patches.emplace_back();
+                auto first = static_cast<std::ptrdiff_t>(offsets[src]);
+                auto last = static_cast<std::ptrdiff_t>(offsets[src + 1]);
+                row.targets.assign(targets.begin() + first, targets.begin() + last);
+                if (sorted) {
+                    row.keys.assign(keys.begin() + first, keys.begin() + last);
+                }
+            }
+            patched_row& row = patches[patch_slot[src]];
+            row.targets.push_back(e);
+            if (sorted) {
+                row.keys.push_back(key);
+            }
+        }
+        patched_edges += delta.size();
+    }
+
+    /**
+     * @brief Builds new CSR arrays of the patched rows, the other rows and the delta.
+     */
+    void rebuild_with_delta() const
+    {
+        size_t n = vertex_count();
+        std::vector<size_t> new_offsets(n + 1, 0);
+        for (size_t v = 0; v < n; ++v) {
+            const patched_row* row = patch_of(v);
+            new_offsets[v + 1] = row != nullptr ? row->targets.size() : offsets[v + 1] - offsets[v];
+        }
+        for (auto&& [src, e, key] : delta) {
+            ++new_offsets[src + 1];
+        }
+        for (size_t v = 0; v < n; ++v) {
+            new_offsets[v + 1] += new_offsets[v];
+        }
+
+        std::vector<size_t> new_targets(new_offsets[n]);
+        std::vector<size_t> new_keys(sorted ? new_targets.size() : 0);
+        std::vector<size_t> cursor(n);
+        for (size_t v = 0; v < n; ++v) {
+            size_t pos = new_offsets[v];
+            if (const patched_row* row = patch_of(v)) {
+                for (size_t i = 0; i < row->targets.size(); ++i, ++pos) {
+                    new_targets[pos] = row->targets[i];
+                    if (sorted) {
+                        new_keys[pos] = row->keys[i];
+                    }
+                }
+            }
+            else {
+                for (size_t i = offsets[v]; i < offsets[v + 1]; ++i, ++pos) {
+                    new_targets[pos] = targets[i];
+                    if (sorted) {
+                        new_keys[pos] = keys[i];
+                    }
+                }
+            }
+            cursor[v] = pos;
+        }
+        for (auto&& [src, e, key] : delta) {
+            if (sorted) {
+                new_keys[cursor[src]] = key;
+            }
+            new_targets[cursor[src]++] = e;
+        }
+
+        offsets = std::move(new_offsets);
+        targets = std::move(new_targets);
+        keys = std::move(new_keys);
+        patch_slot.clear();
+        patches.clear();
+        patched_edges = 0;
+    }
+
+    /**
+     * @brief Restores the order of the vertexes the delta added to, whose new edges follow their old ones.
+     * @note The new edges are sorted and merged with the old ones, so a vertex costs O(d + k log k) for k new edges.
+     */
+    void sort_delta_vertices() const
+    {
+        std::vector<size_t> sources(delta.size());
+        for (size_t d = 0; d < delta.size(); ++d) {
+            sources[d] = delta[d].src;
+        }
+        std::sort(sources.begin(), sources.end());
+        std::vector<std::pair<size_t, size_t>> entries;
+        for (size_t d = 0; d < sources.size();) {
+            size_t v = sources[d];
+            size_t added = 0;
+            for (; d < sources.size() && sources[d] == v; ++d) {
+                ++added;
+            }
+            size_t* row_keys = keys.data() + offsets[v];
+            size_t* row_targets = targets.data() + offsets[v];
+            size_t length = offsets[v + 1] - offsets[v];
+            if (v < patch_slot.size() && patch_slot[v] != npos) {
+                patched_row& row = patches[patch_slot[v]];
+                row_keys = row.keys.data();
+                row_targets = row.targets.data();
+                length = row.targets.size();
+            }
+            entries.clear();
+            for (size_t i = 0; i < length; ++i) {
+                entries.emplace_back(row_keys[i], row_targets[i]);
+            }
+            auto middle = entries.end() - static_cast<std::ptrdiff_t>(added);
+            std::sort(middle, entries.end());
+            std::inplace_merge(entries.begin(), middle, entries.end());
+            for (size_t i = 0; i < length; ++i) {
+                row_keys[i] = entries[i].first;
+                row_targets[i] = entries[i].second;
+            }
+        }
+    }
+
+    mutable std::vector<size_t> offsets = { 0 };
+    mutable std::vector<size_t> targets;
+    mutable std::vector<size_t> keys;
+    // The slot in patches of every vertex whose row moved there, npos for the rows still in the arrays above.
+    mutable std::vector<size_t> patch_slot;
+    mutable std::vector<patched_row> patches;
+    mutable size_t patched_edges = 0;
+    mutable std::vector<delta_edge> delta;
+    // Set while the delta holds edges, readers only take the mutex then.
+    mutable std::atomic<bool> pending = false;
+    mutable std::mutex merge_mutex;
+    bool sorted = false;
+};
+
+#endif // !ADJACENCY_INDEX_HPP
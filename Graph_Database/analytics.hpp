@@ -0,0 +1,300 @@
+#ifndef ANALYTICS_HPP
+#define ANALYTICS_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "graph_db.hpp"
+#include "simd_kernels.hpp"
+#include "thread_pool.hpp"
+#include "traversal.hpp"
+
+/**
+ * @brief Parallel pull-based PageRank.
+ * @param db The database.
+ * @param damping The probability of following an edge rather than jumping to a random vertex.
+ * @param max_iterations The maximal number of power iterations.
+ * @param tolerance The iterations stop once the L1 distance of two consecutive rank vectors drops below it.
+ * @param pool The threads to run on.
+ * @return The rank of every vertex by its dense index, they sum up to 1 over the live vertexes, removed ones rank 0.
+ * @note Every vertex sums the contributions of its incoming edges into the second of two rank arrays,
+ * so the threads never write to shared data and need no atomics. Incoming edges come from the reverse index
+ * of the database if the schema enables it, otherwise it is built once. The rank of vertexes without
+ * outgoing edges is spread evenly over all vertexes. Removed edges are not followed.
+ */
+template<class GraphSchema>
+std::vector<double> pagerank(const graph_db<GraphSchema>& db, double damping = 0.85, size_t max_iterations = 100,
+    double tolerance = 1e-9, thread_pool& pool = default_thread_pool())
+{
+    constexpr size_t grain = 4096;
+
+    size_t n = db.vertex_count();
+    size_t live = n - db.removed_vertex_count();
+    if (live == 0) {
+        return std::vector<double>(n, 0);
+    }
+    adjacency_index local_reverse;
+    const adjacency_index* reverse = &local_reverse;
+    if constexpr (graph_db<GraphSchema>::has_reverse_index) {
+        reverse = &db.backward_index();
+    }
+    else {
+        local_reverse = build_reverse_index(db);
+    }
+    const adjacency_index& forward = db.forward_index();
+
+    std::vector<size_t> out_degree(n);
+    pool.parallel_for(0, n, grain, [&](size_t b, size_t e) {
+        for (size_t u = b; u < e; ++u) {
+            size_t degree = 0;
+            for (size_t edge : forward.neighbors(u)) {
+                degree += !db.edge_removed(edge);
+            }
+            out_degree[u] = degree;
+        }
+    });
+
+    std::vector<double> rank(n);
+    std::vector<double> next(n);
+    std::vector<double> contribution(n);
+    for (size_t v = 0; v < n; ++v) {
+        rank[v] = db.vertex_removed(v) ? 0 : 1.0 / live;
+    }
+    std::vector<double> partial((n + grain - 1) / grain);
+    auto sum_partials = [&partial]() {
+        double sum = 0;
+        for (double p : partial) {
+            sum += p;
+        }
+        return sum;
+    };
+
+    for (size_t iteration = 0; iteration < max_iterations; ++iteration) {
+        pool.parallel_for(0, n, grain, [&](size_t b, size_t e) {
+            double dangling = 0;
+            for (size_t u = b; u < e; ++u) {
+                if (out_degree[u] == 0) {
+                    dangling += rank[u];
+                    contribution[u] = 0;
+                }
+                else {
+                    contribution[u] = rank[u] / out_degree[u];
+                }
+            }
+            partial[b / grain] = dangling;
+        });
+        double base = (1 - damping + damping * sum_partials()) / live;
+
+        pool.parallel_for(0, n, grain, [&](size_t b, size_t e) {
+            double delta = 0;
+            for (size_t v = b; v < e; ++v) {
+                if (db.vertex_removed(v)) {
+                    next[v] = 0;
+                    continue;
+                }
+                double sum = 0;
+                for (size_t edge : reverse->neighbors(v)) {
+                    if (!db.edge_removed(edge)) {
+                        sum += contribution[db.source_of(edge)];
+                    }
+                }
+                next[v] = base + damping * sum;
+                delta += std::abs(next[v] - rank[v]);
+            }
+            partial[b / grain] = delta;
+        });
+        rank.swap(next);
+        if (sum_partials() < tolerance) {
+            break;
+        }
+    }
+    return rank;
+}
+
+/**
+ * @brief Computes the PageRank of every vertex and stores it into the I-th vertex property.
+ * @see pagerank
+ */
+template<size_t I, class GraphSchema>
+void pagerank_into(graph_db<GraphSchema>& db, double damping = 0.85, size_t max_iterations = 100,
+    double tolerance = 1e-9, thread_pool& pool = default_thread_pool())
+{
+    db.template set_vertex_column<I>(pagerank(std::as_const(db), damping, max_iterations, tolerance, pool));
+}
+
+/**
+ * @brief Labels the weakly connected components with a parallel lock-free union-find.
+ * @param db The database.
+ * @param pool The threads to run on.
+ * @return The component of every vertex by its dense index, which is the lowest dense index in the component.
+ * Removed vertexes form components of their own.
+ * @note Edges are processed in parallel, each one links the root of the higher index under the root of the lower
+ * one with a compare-and-swap, finds halve the paths they walk. As roots only ever point to lower indices,
+ * no cycle can form and the root of every component ends up being its lowest index. Removed edges are ignored.
+ */
+template<class GraphSchema>
+std::vector<size_t> connected_components(const graph_db<GraphSchema>& db, thread_pool& pool = default_thread_pool())
+{
+    constexpr size_t grain = 4096;
+
+    size_t n = db.vertex_count();
+    std::vector<std::atomic<size_t>> parent(n);
+    pool.parallel_for(0, n, grain, [&](size_t b, size_t e) {
+        for (size_t v = b; v < e; ++v) {
+            parent[v].store(v, std::memory_order_relaxed);
+        }
+    });
+
+    auto find = [&parent](size_t x) {
+        for (;;) {
+            size_t p = parent[x].load(std::memory_order_relaxed);
+            if (p == x) {
+                return x;
+            }
+            size_t grandparent = parent[p].load(std::memory_order_relaxed);
+            if (p != grandparent) {
+                // A failed halving only means another thread moved x closer to the root first.
+                parent[x].compare_exchange_weak(p, grandparent, std::memory_order_relaxed);
+            }
+            x = grandparent;
+        }
+    };
+
+    pool.parallel_for(0, db.edge_count(), grain, [&](size_t b, size_t e) {
+        for (size_t i = b; i < e; ++i) {
+            if (db.edge_removed(i)) {
+                continue;
+            }
+            size_t u = db.source_of(i);
+            size_t v = db.target_of(i);
+            for (;;) {
+                u = find(u);
+                v = find(v);
+                if (u == v) {
+                    break;
+                }
+                if (u < v) {
+                    std::swap(u, v);
+                }
+                size_t expected = u;
+                if (parent[u].compare_exchange_strong(expected, v, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+        }
+    });
+
+    std::vector<size_t> component(n);
+    pool.parallel_for(0, n, grain, [&](size_t b, size_t e) {
+        for (size_t v = b; v < e; ++v) {
+            component[v] = find(v);
+        }
+    });
+    return component;
+}
+
+/**
+ * @brief Labels the weakly connected components and stores the label of every vertex into its I-th property.
+ * @see connected_components
+ */
+template<size_t I, class GraphSchema>
+void connected_components_into(graph_db<GraphSchema>& db, thread_pool& pool = default_thread_pool())
+{
+    db.template set_vertex_column<I>(connected_components(std::as_const(db), pool));
+}
+
+/**
+ * @brief Counts the triangles of the graph with edge directions, self-loops and parallel edges ignored.
+ * @param db The database.
+ * @param pool The threads to run on.
+ * @return The number of unordered triples of vertexes connected pairwise by live edges.
+ * @note Every edge is oriented towards the endpoint of the higher (degree, index), which leaves every vertex with
+ * few outgoing neighbors even on skewed graphs. The sorted lists of outgoing neighbors are built in parallel,
+ * then every triangle is found exactly once, from its lowest vertex in that order, by intersecting the lists
+ * of both ends of each oriented edge with simd_intersect_count.
+ */
+template<class GraphSchema>
+size_t count_triangles(const graph_db<GraphSchema>& db, thread_pool& pool = default_thread_pool())
+{
+    constexpr size_t grain = 4096;
+
+    size_t n = db.vertex_count();
+    size_t m = db.edge_count();
+    auto counted = [&db](size_t e) {
+        return !db.edge_removed(e) && db.source_of(e) != db.target_of(e);
+    };
+
+    std::vector<std::atomic<size_t>> degree(n);
+    pool.parallel_for(0, m, grain, [&](size_t b, size_t e) {
+        for (size_t i = b; i < e; ++i) {
+            if (counted(i)) {
+                degree[db.source_of(i)].fetch_add(1, std::memory_order_relaxed);
+                degree[db.target_of(i)].fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    });
+    auto oriented = [&](size_t e) {
+        size_t u = db.source_of(e);
+        size_t v = db.target_of(e);
+        size_t du = degree[u].load(std::memory_order_relaxed);
+        size_t dv = degree[v].load(std::memory_order_relaxed);
+        return du < dv || (du == dv && u < v) ? std::pair(u, v) : std::pair(v, u);
+    };
+
+    std::vector<std::atomic<size_t>> cursor(n + 1);
+    pool.parallel_for(0, m, grain, [&](size_t b, size_t e) {
+        for (size_t i = b; i < e; ++i) {
+            if (counted(i)) {
+                cursor[oriented(i).first + 1].fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    });
+    std::vector<size_t> offsets(n + 1, 0);
+    for (size_t v = 0; v < n; ++v) {
+        offsets[v + 1] = offsets[v] + cursor[v + 1].load(std::memory_order_relaxed);
+        cursor[v].store(offsets[v], std::memory_order_relaxed);
+    }
+    std::vector<size_t> higher(offsets[n]);
+    pool.parallel_for(0, m, grain, [&](size_t b, size_t e) {
+        for (size_t i = b; i < e; ++i) {
+            if (counted(i)) {
+                auto [u, v] = oriented(i);
+                higher[cursor[u].fetch_add(1, std::memory_order_relaxed)] = v;
+            }
+        }
+    });
+    // Parallel edges leave duplicates, the lists end at length[v] once they are dropped.
+    std::vector<size_t> length(n);
+    pool.parallel_for(0, n, grain, [&](size_t b, size_t e) {
+        for (size_t v = b; v < e; ++v) {
+            auto first = higher.begin() + static_cast<std::ptrdiff_t>(offsets[v]);
+            auto last = higher.begin() + static_cast<std::ptrdiff_t>(offsets[v + 1]);
+            std::sort(first, last);
+            length[v] = static_cast<size_t>(std::unique(first, last) - first);
+        }
+    });
+
+    std::vector<size_t> partial((n + 255) / 256);
+    pool.parallel_for(0, n, 256, [&](size_t b, size_t e) {
+        size_t triangles = 0;
+        for (size_t u = b; u < e; ++u) {
+            const size_t* nu = higher.data() + offsets[u];
+            for (size_t k = 0; k < length[u]; ++k) {
+                size_t v = nu[k];
+                triangles += simd_intersect_count(nu, length[u], higher.data() + offsets[v], length[v]);
+            }
+        }
+        partial[b / 256] = triangles;
+    });
+    size_t total = 0;
+    for (size_t p : partial) {
+        total += p;
+    }
+    return total;
+}
+
+#endif // !ANALYTICS_HPP
@@ -0,0 +1,604 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <new>
+#include <optional>
+#include <random>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "analytics.hpp"
+#include "csv_import.hpp"
+#include "graph_db.hpp"
+#include "graph_generators.hpp"
+#include "traversal.hpp"
+
+// Every allocation of the process carries its size in a header, so the benchmarks can report live bytes per element.
+namespace {
+    constexpr size_t allocation_header = alignof(std::max_align_t);
+    std::atomic<size_t> live_bytes{ 0 };
+}
+
+void* operator new(size_t size)
+{
+    void* p = std::malloc(size + allocation_header);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    *static_cast<size_t*>(p) = size;
+    live_bytes.fetch_add(size, std::memory_order_relaxed);
+    return static_cast<std::byte*>(p) + allocation_header;
+}
+
+void operator delete(void* p) noexcept
+{
+    if (p == nullptr) {
+        return;
+    }
+    void* block = static_cast<std::byte*>(p) - allocation_header;
+    live_bytes.fetch_sub(*static_cast<size_t*>(block), std::memory_order_relaxed);
+    std::free(block);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    operator delete(p);
+}
+
+/**
+ * @brief Returns prefix followed by the decimal digits of i.
+ * @note Appends instead of "v" + std::to_string(i), which trips a false -Wrestrict in GCC 12's std::string.
+ */
+std::string numbered(const char* prefix, size_t i)
+{
+    std::string text = prefix;
+    text += std::to_string(i);
+    return text;
+}
+
+/**
+ * @brief The schema of test_prop_empty: string vertex ids, float edge ids and no properties.
+ */
+struct empty_schema {
+    using vertex_user_id_t = std::string;
+    using vertex_property_t = std::tuple<>;
+
+    using edge_user_id_t = float;
+    using edge_property_t = std::tuple<>;
+
+    static vertex_user_id_t vertex_id(size_t i) { return numbered("v", i); }
+    static edge_user_id_t edge_id(size_t i) { return static_cast<float>(i); }
+    static vertex_property_t vertex_props(size_t) { return {}; }
+    static edge_property_t edge_props(size_t) { return {}; }
+};
+
+/**
+ * @brief The schema of test_vertex_prop_set: string ids and four vertex properties of mixed types.
+ */
+struct four_prop_schema {
+    using vertex_user_id_t = std::string;
+    using vertex_property_t = std::tuple<int, double, bool, std::string>;
+
+    using edge_user_id_t = std::string;
+    using edge_property_t = std::tuple<double>;
+
+    static vertex_user_id_t vertex_id(size_t i) { return numbered("v", i); }
+    static edge_user_id_t edge_id(size_t i) { return numbered("e", i); }
+    static vertex_property_t vertex_props(size_t i)
+    {
+        return { static_cast<int>(i), i * 0.5, i % 2 == 0, numbered("label", i % 16) };
+    }
+    static edge_property_t edge_props(size_t i) { return { i * 0.25 }; }
+};
+
+/**
+ * @brief A numeric schema with compact columns and the reverse index, the shape analytics workloads use.
+ */
+struct numeric_schema {
+    using vertex_user_id_t = uint64_t;
+    using vertex_property_t = std::tuple<int64_t, double>;
+
+    using edge_user_id_t = uint64_t;
+    using edge_property_t = std::tuple<float>;
+
+    template<typename T>
+    using column_t = compact_column_t<T>;
+
+    static constexpr bool reverse_index = true;
+
+    static vertex_user_id_t vertex_id(size_t i) { return i * 2654435761u; }
+    static edge_user_id_t edge_id(size_t i) { return i; }
+    static vertex_property_t vertex_props(size_t i) { return { static_cast<int64_t>(i), i * 0.5 }; }
+    static edge_property_t edge_props(size_t i) { return { static_cast<float>(i % 100) }; }
+};
+
+/**
+ * @brief numeric_schema with adjacency lists kept sorted by the opposite endpoint.
+ */
+struct sorted_numeric_schema : numeric_schema {
+    static constexpr bool sorted_adjacency = true;
+};
+
+struct instrumented_numeric_schema : numeric_schema {
+    static constexpr bool instrumented = true;
+};
+
+struct uniform_graph {
+    static std::vector<std::pair<size_t, size_t>> edges(size_t scale)
+    {
+        return uniform_edges(size_t(1) << scale, edge_factor << scale);
+    }
+    static constexpr size_t edge_factor = 16;
+};
+
+struct rmat_graph {
+    static std::vector<std::pair<size_t, size_t>> edges(size_t scale)
+    {
+        return rmat_edges(scale, edge_factor << scale);
+    }
+    static constexpr size_t edge_factor = 16;
+};
+
+template<class Schema>
+typename graph_db<Schema>::vertex_t add_generated_vertex(graph_db<Schema>& db, size_t i)
+{
+    return std::apply([&](auto&&... props) {
+        return db.add_vertex(Schema::vertex_id(i), std::move(props)...);
+    }, Schema::vertex_props(i));
+}
+
+template<class Schema>
+void add_generated_edges(graph_db<Schema>& db, const std::vector<std::pair<size_t, size_t>>& edges)
+{
+    auto vertices = db.get_vertexes();
+    for (size_t i = 0; i < edges.size(); ++i) {
+        std::apply([&](auto&&... props) {
+            db.add_edge(Schema::edge_id(i), vertices[edges[i].first], vertices[edges[i].second], std::move(props)...);
+        }, Schema::edge_props(i));
+    }
+}
+
+/**
+ * @brief Returns a graph of 2^scale vertexes built once per schema, generator and scale.
+ */
+template<class Schema, class Generator>
+const graph_db<Schema>& cached_graph(size_t scale)
+{
+    static std::map<size_t, std::unique_ptr<graph_db<Schema>>> cache;
+    auto& db = cache[scale];
+    if (!db) {
+        db = std::make_unique<graph_db<Schema>>();
+        for (size_t i = 0; i < (size_t(1) << scale); ++i) {
+            add_generated_vertex(*db, i);
+        }
+        add_generated_edges(*db, Generator::edges(scale));
+    }
+    return *db;
+}
+
+template<class Schema>
+void bm_add_vertex(benchmark::State& state)
+{
+    size_t n = size_t(1) << state.range(0);
+    std::optional<graph_db<Schema>> db;
+    size_t bytes = 0;
+    for (auto _ : state) {
+        size_t before = live_bytes.load();
+        db.emplace();
+        for (size_t i = 0; i < n; ++i) {
+            add_generated_vertex(*db, i);
+        }
+        state.PauseTiming();
+        bytes = live_bytes.load() - before;
+        db.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+    state.counters["bytes_per_vertex"] = static_cast<double>(bytes) / n;
+}
+
+template<class Schema>
+void bm_add_vertices_batch(benchmark::State& state)
+{
+    size_t n = size_t(1) << state.range(0);
+    using row_t = decltype(std::tuple_cat(std::make_tuple(Schema::vertex_id(0)), Schema::vertex_props(0)));
+    std::vector<row_t> rows;
+    rows.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        rows.push_back(std::tuple_cat(std::make_tuple(Schema::vertex_id(i)), Schema::vertex_props(i)));
+    }
+    std::optional<graph_db<Schema>> db;
+    for (auto _ : state) {
+        db.emplace();
+        db->add_vertices(rows);
+        state.PauseTiming();
+        db.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template<class Schema, class Generator>
+void bm_add_edge(benchmark::State& state)
+{
+    size_t n = size_t(1) << state.range(0);
+    auto edges = Generator::edges(state.range(0));
+    std::optional<graph_db<Schema>> db;
+    size_t bytes = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        db.emplace();
+        for (size_t i = 0; i < n; ++i) {
+            add_generated_vertex(*db, i);
+        }
+        size_t before = live_bytes.load();
+        state.ResumeTiming();
+        add_generated_edges(*db, edges);
+        // The adjacency index is merged lazily, the first scan pays for it.
+        benchmark::DoNotOptimize(db->get_vertexes()[0].degree());
+        state.PauseTiming();
+        bytes = live_bytes.load() - before;
+        db.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * edges.size());
+    state.counters["bytes_per_edge"] = static_cast<double>(bytes) / edges.size();
+}
+
+// Ingest with a write-ahead log, every record is durable at the end of an iteration.
+template<class Schema, class Generator>
+void bm_add_edge_logged(benchmark::State& state)
+{
+    size_t n = size_t(1) << state.range(0);
+    auto edges = Generator::edges(state.range(0));
+    std::string path = (std::filesystem::temp_directory_path() / "graph_db_bench.wal").string();
+    std::optional<graph_db<Schema>> db;
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::filesystem::remove(path);
+        db.emplace();
+        for (size_t i = 0; i < n; ++i) {
+            add_generated_vertex(*db, i);
+        }
+        db->open_log(path);
+        state.ResumeTiming();
+        add_generated_edges(*db, edges);
+        db->sync_log();
+        state.PauseTiming();
+        db.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * edges.size());
+    state.SetBytesProcessed(state.iterations() * std::filesystem::file_size(path));
+    std::filesystem::remove(path);
+}
+
+template<class Schema, class Generator>
+void bm_replay_log(benchmark::State& state)
+{
+    size_t n = size_t(1) << state.range(0);
+    auto edges = Generator::edges(state.range(0));
+    std::string path = (std::filesystem::temp_directory_path() / "graph_db_bench_replay.wal").string();
+    std::filesystem::remove(path);
+    {
+        graph_db<Schema> db;
+        db.open_log(path, wal_options{ std::chrono::milliseconds(5), size_t(1) << 20, false });
+        for (size_t i = 0; i < n; ++i) {
+            add_generated_vertex(db, i);
+        }
+        add_generated_edges(db, edges);
+    }
+    std::optional<graph_db<Schema>> db;
+    for (auto _ : state) {
+        db.emplace();
+        db->open_log(path);
+        state.PauseTiming();
+        db.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * (n + edges.size()));
+    state.SetBytesProcessed(state.iterations() * std::filesystem::file_size(path));
+    std::filesystem::remove(path);
+}
+
+template<class Schema>
+void bm_get_property(benchmark::State& state)
+{
+    const auto& db = cached_graph<Schema, uniform_graph>(state.range(0));
+    std::mt19937_64 rng(7);
+    std::vector<size_t> order(db.vertex_count());
+    for (auto&& i : order) {
+        i = rng() % db.vertex_count();
+    }
+    auto vertices = db.get_vertexes();
+    for (auto _ : state) {
+        double sum = 0;
+        for (size_t i : order) {
+            auto v = vertices[i];
+            sum += v.template get_property<0>() + v.template get_property<1>();
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * order.size());
+}
+
+template<class Schema>
+void bm_set_property(benchmark::State& state)
+{
+    graph_db<Schema> db(cached_graph<Schema, uniform_graph>(state.range(0)));
+    std::mt19937_64 rng(7);
+    std::vector<size_t> order(db.vertex_count());
+    for (auto&& i : order) {
+        i = rng() % db.vertex_count();
+    }
+    auto vertices = db.get_vertexes();
+    size_t round = 0;
+    for (auto _ : state) {
+        for (size_t i : order) {
+            vertices[i].template set_property<1>(static_cast<double>(round));
+        }
+        ++round;
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * order.size());
+}
+
+template<class Schema>
+void bm_vertex_iteration(benchmark::State& state)
+{
+    const auto& db = cached_graph<Schema, uniform_graph>(state.range(0));
+    for (auto _ : state) {
+        size_t count = 0;
+        for (auto&& v : db.get_vertexes()) {
+            benchmark::DoNotOptimize(v.get_properties());
+            ++count;
+        }
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetItemsProcessed(state.iterations() * db.vertex_count());
+}
+
+template<class Schema>
+void bm_edge_iteration(benchmark::State& state)
+{
+    const auto& db = cached_graph<Schema, uniform_graph>(state.range(0));
+    for (auto _ : state) {
+        size_t sum = 0;
+        for (auto&& e : db.get_edges()) {
+            sum += e.src().get_index() ^ e.dst().get_index();
+            benchmark::DoNotOptimize(e.get_properties());
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * db.edge_count());
+}
+
+template<class Schema, class Generator>
+void bm_neighbor_scan(benchmark::State& state)
+{
+    const auto& db = cached_graph<Schema, Generator>(state.range(0));
+    for (auto _ : state) {
+        size_t sum = 0;
+        for (auto&& v : db.get_vertexes()) {
+            for (auto&& e : v.edges()) {
+                sum += e.dst().get_index();
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * db.edge_count());
+}
+
+template<class Schema>
+void bm_find_vertex(benchmark::State& state)
+{
+    const auto& db = cached_graph<Schema, uniform_graph>(state.range(0));
+    std::mt19937_64 rng(7);
+    std::vector<typename Schema::vertex_user_id_t> ids(db.vertex_count());
+    for (auto&& id : ids) {
+        id = Schema::vertex_id(rng() % db.vertex_count());
+    }
+    for (auto _ : state) {
+        size_t sum = 0;
+        for (auto&& id : ids) {
+            sum += db.find_vertex(id)->get_index();
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * ids.size());
+}
+
+template<class Schema, class Generator>
+void bm_bfs(benchmark::State& state)
+{
+    const auto& db = cached_graph<Schema, Generator>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(bfs_depths(db, { 0 }));
+    }
+    state.SetItemsProcessed(state.iterations() * db.edge_count());
+}
+
+template<class Schema, class Generator>
+void bm_pagerank(benchmark::State& state)
+{
+    const auto& db = cached_graph<Schema, Generator>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(pagerank(db, 0.85, 10, 0));
+    }
+    state.SetItemsProcessed(state.iterations() * 10 * db.edge_count());
+}
+
+template<class Schema, class Generator>
+void bm_connected_components(benchmark::State& state)
+{
+    const auto& db = cached_graph<Schema, Generator>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(connected_components(db));
+    }
+    state.SetItemsProcessed(state.iterations() * db.edge_count());
+}
+
+template<class Schema, class Generator>
+void bm_count_triangles(benchmark::State& state)
+{
+    const auto& db = cached_graph<Schema, Generator>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(count_triangles(db));
+    }
+    state.SetItemsProcessed(state.iterations() * db.edge_count());
+}
+
+template<class Schema, class Generator>
+void bm_common_neighbors(benchmark::State& state)
+{
+    const auto& db = cached_graph<Schema, Generator>(state.range(0));
+    std::mt19937_64 rng(7);
+    std::vector<std::pair<size_t, size_t>> pairs(4096);
+    for (auto&& [v1, v2] : pairs) {
+        v1 = rng() % db.vertex_count();
+        v2 = rng() % db.vertex_count();
+    }
+    // The adjacency index is merged lazily, the timed loop must not pay for it.
+    benchmark::DoNotOptimize(db.common_neighbors(db.vertex_at(0), db.vertex_at(1)));
+    for (auto _ : state) {
+        size_t count = 0;
+        for (auto [v1, v2] : pairs) {
+            count += db.common_neighbors(db.vertex_at(v1), db.vertex_at(v2)).size();
+        }
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetItemsProcessed(state.iterations() * pairs.size());
+}
+
+template<class Schema, class Generator, vertex_order Strategy>
+void bm_reorder(benchmark::State& state)
+{
+    const auto& cached = cached_graph<Schema, Generator>(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        graph_db<Schema> db(cached);
+        state.ResumeTiming();
+        db.reorder(Strategy);
+        benchmark::DoNotOptimize(db.vertex_count());
+    }
+    state.SetItemsProcessed(state.iterations() * cached.edge_count());
+}
+
+/**
+ * @brief Runs bm_pagerank on a copy of the generated graph renumbered by reorder(), to compare with the insertion order.
+ */
+template<class Schema, class Generator, vertex_order Strategy>
+void bm_pagerank_reordered(benchmark::State& state)
+{
+    graph_db<Schema> db(cached_graph<Schema, Generator>(state.range(0)));
+    db.reorder(Strategy);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(pagerank(db, 0.85, 10, 0));
+    }
+    state.SetItemsProcessed(state.iterations() * 10 * db.edge_count());
+}
+
+/**
+ * @brief Imports the edges of a generated graph from a whitespace separated edge list into a graph holding its vertexes.
+ */
+template<class Schema, class Generator>
+void bm_import_edge_list(benchmark::State& state)
+{
+    size_t n = size_t(1) << state.range(0);
+    auto edges = Generator::edges(state.range(0));
+    std::string path = (std::filesystem::temp_directory_path() / "graph_db_bench_edges.txt").string();
+    {
+        std::ofstream file(path, std::ios::binary);
+        for (auto [src, dst] : edges) {
+            file << Schema::vertex_id(src) << ' ' << Schema::vertex_id(dst) << ' ' << std::get<0>(Schema::edge_props(0)) << '\n';
+        }
+    }
+    graph_db<Schema> vertices;
+    for (size_t i = 0; i < n; ++i) {
+        add_generated_vertex(vertices, i);
+    }
+    csv_options options;
+    options.delimiter = ' ';
+    options.header = false;
+    options.edge_ids = false;
+    std::optional<graph_db<Schema>> db;
+    for (auto _ : state) {
+        state.PauseTiming();
+        db.emplace(vertices);
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(import_edges(*db, path, options));
+        state.PauseTiming();
+        db.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * edges.size());
+    state.SetBytesProcessed(state.iterations() * std::filesystem::file_size(path));
+    std::filesystem::remove(path);
+}
+
+constexpr int64_t bench_scale = 16;
+
+BENCHMARK_TEMPLATE(bm_add_vertex, empty_schema)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_add_vertex, four_prop_schema)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_add_vertex, numeric_schema)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_add_vertex, instrumented_numeric_schema)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_add_vertices_batch, four_prop_schema)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_add_vertices_batch, numeric_schema)->Arg(bench_scale);
+
+BENCHMARK_TEMPLATE(bm_add_edge, empty_schema, uniform_graph)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_add_edge, four_prop_schema, uniform_graph)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_add_edge, numeric_schema, uniform_graph)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_add_edge, numeric_schema, rmat_graph)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_add_edge, instrumented_numeric_schema, rmat_graph)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_add_edge_logged, numeric_schema, rmat_graph)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_replay_log, numeric_schema, rmat_graph)->Arg(bench_scale);
+
+BENCHMARK_TEMPLATE(bm_get_property, four_prop_schema)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_get_property, numeric_schema)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_set_property, four_prop_schema)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_set_property, numeric_schema)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_set_property, instrumented_numeric_schema)->Arg(bench_scale);
+
+BENCHMARK_TEMPLATE(bm_vertex_iteration, empty_schema)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_vertex_iteration, four_prop_schema)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_vertex_iteration, numeric_schema)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_edge_iteration, empty_schema)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_edge_iteration, four_prop_schema)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_edge_iteration, numeric_schema)->Arg(bench_scale);
+
+BENCHMARK_TEMPLATE(bm_neighbor_scan, empty_schema, uniform_graph)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_neighbor_scan, numeric_schema, uniform_graph)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_neighbor_scan, numeric_schema, rmat_graph)->Arg(bench_scale);
+
+BENCHMARK_TEMPLATE(bm_find_vertex, empty_schema)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_find_vertex, numeric_schema)->Arg(bench_scale);
+
+BENCHMARK_TEMPLATE(bm_bfs, numeric_schema, uniform_graph)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_bfs, numeric_schema, rmat_graph)->Arg(bench_scale);
+
+BENCHMARK_TEMPLATE(bm_pagerank, numeric_schema, uniform_graph)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_pagerank, numeric_schema, rmat_graph)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_connected_components, numeric_schema, uniform_graph)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_connected_components, numeric_schema, rmat_graph)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_reorder, numeric_schema, rmat_graph, vertex_order::degree)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_reorder, numeric_schema, rmat_graph, vertex_order::rcm)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_pagerank_reordered, numeric_schema, rmat_graph, vertex_order::degree)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_pagerank_reordered, numeric_schema, rmat_graph, vertex_order::rcm)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_pagerank_reordered, numeric_schema, rmat_graph, vertex_order::bfs)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_count_triangles, numeric_schema, uniform_graph)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_count_triangles, numeric_schema, rmat_graph)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_common_neighbors, numeric_schema, rmat_graph)->Arg(bench_scale);
+BENCHMARK_TEMPLATE(bm_common_neighbors, sorted_numeric_schema, rmat_graph)->Arg(bench_scale);
+
+BENCHMARK_TEMPLATE(bm_import_edge_list, numeric_schema, uniform_graph)->Arg(bench_scale);
+
+BENCHMARK_MAIN();
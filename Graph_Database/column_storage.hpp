@@ -0,0 +1,536 @@
+#ifndef COLUMN_STORAGE_HPP
+#define COLUMN_STORAGE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief A std::allocator replacement returning memory aligned to the given boundary.
+ * @tparam T The allocated type.
+ * @tparam Alignment The alignment in bytes, a cache line by default.
+ */
+template<typename T, size_t Alignment = 64>
+struct aligned_allocator {
+    using value_type = T;
+
+    template<typename U>
+    struct rebind {
+        using other = aligned_allocator<U, Alignment>;
+    };
+
+    aligned_allocator() = default;
+
+    template<typename U>
+    aligned_allocator(const aligned_allocator<U, Alignment>&) noexcept {}
+
+    T* allocate(size_t n)
+    {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    void deallocate(T* p, size_t) noexcept
+    {
+        ::operator delete(p, std::align_val_t(Alignment));
+    }
+
+    template<typename U>
+    bool operator==(const aligned_allocator<U, Alignment>&) const noexcept
+    {
+        return true;
+    }
+};
+
+/**
+ * @brief A column of plain values in a cache line aligned contiguous array.
+ */
+template<typename T>
+using aligned_column = std::vector<T, aligned_allocator<T>>;
+
+/**
+ * @brief A column of bools packed into 64-bit words.
+ * @note Bits behind size() in the last word are always zero.
+ */
+class bit_column {
+public:
+    using value_type = bool;
+
+    bool operator[](size_t i) const
+    {
+        return (words[i >> 6] >> (i & 63)) & 1;
+    }
+
+    void set(size_t i, bool value)
+    {
+        uint64_t mask = uint64_t(1) << (i & 63);
+        if (value) {
+            words[i >> 6] |= mask;
+        }
+        else {
+            words[i >> 6] &= ~mask;
+        }
+    }
+
+    void emplace_back()
+    {
+        emplace_back(false);
+    }
+
+    template<typename V>
+    void emplace_back(V&& value)
+    {
+        if ((count & 63) == 0) {
+            words.push_back(0);
+        }
+        set(count++, static_cast<bool>(value));
+    }
+
+    void push_back(bool value)
+    {
+        emplace_back(value);
+    }
+
+    void reserve(size_t n)
+    {
+        words.reserve((n + 63) / 64);
+    }
+
+    void resize(size_t n)
+    {
+        words.resize((n + 63) / 64, 0);
+        count = n;
+        if ((n & 63) != 0) {
+            words.back() &= (uint64_t(1) << (n & 63)) - 1;
+        }
+    }
+
+    void clear()
+    {
+        words.clear();
+        count = 0;
+    }
+
+    size_t size() const
+    {
+        return count;
+    }
+
+    size_t capacity() const
+    {
+        return words.capacity() * 64;
+    }
+
+    /**
+     * @brief Returns the packed words, bit i % 64 of the word i / 64 is the i-th value.
+     */
+    const uint64_t* word_data() const
+    {
+        return words.data();
+    }
+
+private:
+    std::vector<uint64_t> words;
+    size_t count = 0;
+};
+
+/**
+ * @brief A column of strings stored in one character arena and indexed by (offset, length) pairs.
+ * @note Reading returns a std::string_view into the arena. Overwriting with a longer string appends it
+ * and the arena is compacted once the abandoned bytes outweigh the live ones.
+ */
+class string_arena_column {
+public:
+    using value_type = std::string;
+
+    std::string_view operator[](size_t i) const
+    {
+        return std::string_view(chars.data() + spans[i].offset, spans[i].length);
+    }
+
+    void set(size_t i, std::string_view value)
+    {
+        if (aliases_arena(value)) {
+            set(i, std::string(value));
+            return;
+        }
+        span& s = spans[i];
+        if (value.size() <= s.length) {
+            value.copy(chars.data() + s.offset, value.size());
+            garbage += s.length - value.size();
+            s.length = value.size();
+            return;
+        }
+        garbage += s.length;
+        s = append(value);
+        if (garbage > chars.size() / 2) {
+            compact();
+        }
+    }
+
+    void emplace_back()
+    {
+        spans.push_back({ chars.size(), 0 });
+    }
+
+    template<typename V>
+    void emplace_back(V&& value)
+    {
+        std::string_view view(value);
+        if (aliases_arena(view)) {
+            emplace_back(std::string(view));
+            return;
+        }
+        spans.push_back(append(view));
+    }
+
+    void push_back(std::string_view value)
+    {
+        emplace_back(value);
+    }
+
+    void reserve(size_t n)
+    {
+        spans.reserve(n);
+    }
+
+    void resize(size_t n)
+    {
+        while (spans.size() > n) {
+            garbage += spans.back().length;
+            spans.pop_back();
+        }
+        spans.resize(n, span{ chars.size(), 0 });
+    }
+
+    void clear()
+    {
+        spans.clear();
+        chars.clear();
+        garbage = 0;
+    }
+
+    size_t size() const
+    {
+        return spans.size();
+    }
+
+    /**
+     * @brief Returns the number of rows the column holds without reallocating its spans, the arena grows on its own.
+     */
+    size_t capacity() const
+    {
+        return spans.capacity();
+    }
+
+    /**
+     * @brief Rewrites the arena so that it only holds live strings, in column order.
+     */
+    void compact()
+    {
+        std::vector<char> live;
+        live.reserve(chars.size() - garbage);
+        for (auto&& s : spans) {
+            size_t offset = live.size();
+            live.insert(live.end(), chars.begin() + s.offset, chars.begin() + s.offset + s.length);
+            s.offset = offset;
+        }
+        chars = std::move(live);
+        garbage = 0;
+    }
+
+    /**
+     * @brief Reorders the rows so that the j-th one is the former order[j]-th, the arena follows the new order.
+     * @see column_permute
+     */
+    void permute(const std::vector<size_t>& order)
+    {
+        std::vector<span> permuted(order.size());
+        for (size_t j = 0; j < order.size(); ++j) {
+            permuted[j] = spans[order[j]];
+        }
+        spans = std::move(permuted);
+        compact();
+    }
+
+private:
+    struct span {
+        size_t offset;
+        size_t length;
+    };
+
+    bool aliases_arena(std::string_view value) const
+    {
+        return !chars.empty() && value.data() >= chars.data() && value.data() < chars.data() + chars.size();
+    }
+
+    span append(std::string_view value)
+    {
+        span s{ chars.size(), value.size() };
+        chars.insert(chars.end(), value.begin(), value.end());
+        return s;
+    }
+
+    std::vector<char> chars;
+    std::vector<span> spans;
+    size_t garbage = 0;
+};
+
+/**
+ * @brief A column stored in fixed-size segments addressed through a directory of segment pointers.
+ * @tparam SegmentBits The base-2 logarithm of the number of values in one segment.
+ * @note Growing allocates one segment at a time and only the directory is ever reallocated,
+ * so appends never copy values, peak memory stays flat and references to values remain valid.
+ * @note Values within a segment are contiguous, kernels process such a column segment by segment.
+ */
+template<typename T, size_t SegmentBits = 16>
+class segmented_column {
+    // Parallel kernels split columns into chunks of scan_chunk_rows (2^14) values that must not straddle segments.
+    static_assert(SegmentBits >= 14, "segmented_column: a segment must hold whole scan chunks");
+public:
+    using value_type = T;
+
+    static constexpr size_t segment_size = size_t(1) << SegmentBits;
+
+    segmented_column() = default;
+
+    segmented_column(const segmented_column& other) : count(other.count)
+    {
+        segments.reserve(other.segments.size());
+        for (size_t s = 0; s * segment_size < count; ++s) {
+            segments.push_back(std::make_unique<T[]>(segment_size));
+            std::copy_n(other.segments[s].get(), std::min(segment_size, count - s * segment_size), segments.back().get());
+        }
+    }
+
+    segmented_column(segmented_column&&) noexcept = default;
+
+    segmented_column& operator=(const segmented_column& other)
+    {
+        if (this != &other) {
+            segmented_column copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    segmented_column& operator=(segmented_column&&) noexcept = default;
+
+    T& operator[](size_t i)
+    {
+        return segments[i >> SegmentBits][i & mask];
+    }
+
+    const T& operator[](size_t i) const
+    {
+        return segments[i >> SegmentBits][i & mask];
+    }
+
+    void emplace_back()
+    {
+        grow();
+        ++count;
+    }
+
+    template<typename V>
+    void emplace_back(V&& value)
+    {
+        grow();
+        (*this)[count] = T(std::forward<V>(value));
+        ++count;
+    }
+
+    void push_back(const T& value)
+    {
+        emplace_back(value);
+    }
+
+    void push_back(T&& value)
+    {
+        emplace_back(std::move(value));
+    }
+
+    /**
+     * @brief Preallocates the directory for n values, segments themselves are allocated as the column grows.
+     */
+    void reserve(size_t n)
+    {
+        segments.reserve((n + segment_size - 1) >> SegmentBits);
+    }
+
+    size_t capacity() const
+    {
+        return segments.size() * segment_size;
+    }
+
+    void resize(size_t n)
+    {
+        // Values behind the end are kept default-constructed, so growing only has to allocate segments.
+        for (size_t i = n; i < count; ++i) {
+            (*this)[i] = T();
+        }
+        while (capacity() < n) {
+            segments.push_back(std::make_unique<T[]>(segment_size));
+        }
+        count = n;
+    }
+
+    void clear()
+    {
+        resize(0);
+    }
+
+    size_t size() const
+    {
+        return count;
+    }
+
+private:
+    static constexpr size_t mask = segment_size - 1;
+
+    void grow()
+    {
+        if (count == capacity()) {
+            segments.push_back(std::make_unique<T[]>(segment_size));
+        }
+    }
+
+    std::vector<std::unique_ptr<T[]>> segments;
+    size_t count = 0;
+};
+
+/**
+ * @brief Selects a compact storage of a property column by the type of the property.
+ * @note Packed bits for bool, a string arena for std::string, aligned arrays for arithmetic types
+ * and std::vector for everything else.
+ */
+template<typename T>
+struct compact_column {
+    using type = std::conditional_t<std::is_arithmetic_v<T>, aligned_column<T>, std::vector<T>>;
+};
+template<>
+struct compact_column<bool> {
+    using type = bit_column;
+};
+template<>
+struct compact_column<std::string> {
+    using type = string_arena_column;
+};
+
+template<typename T>
+using compact_column_t = typename compact_column<T>::type;
+
+/**
+ * @brief Reads the i-th value of a column.
+ * @return A reference for std::vector like columns, a value or a view for compact ones.
+ */
+template<typename Column>
+decltype(auto) column_get(Column& column, size_t i)
+{
+    return column[i];
+}
+
+/**
+ * @brief Returns a pointer to the i-th value of a column of contiguous values or of contiguous segments.
+ * @note For a segmented_column only the values up to the end of the segment of i follow the pointer.
+ */
+template<typename Column>
+auto column_block(const Column& column, size_t i)
+{
+    if constexpr (requires { column.data(); }) {
+        return column.data() + i;
+    }
+    else {
+        return &column[i];
+    }
+}
+
+/**
+ * @brief Overwrites the i-th value of a column.
+ */
+template<typename Column, typename V>
+void column_set(Column& column, size_t i, V&& value)
+{
+    if constexpr (requires { column.set(i, std::forward<V>(value)); }) {
+        column.set(i, std::forward<V>(value));
+    }
+    else {
+        column[i] = std::forward<V>(value);
+    }
+}
+
+/**
+ * @brief Keeps only the rows at the given increasing positions, in their order.
+ * @note Values move towards the front in place, so no second copy of the column is allocated.
+ */
+template<typename Column>
+void column_retain(Column& column, const std::vector<size_t>& rows)
+{
+    if constexpr (requires { column.retain(rows); }) {
+        column.retain(rows);
+    }
+    else {
+        for (size_t j = 0; j < rows.size(); ++j) {
+            if (rows[j] == j) {
+                continue;
+            }
+            if constexpr (std::is_lvalue_reference_v<decltype(column[j])>) {
+                column[j] = std::move(column[rows[j]]);
+            }
+            else {
+                column_set(column, j, column_get(column, rows[j]));
+            }
+        }
+        column.resize(rows.size());
+        if constexpr (requires { column.compact(); }) {
+            column.compact();
+        }
+    }
+}
+
+/**
+ * @brief Reorders the rows so that the j-th one is the former order[j]-th.
+ * @param order A permutation of the row positions.
+ * @note Values travel along the cycles of the permutation in place, so no second copy of the column is allocated.
+ */
+template<typename Column>
+void column_permute(Column& column, const std::vector<size_t>& order)
+{
+    if constexpr (requires { column.permute(order); }) {
+        column.permute(order);
+    }
+    else {
+        constexpr bool by_reference = std::is_lvalue_reference_v<decltype(column[0])>;
+        auto take = [&column](size_t i) {
+            if constexpr (by_reference) {
+                return std::move(column[i]);
+            }
+            else {
+                return typename Column::value_type(column_get(column, i));
+            }
+        };
+        std::vector<bool> placed(order.size(), false);
+        for (size_t i = 0; i < order.size(); ++i) {
+            if (placed[i] || order[i] == i) {
+                continue;
+            }
+            typename Column::value_type saved = take(i);
+            size_t j = i;
+            while (order[j] != i) {
+                column_set(column, j, take(order[j]));
+                placed[j] = true;
+                j = order[j];
+            }
+            column_set(column, j, std::move(saved));
+            placed[j] = true;
+        }
+    }
+}
+
+#endif // !COLUMN_STORAGE_HPP
@@ -0,0 +1,397 @@
+#ifndef CONCURRENT_HPP
+#define CONCURRENT_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "graph_db.hpp"
+
+/**
+ * @brief Epoch-based protection of data that many threads read while a single writer replaces it.
+ * @note A reader announces the current epoch in a slot before it loads the shared pointer. After the writer
+ * swaps the pointer and advances the epoch, the old data is unused once no slot holds an older epoch.
+ */
+class epoch_domain {
+public:
+    /**
+     * @param max_readers The number of readers that can be inside the domain at the same time.
+     */
+    explicit epoch_domain(size_t max_readers = 256)
+        : slots(std::make_unique<slot[]>(max_readers)), slot_count(max_readers)
+    {}
+
+    epoch_domain(const epoch_domain&) = delete;
+    epoch_domain& operator=(const epoch_domain&) = delete;
+
+    /**
+     * @brief Pins the current epoch for the calling reader.
+     * @return The slot to pass to exit().
+     * @note It is lock-free unless all slots are taken, then it yields until one is released.
+     */
+    size_t enter() const
+    {
+        size_t start = std::hash<std::thread::id>{}(std::this_thread::get_id());
+        for (;;) {
+            for (size_t k = 0; k < slot_count; ++k) {
+                size_t i = (start + k) % slot_count;
+                uint64_t idle = 0;
+                if (slots[i].epoch.load(std::memory_order_relaxed) == 0
+                    && slots[i].epoch.compare_exchange_strong(idle, global.load())) {
+                    return i;
+                }
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    void exit(size_t slot) const
+    {
+        slots[slot].epoch.store(0, std::memory_order_release);
+    }
+
+    /**
+     * @brief Starts a new epoch, called by the writer right after it swapped the shared pointer.
+     * @return The new epoch, data unpublished before the call is unused once quiescent(epoch) holds.
+     */
+    uint64_t advance()
+    {
+        return global.fetch_add(1) + 1;
+    }
+
+    /**
+     * @brief Checks that no reader is pinned to an epoch older than the given one.
+     */
+    bool quiescent(uint64_t epoch) const
+    {
+        for (size_t i = 0; i < slot_count; ++i) {
+            uint64_t e = slots[i].epoch.load();
+            if (e != 0 && e < epoch) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    struct alignas(64) slot {
+        std::atomic<uint64_t> epoch{ 0 };
+    };
+
+    std::unique_ptr<slot[]> slots;
+    size_t slot_count;
+    mutable std::atomic<uint64_t> global{ 1 };
+};
+
+template<class GraphSchema>
+class concurrent_graph_db;
+
+/**
+ * @brief A consistent read-only view of a concurrent_graph_db as of one publish().
+ * @note It pins its version, so ranges and handles obtained from it stay valid and unchanged
+ * until it is destroyed, no matter what the writer does meanwhile.
+ * @note The handles must only be read through, writes go through concurrent_graph_db.
+ */
+template<class GraphSchema>
+class graph_snapshot {
+public:
+    graph_snapshot(graph_snapshot&& other) noexcept
+        : domain(std::exchange(other.domain, nullptr)), slot(other.slot), db(other.db)
+    {}
+
+    graph_snapshot& operator=(graph_snapshot&& other) noexcept
+    {
+        if (this != &other) {
+            release();
+            domain = std::exchange(other.domain, nullptr);
+            slot = other.slot;
+            db = other.db;
+        }
+        return *this;
+    }
+
+    graph_snapshot(const graph_snapshot&) = delete;
+    graph_snapshot& operator=(const graph_snapshot&) = delete;
+
+    ~graph_snapshot()
+    {
+        release();
+    }
+
+    const graph_db<GraphSchema>& operator*() const
+    {
+        return *db;
+    }
+
+    const graph_db<GraphSchema>* operator->() const
+    {
+        return db;
+    }
+
+private:
+    friend class concurrent_graph_db<GraphSchema>;
+
+    graph_snapshot(const epoch_domain* domain, size_t slot, const graph_db<GraphSchema>* db)
+        : domain(domain), slot(slot), db(db)
+    {}
+
+    void release()
+    {
+        if (domain != nullptr) {
+            domain->exit(slot);
+            domain = nullptr;
+        }
+    }
+
+    const epoch_domain* domain;
+    size_t slot;
+    const graph_db<GraphSchema>* db;
+};
+
+/**
+ * @brief A graph_db shared by many reader threads and a single writer thread.
+ * @note Two instances of the database alternate: readers see the published one through lock-free snapshots,
+ * the writer mutates the other one and logs the mutations. publish() swaps them and the log is replayed
+ * into the previously published instance once its last reader leaves, so columns never move under a reader.
+ * @note If a reader still pins the old instance when the writer needs it, the writer copies the published one instead.
+ * @note Mutations are visible to readers only after publish(). All writer methods must be called from one thread.
+ */
+template<class GraphSchema>
+class concurrent_graph_db {
+public:
+    using db_t = graph_db<GraphSchema>;
+    // Handles are const, a mutation through them would bypass the log, the writer methods below are the way to mutate.
+    using vertex_t = typename db_t::const_vertex_t;
+    using edge_t = typename db_t::const_edge_t;
+
+    /**
+     * @param max_readers The number of snapshots that can be alive at the same time.
+     */
+    explicit concurrent_graph_db(size_t max_readers = 256)
+        : domain(max_readers), published(std::make_unique<db_t>()), spare(std::make_unique<db_t>())
+    {
+        current.store(published.get());
+    }
+
+    /**
+     * @pre No snapshot of the database is alive.
+     */
+    ~concurrent_graph_db() = default;
+
+    /**
+     * @brief Returns a consistent view of the last published version, callable from any thread.
+     */
+    graph_snapshot<GraphSchema> snapshot() const
+    {
+        size_t slot = domain.enter();
+        return graph_snapshot<GraphSchema>(&domain, slot, current.load());
+    }
+
+    /**
+     * @brief Inserts a vertex, the arguments are those of graph_db::add_vertex.
+     * @return The vertex in the writer's instance, it can be passed to the other writer methods even after publish().
+     * @throws std::invalid_argument If a vertex with the same user id already exists.
+     */
+    template<typename ...Args>
+    vertex_t add_vertex(Args&&... args)
+    {
+        return apply([...args = std::decay_t<Args>(std::forward<Args>(args))](db_t& db) {
+            return db.add_vertex(args...);
+        });
+    }
+
+    /**
+     * @brief Inserts a directed edge between v1 and v2, the other arguments are those of graph_db::add_edge.
+     * @throws std::invalid_argument If an edge with the same user id already exists.
+     */
+    template<typename Id, typename ...Props>
+    edge_t add_edge(Id&& euid, const vertex_t& v1, const vertex_t& v2, Props&&... props)
+    {
+        return apply([euid = std::decay_t<Id>(std::forward<Id>(euid)), src = v1.get_index(), dst = v2.get_index(),
+            ...props = std::decay_t<Props>(std::forward<Props>(props))](db_t& db) {
+            return db.add_edge(euid, db.vertex_at(src), db.vertex_at(dst), props...);
+        });
+    }
+
+    template<size_t I, typename PropType>
+    void set_vertex_property(const vertex_t& v, PropType&& prop)
+    {
+        apply([index = v.get_index(), prop = std::decay_t<PropType>(std::forward<PropType>(prop))](db_t& db) {
+            db.vertex_at(index).template set_property<I>(prop);
+        });
+    }
+
+    template<size_t I, typename PropType>
+    void set_edge_property(const edge_t& e, PropType&& prop)
+    {
+        apply([index = e.get_index(), prop = std::decay_t<PropType>(std::forward<PropType>(prop))](db_t& db) {
+            db.edge_at(index).template set_property<I>(prop);
+        });
+    }
+
+    template<typename ...Props>
+    void set_vertex_properties(const vertex_t& v, Props&&... props)
+    {
+        apply([index = v.get_index(), ...props = std::decay_t<Props>(std::forward<Props>(props))](db_t& db) {
+            db.vertex_at(index).set_properties(props...);
+        });
+    }
+
+    template<typename ...Props>
+    void set_edge_properties(const edge_t& e, Props&&... props)
+    {
+        apply([index = e.get_index(), ...props = std::decay_t<Props>(std::forward<Props>(props))](db_t& db) {
+            db.edge_at(index).set_properties(props...);
+        });
+    }
+
+    /**
+     * @throws std::invalid_argument If the vertex is removed already.
+     * @see graph_db::remove_vertex
+     */
+    void remove_vertex(const vertex_t& v)
+    {
+        apply([index = v.get_index()](db_t& db) {
+            db.remove_vertex(db.vertex_at(index));
+        });
+    }
+
+    /**
+     * @throws std::invalid_argument If the edge is removed already.
+     * @see graph_db::remove_edge
+     */
+    void remove_edge(const edge_t& e)
+    {
+        apply([index = e.get_index()](db_t& db) {
+            db.remove_edge(db.edge_at(index));
+        });
+    }
+
+    /**
+     * @brief Drops removed elements for good while readers keep using the published version.
+     * @note Dense indices are renumbered, handles returned by the writer methods before are invalidated.
+     * @param pool The threads the writer's instance is compacted on, the spare instance replays it on default_thread_pool().
+     * @see graph_db::compact
+     */
+    void compact(thread_pool& pool = default_thread_pool())
+    {
+        // The log replays the lambda on the spare instance later, when the caller's pool may be gone.
+        apply([pool = &pool](db_t& db) mutable {
+            db.compact(*std::exchange(pool, &default_thread_pool()));
+        });
+    }
+
+    /**
+     * @brief Renumbers the vertexes in a cache-friendly order while readers keep using the published version.
+     * @note Handles returned by the writer methods before are invalidated.
+     * @param pool The threads the writer's instance is reordered on, the spare instance replays it on default_thread_pool().
+     * @see graph_db::reorder
+     */
+    void reorder(vertex_order strategy, thread_pool& pool = default_thread_pool())
+    {
+        apply([strategy, pool = &pool](db_t& db) mutable {
+            db.reorder(strategy, *std::exchange(pool, &default_thread_pool()));
+        });
+    }
+
+    /**
+     * @brief Returns the writer's instance with all mutations so far, for reads on the writer thread only.
+     */
+    const db_t& writer_view()
+    {
+        return writable();
+    }
+
+    /**
+     * @brief Makes all mutations so far visible to new snapshots.
+     * @note Snapshots taken before keep seeing the previous version.
+     */
+    void publish()
+    {
+        if (!working) {
+            return;
+        }
+        // Lazy indexes are merged now, readers must never trigger a write.
+        working->forward_index().merge();
+        if constexpr (db_t::has_reverse_index) {
+            working->backward_index().merge();
+        }
+        working->merge_property_indexes();
+        spare = std::move(published);
+        published = std::move(working);
+        current.store(published.get());
+        spare_epoch = domain.advance();
+        catch_up = std::move(log);
+        log.clear();
+        reclaim();
+    }
+
+    /**
+     * @brief Returns the number of mutations not published yet.
+     */
+    size_t pending() const
+    {
+        return log.size();
+    }
+
+private:
+    template<typename Op>
+    auto apply(Op op)
+    {
+        db_t& db = writable();
+        if constexpr (std::is_void_v<decltype(op(db))>) {
+            op(db);
+            log.emplace_back(std::move(op));
+        }
+        else {
+            auto result = op(db);
+            log.emplace_back(std::move(op));
+            return result;
+        }
+    }
+
+    /**
+     * @brief Returns the instance the writer mutates, bringing the spare one up to date first.
+     */
+    db_t& writable()
+    {
+        if (working) {
+            return *working;
+        }
+        if (domain.quiescent(spare_epoch)) {
+            for (auto&& op : catch_up) {
+                op(*spare);
+            }
+            working = std::move(spare);
+        }
+        else {
+            retired.emplace_back(std::move(spare), spare_epoch);
+            working = std::make_unique<db_t>(*published);
+        }
+        catch_up.clear();
+        return *working;
+    }
+
+    void reclaim()
+    {
+        std::erase_if(retired, [this](const auto& r) { return domain.quiescent(r.second); });
+    }
+
+    mutable epoch_domain domain;
+    std::atomic<const db_t*> current{ nullptr };
+    std::unique_ptr<db_t> published;
+    std::unique_ptr<db_t> spare;
+    std::unique_ptr<db_t> working;
+    uint64_t spare_epoch = 0;
+    std::vector<std::function<void(db_t&)>> log;
+    std::vector<std::function<void(db_t&)>> catch_up;
+    std::vector<std::pair<std::unique_ptr<db_t>, uint64_t>> retired;
+};
+
+#endif // !CONCURRENT_HPP
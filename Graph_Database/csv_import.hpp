@@ -0,0 +1,584 @@
+#ifndef CSV_IMPORT_HPP
+#define CSV_IMPORT_HPP
+
+#include <algorithm>
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "graph_db.hpp"
+#include "snapshot.hpp"
+#include "thread_pool.hpp"
+
+/**
+ * @brief Options of the CSV and edge list importers.
+ */
+struct csv_options {
+    /**
+     * @brief The field separator, a space splits on runs of spaces and tabs as in whitespace separated edge lists.
+     */
+    char delimiter = ',';
+    /**
+     * @brief Lines starting with this character are skipped, 0 disables comments.
+     */
+    char comment = 0;
+    /**
+     * @brief Whether the first line holds column names and is skipped.
+     */
+    bool header = true;
+    /**
+     * @brief Whether edge lines start with the edge user id. If not, the ids are the row numbers
+     * counted from the edge count of the database before the import.
+     */
+    bool edge_ids = true;
+    /**
+     * @brief Whether edge endpoints missing from the database are added with default-constructed properties.
+     * If not, an unknown endpoint fails the import.
+     */
+    bool add_missing_vertices = false;
+    /**
+     * @brief The approximate size of the pieces of the file parsed in parallel.
+     */
+    size_t chunk_bytes = size_t(4) << 20;
+};
+
+/**
+ * @brief Converts the text of one CSV field into a value of type T.
+ * @note Specialize it for other property types, parse(text, out) returns false if the text is malformed.
+ */
+template<typename T>
+struct csv_field;
+
+template<typename T>
+    requires std::integral<T> || std::floating_point<T>
+struct csv_field<T> {
+    static bool parse(std::string_view text, T& out)
+    {
+        if (!text.empty() && text.front() == '+') {
+            text.remove_prefix(1);
+        }
+        auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), out);
+        return error == std::errc() && end == text.data() + text.size() && !text.empty();
+    }
+};
+
+template<>
+struct csv_field<bool> {
+    static bool parse(std::string_view text, bool& out)
+    {
+        if (text == "1" || text == "true") {
+            out = true;
+            return true;
+        }
+        if (text == "0" || text == "false") {
+            out = false;
+            return true;
+        }
+        return false;
+    }
+};
+
+template<typename T>
+    requires std::constructible_from<T, const char*, const char*>
+struct csv_field<T> {
+    static bool parse(std::string_view text, T& out)
+    {
+        out = T(text.data(), text.data() + text.size());
+        return true;
+    }
+};
+
+namespace csv_detail {
+
+/**
+ * @brief Splits text into pieces of about chunk_bytes, every piece but the last one ends right after a newline.
+ */
+inline std::vector<std::string_view> split_chunks(std::string_view text, size_t chunk_bytes)
+{
+    std::vector<std::string_view> chunks;
+    chunks.reserve(text.size() / std::max<size_t>(chunk_bytes, 1) + 1);
+    while (!text.empty()) {
+        size_t end = text.size();
+        if (chunk_bytes < text.size()) {
+            size_t newline = text.find('\n', chunk_bytes - 1);
+            end = newline == text.npos ? text.size() : newline + 1;
+        }
+        chunks.push_back(text.substr(0, end));
+        text.remove_prefix(end);
+    }
+    return chunks;
+}
+
+/**
+ * @brief Cuts a line into fields, unquoting fields enclosed in double quotes.
+ * @note Quoted fields may contain the delimiter and doubled quotes but no newline, since chunks are cut at newlines.
+ */
+class field_reader {
+public:
+    field_reader(std::string_view line, char delimiter) : rest(line), delimiter(delimiter)
+    {
+        if (delimiter == ' ') {
+            skip_blanks();
+        }
+    }
+
+    /**
+     * @brief Reads the next field.
+     * @return False if the line has no more fields or a quote is not closed.
+     * @note The field may point into the reader, it is valid until the next call.
+     */
+    bool next(std::string_view& field)
+    {
+        if (done) {
+            return false;
+        }
+        if (!rest.empty() && rest.front() == '"') {
+            if (!unquote()) {
+                return false;
+            }
+            field = unquoted;
+            if (!rest.empty() && !is_delimiter(rest.front())) {
+                return false;
+            }
+        }
+        else {
+            size_t end = 0;
+            while (end < rest.size() && !is_delimiter(rest[end])) {
+                ++end;
+            }
+            field = rest.substr(0, end);
+            rest.remove_prefix(end);
+        }
+        if (rest.empty()) {
+            done = true;
+        }
+        else if (delimiter == ' ') {
+            skip_blanks();
+            done = rest.empty();
+        }
+        else {
+            rest.remove_prefix(1);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Checks whether all fields were read.
+     */
+    bool exhausted() const
+    {
+        return done;
+    }
+
+private:
+    bool is_delimiter(char c) const
+    {
+        return delimiter == ' ' ? c == ' ' || c == '\t' : c == delimiter;
+    }
+
+    void skip_blanks()
+    {
+        while (!rest.empty() && (rest.front() == ' ' || rest.front() == '\t')) {
+            rest.remove_prefix(1);
+        }
+    }
+
+    bool unquote()
+    {
+        unquoted.clear();
+        for (size_t i = 1; i < rest.size(); ++i) {
+            if (rest[i] != '"') {
+                unquoted.push_back(rest[i]);
+            }
+            else if (i + 1 < rest.size() && rest[i + 1] == '"') {
+                unquoted.push_back('"');
+                ++i;
+            }
+            else {
+                rest.remove_prefix(i + 1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::string_view rest;
+    std::string unquoted;
+    char delimiter;
+    bool done = false;
+};
+
+/**
+ * @brief The parsed rows of one chunk, a vector per field.
+ */
+template<typename ...Ts>
+using column_buffers = std::tuple<std::vector<Ts>...>;
+
+[[noreturn]] inline void malformed(std::string_view file, const char* line)
+{
+    size_t number = static_cast<size_t>(std::count(file.data(), line, '\n')) + 1;
+    throw std::runtime_error("csv_import: malformed line " + std::to_string(number));
+}
+
+template<typename T>
+bool parse_into(std::string_view field, std::vector<T>& buffer)
+{
+    T value{};
+    if (!csv_field<T>::parse(field, value)) {
+        return false;
+    }
+    buffer.push_back(std::move(value));
+    return true;
+}
+
+/**
+ * @brief Parses the lines of one chunk, each into the fields Ts... appended to the buffers.
+ * @throws std::runtime_error If a line has a wrong number of fields or a field cannot be converted.
+ */
+template<typename ...Ts>
+void parse_chunk(std::string_view file, std::string_view chunk, const csv_options& options, column_buffers<Ts...>& buffers)
+{
+    while (!chunk.empty()) {
+        size_t end = chunk.find('\n');
+        std::string_view line = chunk.substr(0, end);
+        chunk.remove_prefix(end == chunk.npos ? chunk.size() : end + 1);
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        if (line.empty() || (options.comment != 0 && line.front() == options.comment)) {
+            continue;
+        }
+        field_reader reader(line, options.delimiter);
+        bool ok = [&]<size_t ...Is>(std::index_sequence<Is...>) {
+            std::string_view field;
+            return ((reader.next(field) && parse_into(field, std::get<Is>(buffers))) && ...);
+        }(std::index_sequence_for<Ts...>{});
+        if (!ok || !reader.exhausted()) {
+            malformed(file, line.data());
+        }
+    }
+}
+
+/**
+ * @brief Moves the buffers of all chunks into one set of buffers, in the order of the chunks.
+ */
+template<typename ...Ts>
+column_buffers<Ts...> concatenate(std::vector<column_buffers<Ts...>>& parts, thread_pool& pool)
+{
+    std::vector<size_t> offsets(parts.size() + 1, 0);
+    for (size_t p = 0; p < parts.size(); ++p) {
+        offsets[p + 1] = offsets[p] + std::get<0>(parts[p]).size();
+    }
+    column_buffers<Ts...> result;
+    [&]<size_t ...Is>(std::index_sequence<Is...>) {
+        (std::get<Is>(result).resize(offsets.back()), ...);
+    }(std::index_sequence_for<Ts...>{});
+    auto move_column = [&]<size_t I>(std::integral_constant<size_t, I>) {
+        auto& target = std::get<I>(result);
+        auto move_part = [&](size_t p) {
+            auto& source = std::get<I>(parts[p]);
+            std::move(source.begin(), source.end(), target.begin() + offsets[p]);
+            source = {};
+        };
+        // Bits of std::vector<bool> share words, so only the other columns are moved in parallel.
+        if constexpr (std::is_same_v<std::tuple_element_t<I, std::tuple<Ts...>>, bool>) {
+            for (size_t p = 0; p < parts.size(); ++p) {
+                move_part(p);
+            }
+        }
+        else {
+            pool.parallel_for(0, parts.size(), 1, [&](size_t b, size_t e) {
+                for (size_t p = b; p < e; ++p) {
+                    move_part(p);
+                }
+            });
+        }
+    };
+    [&]<size_t ...Is>(std::index_sequence<Is...>) {
+        (move_column(std::integral_constant<size_t, Is>{}), ...);
+    }(std::index_sequence_for<Ts...>{});
+    return result;
+}
+
+/**
+ * @brief Maps a file and parses all its lines into the fields Ts..., chunks are parsed in parallel.
+ * @throws std::runtime_error If the file cannot be read or a line is malformed.
+ */
+template<typename ...Ts>
+column_buffers<Ts...> parse_file(const std::string& path, const csv_options& options, thread_pool& pool)
+{
+    mapped_file file(path);
+    std::string_view text(reinterpret_cast<const char*>(file.data()), file.size());
+    std::string_view body = text;
+    if (options.header) {
+        size_t newline = body.find('\n');
+        body.remove_prefix(newline == body.npos ? body.size() : newline + 1);
+    }
+    auto chunks = split_chunks(body, options.chunk_bytes);
+    std::vector<column_buffers<Ts...>> parts(chunks.size());
+    pool.parallel_for(0, chunks.size(), 1, [&](size_t b, size_t e) {
+        for (size_t c = b; c < e; ++c) {
+            parse_chunk<Ts...>(text, chunks[c], options, parts[c]);
+        }
+    });
+    return concatenate(parts, pool);
+}
+
+/**
+ * @brief parse_file for the fields of a tuple type.
+ */
+template<typename Tuple>
+struct row_parser;
+
+template<typename ...Ts>
+struct row_parser<std::tuple<Ts...>> {
+    using buffers_t = column_buffers<Ts...>;
+
+    static buffers_t parse(const std::string& path, const csv_options& options, thread_pool& pool)
+    {
+        return parse_file<Ts...>(path, options, pool);
+    }
+};
+
+/**
+ * @brief Returns an rvalue reference to the i-th element of a buffer, or a copy of a bit of std::vector<bool>.
+ */
+template<typename T>
+decltype(auto) take(std::vector<T>& buffer, size_t i)
+{
+    if constexpr (std::is_same_v<T, bool>) {
+        return static_cast<bool>(buffer[i]);
+    }
+    else {
+        return std::move(buffer[i]);
+    }
+}
+
+/**
+ * @brief Returns a range of the tuples prefix(i) + (take(buffer, i) for the buffers First...).
+ * @note Passed as an rvalue to graph_db::add_vertices or add_edges, every column is moved out of its buffer.
+ */
+template<size_t First, typename Buffers, typename Prefix>
+auto move_rows(Buffers& buffers, Prefix prefix)
+{
+    size_t count = std::get<First>(buffers).size();
+    return std::views::iota(size_t(0), count) | std::views::transform([&buffers, prefix](size_t i) {
+        return [&]<size_t ...Is>(std::index_sequence<Is...>) {
+            return std::tuple_cat(prefix(i),
+                std::tuple<decltype(take(std::get<First + Is>(buffers), i))...>(take(std::get<First + Is>(buffers), i)...));
+        }(std::make_index_sequence<std::tuple_size_v<Buffers> - First>{});
+    });
+}
+
+/**
+ * @brief Converts a row number into an edge user id.
+ */
+template<typename Id>
+Id generated_id(size_t row)
+{
+    if constexpr (std::is_arithmetic_v<Id>) {
+        return static_cast<Id>(row);
+    }
+    else {
+        std::string text = std::to_string(row);
+        return Id(text.data(), text.data() + text.size());
+    }
+}
+
+/**
+ * @brief Returns the row number whose generated_id equals the given user id, if there is one.
+ */
+template<typename Id>
+std::optional<size_t> generated_row(const Id& id)
+{
+    if constexpr (std::is_arithmetic_v<Id>) {
+        if (!(id >= Id(0)) || static_cast<long double>(id) >= static_cast<long double>(static_cast<size_t>(-1))) {
+            return std::nullopt;
+        }
+        return static_cast<size_t>(id);
+    }
+    else {
+        size_t row = 0;
+        const char* end = id.data() + id.size();
+        auto [ptr, ec] = std::from_chars(id.data(), end, row);
+        if (ec != std::errc() || ptr != end || id.empty()) {
+            return std::nullopt;
+        }
+        return row;
+    }
+}
+
+/**
+ * @brief Returns the first row number whose generated_id, and those of all rows after it, are not taken.
+ * @note Dense indices are reused by compact(), so the edge count is no safe start, the live ids are scanned instead.
+ */
+template<class GraphSchema>
+size_t first_free_row(const graph_db<GraphSchema>& db, thread_pool& pool)
+{
+    std::mutex mutex;
+    size_t first = 0;
+    pool.parallel_for(0, db.edge_count(), size_t(1) << 14, [&](size_t b, size_t e) {
+        size_t local = 0;
+        for (size_t i = b; i < e; ++i) {
+            if (db.edge_removed(i)) {
+                continue;
+            }
+            if (auto row = generated_row(db.edge_at(i).id())) {
+                local = std::max(local, *row + 1);
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        first = std::max(first, local);
+    });
+    return first;
+}
+
+} // namespace csv_detail
+
+/**
+ * @brief Imports vertexes from a CSV file with the columns (user id, all properties...).
+ * @param db The database to insert into.
+ * @param path The path of the file.
+ * @param options The format of the file.
+ * @param pool The threads parsing the file.
+ * @return A ranges::subrange of the newly created vertexes, in the order of the file.
+ * @throws std::runtime_error If the file cannot be read or a line is malformed, the database is left unchanged then.
+ * @throws std::invalid_argument If a user id is a duplicate, the database is left unchanged then.
+ * @note The file is memory mapped and cut into chunks at newlines, which are parsed on all threads into
+ * per-column buffers. The buffers are then moved into the database with a single graph_db::add_vertices.
+ */
+template<class GraphSchema>
+auto import_vertices(graph_db<GraphSchema>& db, const std::string& path, const csv_options& options = {},
+    thread_pool& pool = default_thread_pool())
+{
+    using row_t = decltype(std::tuple_cat(std::declval<std::tuple<typename GraphSchema::vertex_user_id_t>>(),
+        std::declval<typename GraphSchema::vertex_property_t>()));
+    auto buffers = csv_detail::row_parser<row_t>::parse(path, options, pool);
+    return db.add_vertices(csv_detail::move_rows<0>(buffers, [](size_t) { return std::tuple<>(); }));
+}
+
+/**
+ * @brief Imports directed edges from a CSV file or edge list with the columns
+ * ([user id,] source vertex user id, destination vertex user id, all properties...).
+ * @param db The database to insert into, the endpoints are looked up by their user ids.
+ * @param path The path of the file.
+ * @param options The format of the file, csv_options::edge_ids tells whether the user id column is present.
+ * @param pool The threads parsing the file and resolving the endpoints.
+ * @return A ranges::subrange of the newly created edges, in the order of the file.
+ * @throws std::runtime_error If the file cannot be read, a line is malformed or an endpoint is unknown
+ * and csv_options::add_missing_vertices is off.
+ * @throws std::invalid_argument If an edge user id is a duplicate or an endpoint is removed.
+ * @note The database is left unchanged by a failed import. The vertexes for missing endpoints are only added
+ * once the edge user ids are known to be unique.
+ * @note Generated edge user ids start after the largest live id which is a row number, so they stay unique after compact().
+ * @note Parsing works as in import_vertices, the endpoints are resolved in parallel and the edges are
+ * moved into the database with a single graph_db::add_edges.
+ */
+template<class GraphSchema>
+auto import_edges(graph_db<GraphSchema>& db, const std::string& path, const csv_options& options = {},
+    thread_pool& pool = default_thread_pool())
+{
+    using vertex_id_t = typename GraphSchema::vertex_user_id_t;
+    using edge_id_t = typename GraphSchema::edge_user_id_t;
+    using endpoints_t = std::tuple<edge_id_t, vertex_id_t, vertex_id_t>;
+    using row_t = decltype(std::tuple_cat(std::declval<endpoints_t>(), std::declval<typename GraphSchema::edge_property_t>()));
+    using tail_row_t = decltype(std::tuple_cat(std::declval<std::tuple<vertex_id_t, vertex_id_t>>(),
+        std::declval<typename GraphSchema::edge_property_t>()));
+
+    typename csv_detail::row_parser<row_t>::buffers_t buffers;
+    if (options.edge_ids) {
+        buffers = csv_detail::row_parser<row_t>::parse(path, options, pool);
+    }
+    else {
+        auto tail = csv_detail::row_parser<tail_row_t>::parse(path, options, pool);
+        [&]<size_t ...Is>(std::index_sequence<Is...>) {
+            ((std::get<Is + 1>(buffers) = std::move(std::get<Is>(tail))), ...);
+        }(std::make_index_sequence<std::tuple_size_v<tail_row_t>>{});
+        auto& ids = std::get<0>(buffers);
+        ids.resize(std::get<1>(buffers).size());
+        size_t first = csv_detail::first_free_row(db, pool);
+        pool.parallel_for(0, ids.size(), size_t(1) << 14, [&](size_t b, size_t e) {
+            for (size_t i = b; i < e; ++i) {
+                ids[i] = csv_detail::generated_id<edge_id_t>(first + i);
+            }
+        });
+    }
+
+    const auto& src_ids = std::get<1>(buffers);
+    const auto& dst_ids = std::get<2>(buffers);
+    size_t count = src_ids.size();
+    constexpr size_t npos = static_cast<size_t>(-1);
+    std::vector<size_t> src(count);
+    std::vector<size_t> dst(count);
+    const auto& reader = db;
+    pool.parallel_for(0, count, size_t(1) << 12, [&](size_t b, size_t e) {
+        for (size_t i = b; i < e; ++i) {
+            auto v1 = reader.find_vertex(src_ids[i]);
+            auto v2 = reader.find_vertex(dst_ids[i]);
+            src[i] = v1 ? v1->get_index() : npos;
+            dst[i] = v2 ? v2->get_index() : npos;
+        }
+    });
+
+    if (std::ranges::find(src, npos) != src.end() || std::ranges::find(dst, npos) != dst.end()) {
+        if (!options.add_missing_vertices) {
+            throw std::runtime_error("csv_import: unknown edge endpoint");
+        }
+        // add_edges can only fail on the edge user ids then, they are checked before any vertex is added.
+        const auto& ids = std::get<0>(buffers);
+        std::vector<char> taken(count);
+        pool.parallel_for(0, count, size_t(1) << 12, [&](size_t b, size_t e) {
+            for (size_t i = b; i < e; ++i) {
+                taken[i] = reader.find_edge(ids[i]).has_value();
+            }
+        });
+        std::unordered_set<edge_id_t> seen;
+        for (size_t i = 0; i < count; ++i) {
+            if (taken[i] || !seen.insert(ids[i]).second) {
+                throw std::invalid_argument("graph_db: duplicate edge user id");
+            }
+        }
+        std::unordered_map<vertex_id_t, size_t> added;
+        std::vector<vertex_id_t> missing;
+        size_t next = db.vertex_count();
+        auto resolve = [&](size_t& index, const vertex_id_t& id) {
+            if (index == npos) {
+                auto [it, inserted] = added.try_emplace(id, next + missing.size());
+                if (inserted) {
+                    missing.push_back(id);
+                }
+                index = it->second;
+            }
+        };
+        for (size_t i = 0; i < count; ++i) {
+            resolve(src[i], src_ids[i]);
+            resolve(dst[i], dst_ids[i]);
+        }
+        using defaults_t = typename GraphSchema::vertex_property_t;
+        db.add_vertices(std::views::iota(size_t(0), missing.size()) | std::views::transform([&missing](size_t i) {
+            return std::tuple_cat(std::forward_as_tuple(std::move(missing[i])), defaults_t());
+        }));
+    }
+
+    auto& ids = std::get<0>(buffers);
+    return db.add_edges(csv_detail::move_rows<3>(buffers, [&](size_t i) {
+        return std::tuple_cat(std::forward_as_tuple(std::move(ids[i])),
+            std::make_tuple(reader.vertex_at(src[i]), reader.vertex_at(dst[i])));
+    }));
+}
+
+#endif // !CSV_IMPORT_HPP
@@ -0,0 +1,320 @@
+#ifndef DICTIONARY_COLUMN_HPP
+#define DICTIONARY_COLUMN_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "column_storage.hpp"
+#include "id_index.hpp"
+#include "scan.hpp"
+#include "simd_kernels.hpp"
+
+/**
+ * @brief A pool of distinct strings, each identified by a dense 32-bit code in the order of interning.
+ * @note Characters live in fixed blocks that never move, so views into the pool stay valid for its whole lifetime.
+ */
+class string_pool {
+public:
+    /**
+     * @brief The code returned when the string is not in the pool.
+     */
+    static constexpr uint32_t npos = static_cast<uint32_t>(-1);
+
+    string_pool() = default;
+
+    /**
+     * @brief Copies the strings of another pool, every string keeps its code.
+     */
+    string_pool(const string_pool& other)
+    {
+        views.reserve(other.views.size());
+        index.reserve(other.views.size());
+        for (auto&& v : other.views) {
+            views.push_back(store(v));
+            index.try_insert(views.back(), views.size() - 1, *this);
+        }
+    }
+
+    string_pool& operator=(const string_pool&) = delete;
+
+    /**
+     * @brief Returns the code of the string, adding it to the pool if it is new.
+     * @throws std::length_error If the pool would hold more than 2^32 - 1 strings.
+     */
+    uint32_t intern(std::string_view value)
+    {
+        size_t found = index.find(value, *this);
+        if (found != index.npos) {
+            return static_cast<uint32_t>(found);
+        }
+        if (views.size() >= npos) {
+            throw std::length_error("string_pool: too many distinct strings");
+        }
+        views.push_back(store(value));
+        index.try_insert(views.back(), views.size() - 1, *this);
+        return static_cast<uint32_t>(views.size() - 1);
+    }
+
+    /**
+     * @brief Returns the code of the string or npos, the pool is not modified.
+     */
+    uint32_t find(std::string_view value) const
+    {
+        size_t found = index.find(value, *this);
+        return found == index.npos ? npos : static_cast<uint32_t>(found);
+    }
+
+    std::string_view operator[](size_t code) const
+    {
+        return views[code];
+    }
+
+    /**
+     * @brief Returns the number of distinct strings in the pool.
+     */
+    size_t size() const
+    {
+        return views.size();
+    }
+
+    /**
+     * @brief Returns the number of characters stored in the pool.
+     */
+    size_t char_count() const
+    {
+        return chars;
+    }
+
+private:
+    static constexpr size_t block_size = 64 * 1024;
+
+    std::string_view store(std::string_view value)
+    {
+        if (value.empty()) {
+            return std::string_view();
+        }
+        char* data;
+        // Strings longer than a quarter of a block get a block of their own, the current one stays open for short ones.
+        if (value.size() > block_size / 4) {
+            blocks.push_back(std::make_unique<char[]>(value.size()));
+            data = blocks.back().get();
+        }
+        else {
+            if (current == nullptr || current_used + value.size() > block_size) {
+                blocks.push_back(std::make_unique<char[]>(block_size));
+                current = blocks.back().get();
+                current_used = 0;
+            }
+            data = current + current_used;
+            current_used += value.size();
+        }
+        value.copy(data, value.size());
+        chars += value.size();
+        return std::string_view(data, value.size());
+    }
+
+    std::vector<std::unique_ptr<char[]>> blocks;
+    char* current = nullptr;
+    size_t current_used = 0;
+    size_t chars = 0;
+    std::vector<std::string_view> views;
+    id_index<std::string_view> index;
+};
+
+/**
+ * @brief A dictionary-encoded column of strings which stores a 32-bit code of a string_pool per row.
+ * @note Reading returns a std::string_view into the pool. Columns of one graph_db share a single pool,
+ * so a repeated label costs 4 bytes per row and is stored once for the whole database.
+ * @note Copies of the column share the pool, which is not synchronized. A copy of a whole graph_db gets its own pool.
+ */
+class dictionary_column {
+public:
+    using value_type = std::string;
+
+    dictionary_column() : pool_(std::make_shared<string_pool>()) {}
+
+    explicit dictionary_column(std::shared_ptr<string_pool> pool) : pool_(std::move(pool)) {}
+
+    std::string_view operator[](size_t i) const
+    {
+        return (*pool_)[codes[i]];
+    }
+
+    void set(size_t i, std::string_view value)
+    {
+        codes[i] = pool_->intern(value);
+    }
+
+    void emplace_back()
+    {
+        codes.push_back(pool_->intern(std::string_view()));
+    }
+
+    template<typename V>
+    void emplace_back(V&& value)
+    {
+        codes.push_back(pool_->intern(std::string_view(value)));
+    }
+
+    void push_back(std::string_view value)
+    {
+        emplace_back(value);
+    }
+
+    void reserve(size_t n)
+    {
+        codes.reserve(n);
+    }
+
+    size_t capacity() const
+    {
+        return codes.capacity();
+    }
+
+    void resize(size_t n)
+    {
+        codes.resize(n, pool_->intern(std::string_view()));
+    }
+
+    /**
+     * @brief Removes all rows, the strings stay in the pool.
+     */
+    void clear()
+    {
+        codes.clear();
+    }
+
+    size_t size() const
+    {
+        return codes.size();
+    }
+
+    /**
+     * @brief Keeps only the rows at the given increasing positions, the pool is left untouched.
+     * @see column_retain
+     */
+    void retain(const std::vector<size_t>& rows)
+    {
+        for (size_t j = 0; j < rows.size(); ++j) {
+            codes[j] = codes[rows[j]];
+        }
+        codes.resize(rows.size());
+    }
+
+    /**
+     * @brief Reorders the rows so that the j-th one is the former order[j]-th, the pool is left untouched.
+     * @see column_permute
+     */
+    void permute(const std::vector<size_t>& order)
+    {
+        std::vector<uint32_t> permuted(order.size());
+        for (size_t j = 0; j < order.size(); ++j) {
+            permuted[j] = codes[order[j]];
+        }
+        codes = std::move(permuted);
+    }
+
+    /**
+     * @brief Returns the code of the i-th row.
+     */
+    uint32_t code(size_t i) const
+    {
+        return codes[i];
+    }
+
+    const uint32_t* code_data() const
+    {
+        return codes.data();
+    }
+
+    const std::shared_ptr<string_pool>& pool() const
+    {
+        return pool_;
+    }
+
+    /**
+     * @brief Switches to a copy of the current pool without touching the codes.
+     * @pre The pool holds the same strings under the same codes, e.g. it was copy-constructed from pool().
+     */
+    void rebind_pool(std::shared_ptr<string_pool> pool)
+    {
+        pool_ = std::move(pool);
+    }
+
+    /**
+     * @brief Moves the column over to another pool, existing rows are re-interned in it.
+     */
+    void share_pool(std::shared_ptr<string_pool> pool)
+    {
+        if (pool == pool_) {
+            return;
+        }
+        for (auto&& c : codes) {
+            c = pool->intern((*pool_)[c]);
+        }
+        pool_ = std::move(pool);
+    }
+
+private:
+    std::vector<uint32_t> codes;
+    std::shared_ptr<string_pool> pool_;
+};
+
+/**
+ * @brief Selects the storage of a property column like compact_column_t, but dictionary-encodes strings.
+ * @note A schema opts in with template<typename T> using column_t = dictionary_column_t<T>;
+ */
+template<typename T>
+struct dictionary_column_selector {
+    using type = compact_column_t<T>;
+};
+template<>
+struct dictionary_column_selector<std::string> {
+    using type = dictionary_column;
+};
+
+template<typename T>
+using dictionary_column_t = typename dictionary_column_selector<T>::type;
+
+/**
+ * @brief Compares every string of a dictionary column with a constant in parallel.
+ * @note Equality and inequality look the constant up in the pool once and compare codes with SIMD kernels,
+ * the ordering operators compare the strings themselves.
+ */
+template<typename V>
+selection_bitmap filter_column(const dictionary_column& column, compare_op op, const V& value)
+{
+    std::string_view view(value);
+    if (op == compare_op::eq || op == compare_op::ne) {
+        uint32_t code = column.pool()->find(view);
+        selection_bitmap result(column.size());
+        if (code == string_pool::npos) {
+            if (op == compare_op::ne) {
+                result.set_all();
+            }
+            return result;
+        }
+        // Codes are compared for bit equality only, so reading them as int is exact.
+        const int* codes = reinterpret_cast<const int*>(column.code_data());
+        default_thread_pool().parallel_for(0, column.size(), scan_chunk_rows, [&](size_t b, size_t e) {
+            simd_compare<int>(codes + b, e - b, op, static_cast<int>(code), result.word_data() + b / 64);
+        });
+        return result;
+    }
+    return scan_columns(column.size(), [op, view](std::string_view x) {
+        switch (op) {
+        case compare_op::lt: return x < view;
+        case compare_op::le: return x <= view;
+        case compare_op::gt: return x > view;
+        default: return x >= view;
+        }
+    }, column);
+}
+
+#endif // !DICTIONARY_COLUMN_HPP
@@ -1,18 +1,55 @@
 #ifndef EDGE
 #define EDGE
 
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
 template<class GraphSchema>
+class graph_db;
+
+template<class GraphSchema, bool IsConst>
 class vertex;
 
-template<class GraphSchema>
+/**
+ * @brief A lightweight handle of an edge stored in a graph_db.
+ * @tparam IsConst Whether the handle came from a const graph_db, its setters do not compile then.
+ * @note It is trivially copyable, all reads and writes go straight into the columns of the database.
+ * @note A mutable handle converts implicitly to the const one.
+ */
+template<class GraphSchema, bool IsConst = false>
 class edge {
 public:
+    /**
+     * @see vertex::db_pointer
+     */
+    using db_pointer = std::conditional_t<IsConst, const graph_db<GraphSchema>*, graph_db<GraphSchema>*>;
+
+    edge() = default;
+
+    /**
+     * @brief Creates a handle of an edge of the given database.
+     * @param db The database the edge belongs to.
+     * @param index A dense index of the edge in the database.
+     */
+    edge(db_pointer db, size_t index) : db(db), index(index) {}
+
+    /**
+     * @brief Converts a mutable handle to a const one.
+     */
+    template<bool OtherConst>
+        requires (IsConst && !OtherConst)
+    edge(const edge<GraphSchema, OtherConst>& other) : db(other.db), index(other.index) {}
+
     /**
      * @brief Returns the immutable user id of the element.
+     * @note It is a std::string_view when the schema interns the ids.
+     * @see schema_id_column
      */
-    auto id() const
+    decltype(auto) id() const
     {
-        return eid;
+        return db->edge_id(index);
     }
 
     /**
@@ -21,7 +58,7 @@ public:
      */
     auto get_properties() const
     {
-        return properties;
+        return db->get_edge_properties(index);
     }
 
     /**
@@ -34,7 +71,7 @@ public:
     template<size_t I>
     decltype(auto) get_property() const
     {
-        return std::get<I>(properties);
+        return db->template get_edge_property<I>(index);
     }
 
     /**
@@ -44,9 +81,11 @@ public:
      * @note Should not compile if not provided with all properties.
      */
     template<typename ...PropsType>
-    void set_properties(PropsType &&...props)
+        requires (sizeof...(PropsType) == std::tuple_size_v<typename GraphSchema::edge_property_t>)
+    void set_properties(PropsType &&...props) const
+        requires (!IsConst)
     {
-        properties = std::make_tuple(std::forward<PropsType>(props)...);
+        db->set_edge_properties(index, std::forward<PropsType>(props)...);
     }
 
     /**
@@ -57,33 +96,42 @@ public:
      * @note The first property is on index 0.
      */
     template<size_t I, typename PropType>
-    void set_property(const PropType& prop)
+    void set_property(const PropType& prop) const
+        requires (!IsConst)
     {
-        std::get<I>(properties) = prop;
+        db->template set_edge_property<I>(index, prop);
     }
 
     /**
      * @brief Returns the source vertex of the edge.
      * @return The vertex.
      */
-    auto src() const
+    vertex<GraphSchema, IsConst> src() const
     {
-        return src_;
+        return vertex<GraphSchema, IsConst>(db, db->edge_src[index]);
     }
 
     /**
      * @brief Returns the destination vertex of the edge.
      * @return The vertex.
      */
-    auto dst() const
+    vertex<GraphSchema, IsConst> dst() const
     {
-        return dst_;
+        return vertex<GraphSchema, IsConst>(db, db->edge_dst[index]);
+    }
+
+    /**
+     * @brief Returns the dense index of the edge in the database.
+     */
+    size_t get_index() const
+    {
+        return index;
     }
 private:
-    // vertex_user_id_t id;
-    GraphSchema::edge_user_id_t eid;
-    GraphSchema::edge_property_t properties;
-    vertex src_;
-    vertex dst_;
+    template<class, bool>
+    friend class edge;
+
+    db_pointer db = nullptr;
+    size_t index = 0;
 };
 #endif // !EDGE
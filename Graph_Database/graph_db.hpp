@@ -1,6 +1,36 @@
 #ifndef GRAPH_DB_HPP
 #define GRAPH_DB_HPP
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "adjacency_index.hpp"
+#include "column_storage.hpp"
+#include "dictionary_column.hpp"
+#include "id_index.hpp"
+#include "instrumentation.hpp"
+#include "memory_arena.hpp"
+#include "property_index.hpp"
+#include "scan.hpp"
+#include "simd_kernels.hpp"
+#include "snapshot.hpp"
+#include "tombstones.hpp"
 #include "vertex_class.hpp"
+#include "vertex_order.hpp"
+#include "wal.hpp"
 #include "edge_class.hpp"
 #include "vertex_edge_iterators.hpp"
 
@@ -36,6 +66,164 @@ using add_vector_t = add_vector<T>::type;
 
 //struct add_vector { template< typename T> using type = std::vector< T>; };
 
+/**
+ * @brief Selects the allocator of the id, endpoint and std::vector property columns from the schema.
+ * @note A schema may declare allocator_t, e.g. std::pmr::polymorphic_allocator<std::byte> together with
+ * an arena_resource, it is rebound to the element type of every column. Otherwise std::allocator is used.
+ * @note Only these columns use it. The id indexes, the adjacency indexes, the tombstone bitmaps,
+ * the property indexes, the insertion order and the write-ahead log buffers keep std::allocator,
+ * so an arena holds the bulk of a graph's rows but not its indexes.
+ */
+template<class GraphSchema>
+struct schema_allocator {
+	using type = std::allocator<std::byte>;
+};
+template<class GraphSchema>
+	requires requires { typename GraphSchema::allocator_t; }
+struct schema_allocator<GraphSchema> {
+	using type = typename GraphSchema::allocator_t;
+};
+
+template<class GraphSchema, typename T>
+using schema_vector_t = std::vector<T, typename std::allocator_traits<typename schema_allocator<GraphSchema>::type>::template rebind_alloc<T>>;
+
+/**
+ * @brief Selects the storage of property columns from the schema.
+ * @note A schema may declare a template alias column_t<T> (e.g. compact_column_t) to choose the column
+ * type of each property at compile time, otherwise every property is stored in a std::vector
+ * with the allocator of the schema.
+ */
+template<class GraphSchema>
+struct schema_column {
+	template<typename T>
+	using type = schema_vector_t<GraphSchema, T>;
+};
+template<class GraphSchema>
+	requires requires { typename GraphSchema::template column_t<int>; }
+struct schema_column<GraphSchema> {
+	template<typename T>
+	using type = typename GraphSchema::template column_t<T>;
+};
+
+/**
+ * @brief Selects the storage of the user id column from the schema.
+ * @note A schema with std::string ids may declare static constexpr bool intern_ids = true to store them
+ * as codes of the string pool shared with the dictionary-encoded properties, id() then returns a std::string_view.
+ */
+template<class GraphSchema, typename Id>
+struct schema_id_column {
+	using type = schema_vector_t<GraphSchema, Id>;
+	using key_type = Id;
+};
+template<class GraphSchema>
+	requires requires { requires GraphSchema::intern_ids; }
+struct schema_id_column<GraphSchema, std::string> {
+	using type = dictionary_column;
+	using key_type = std::string_view;
+};
+
+/**
+ * @brief Checks whether the schema asks for the reverse (incoming edges) adjacency index.
+ * @note A schema enables it by declaring static constexpr bool reverse_index = true, which makes
+ * vertex::in_edges() available at the cost of a second CSR index maintained on every insertion.
+ */
+template<class GraphSchema>
+struct schema_reverse_index : std::false_type {};
+template<class GraphSchema>
+	requires requires { { GraphSchema::reverse_index } -> std::convertible_to<bool>; }
+struct schema_reverse_index<GraphSchema> : std::bool_constant<GraphSchema::reverse_index> {};
+
+/**
+ * @brief Checks whether the schema asks for the edges of every vertex to be ordered by the other endpoint.
+ * @note A schema enables it by declaring static constexpr bool sorted_adjacency = true. vertex::edges() then
+ * iterates by the dense index of the destination and vertex::in_edges() by that of the source, ties in insertion
+ * order, and graph_db::common_neighbors() intersects the stored lists directly. Insertions cost a merge into
+ * the lists of their vertexes.
+ */
+template<class GraphSchema>
+struct schema_sorted_adjacency : std::false_type {};
+template<class GraphSchema>
+	requires requires { { GraphSchema::sorted_adjacency } -> std::convertible_to<bool>; }
+struct schema_sorted_adjacency<GraphSchema> : std::bool_constant<GraphSchema::sorted_adjacency> {};
+
+/**
+ * @brief Checks whether the schema asks for operation statistics, see graph_db::stats().
+ * @note A schema enables them by declaring static constexpr bool instrumented = true. Otherwise the recorder
+ * is an empty member whose calls compile to nothing, so uninstrumented databases pay nothing for it.
+ */
+template<class GraphSchema>
+struct schema_instrumented : std::false_type {};
+template<class GraphSchema>
+	requires requires { { GraphSchema::instrumented } -> std::convertible_to<bool>; }
+struct schema_instrumented<GraphSchema> : std::bool_constant<GraphSchema::instrumented> {};
+
+template<typename Sequence, size_t I>
+struct index_sequence_contains;
+template<size_t ...Is, size_t I>
+struct index_sequence_contains<std::index_sequence<Is...>, I> : std::bool_constant<((Is == I) || ...)> {};
+
+template<typename Properties, typename Hashed, typename Sorted,
+	typename Is = std::make_index_sequence<std::tuple_size_v<Properties>>>
+struct property_indexes;
+template<typename Properties, typename Hashed, typename Sorted, size_t ...Is>
+struct property_indexes<Properties, Hashed, Sorted, std::index_sequence<Is...>> {
+	using type = std::tuple<property_index<std::tuple_element_t<Is, Properties>,
+		index_sequence_contains<Hashed, Is>::value, index_sequence_contains<Sorted, Is>::value>...>;
+};
+
+/**
+ * @brief Selects the properties with secondary indexes from the schema.
+ * @note A schema may declare vertex_hash_indexes, vertex_sorted_indexes, edge_hash_indexes and edge_sorted_indexes
+ * as std::index_sequence of the indices of the properties to index. Hash indexes answer equality lookups,
+ * sorted ones answer ranges too. add_* and set_property keep them up to date.
+ */
+template<class GraphSchema>
+struct schema_property_indexes {
+private:
+	static auto vertex_hashed()
+	{
+		if constexpr (requires { typename GraphSchema::vertex_hash_indexes; }) {
+			return typename GraphSchema::vertex_hash_indexes{};
+		}
+		else {
+			return std::index_sequence<>{};
+		}
+	}
+	static auto vertex_sorted()
+	{
+		if constexpr (requires { typename GraphSchema::vertex_sorted_indexes; }) {
+			return typename GraphSchema::vertex_sorted_indexes{};
+		}
+		else {
+			return std::index_sequence<>{};
+		}
+	}
+	static auto edge_hashed()
+	{
+		if constexpr (requires { typename GraphSchema::edge_hash_indexes; }) {
+			return typename GraphSchema::edge_hash_indexes{};
+		}
+		else {
+			return std::index_sequence<>{};
+		}
+	}
+	static auto edge_sorted()
+	{
+		if constexpr (requires { typename GraphSchema::edge_sorted_indexes; }) {
+			return typename GraphSchema::edge_sorted_indexes{};
+		}
+		else {
+			return std::index_sequence<>{};
+		}
+	}
+
+public:
+	using vertex_type = typename property_indexes<typename GraphSchema::vertex_property_t,
+		decltype(vertex_hashed()), decltype(vertex_sorted())>::type;
+	using edge_type = typename property_indexes<typename GraphSchema::edge_property_t,
+		decltype(edge_hashed()), decltype(edge_sorted())>::type;
+};
+
 
 /**
  * @brief A graph database that takes its schema (types and number of vertex/edge properties, user id types) from a given trait
@@ -46,8 +234,92 @@ template<class GraphSchema>
 class graph_db {
 public:
 
-	using vertex_properties_t = type_transform_t<vertex_property_t, add_vector_t>;
-	using edge_properties_t = type_transform_t<edge_property_t, add_vector_t>;
+	using vertex_properties_t = type_transform_t<typename GraphSchema::vertex_property_t, schema_column<GraphSchema>::template type>;
+	using edge_properties_t = type_transform_t<typename GraphSchema::edge_property_t, schema_column<GraphSchema>::template type>;
+	using vertex_ids_t = typename schema_id_column<GraphSchema, typename GraphSchema::vertex_user_id_t>::type;
+	using edge_ids_t = typename schema_id_column<GraphSchema, typename GraphSchema::edge_user_id_t>::type;
+	using vertex_indexes_t = typename schema_property_indexes<GraphSchema>::vertex_type;
+	using edge_indexes_t = typename schema_property_indexes<GraphSchema>::edge_type;
+
+	/**
+	 * @brief True if the database maintains the index of incoming edges.
+	 * @see schema_reverse_index
+	 */
+	static constexpr bool has_reverse_index = schema_reverse_index<GraphSchema>::value;
+
+	/**
+	 * @brief True if the edges of every vertex are ordered by the dense index of the other endpoint.
+	 * @see schema_sorted_adjacency
+	 */
+	static constexpr bool has_sorted_adjacency = schema_sorted_adjacency<GraphSchema>::value;
+
+	/**
+	 * @brief True if the database records operation statistics.
+	 * @see schema_instrumented
+	 */
+	static constexpr bool has_instrumentation = schema_instrumented<GraphSchema>::value;
+
+	/**
+	 * @brief The allocator of the columns, rebound to their element types.
+	 * @see schema_allocator
+	 */
+	using allocator_type = typename schema_allocator<GraphSchema>::type;
+
+	graph_db()
+	{
+		share_string_pool();
+	}
+
+	/**
+	 * @brief Creates an empty database whose columns allocate through the given allocator.
+	 * @note Columns of a schema column_t which do not take the allocator keep their own,
+	 * the indexes always use std::allocator, see schema_allocator.
+	 */
+	explicit graph_db(const allocator_type& alloc)
+		: vertex_ids(make_column<vertex_ids_t>(alloc)), edge_ids(make_column<edge_ids_t>(alloc)),
+		vertex_properties(make_columns<vertex_properties_t>(alloc)), edge_properties(make_columns<edge_properties_t>(alloc)),
+		edge_src(alloc), edge_dst(alloc)
+	{
+		share_string_pool();
+	}
+
+	/**
+	 * @brief Returns the allocator the database was created with.
+	 */
+	allocator_type get_allocator() const
+	{
+		return allocator_type(edge_src.get_allocator());
+	}
+
+	/**
+	 * @brief Copies the whole database.
+	 * @note The copy gets its own string pool, so the two databases can be modified independently.
+	 */
+	graph_db(const graph_db& other)
+		: vertex_ids(other.vertex_ids), edge_ids(other.edge_ids),
+		vertex_properties(other.vertex_properties), edge_properties(other.edge_properties),
+		edge_src(other.edge_src), edge_dst(other.edge_dst),
+		adjacency(other.adjacency), reverse_adjacency(other.reverse_adjacency),
+		vertex_index(other.vertex_index), edge_index(other.edge_index),
+		vertex_property_indexes(other.vertex_property_indexes), edge_property_indexes(other.edge_property_indexes),
+		removed_vertices(other.removed_vertices), removed_edges(other.removed_edges),
+		insertion_order(other.insertion_order), instruments(other.instruments), log_sequence(other.log_sequence)
+	{
+		clone_string_pool();
+	}
+
+	graph_db(graph_db&&) = default;
+
+	graph_db& operator=(const graph_db& other)
+	{
+		if (this != &other) {
+			graph_db copy(other);
+			*this = std::move(copy);
+		}
+		return *this;
+	}
+
+	graph_db& operator=(graph_db&&) = default;
 	//int lastIndex = 0;
 
 	/**
@@ -55,44 +327,66 @@ public:
 	 * @see vertex
 	 */
 	using vertex_t = vertex<GraphSchema>;
+	/**
+	 * @brief A type representing a vertex of a const database, its setters do not compile.
+	 * @note Returned by the const accessors, a vertex_t converts to it implicitly.
+	 * @see vertex
+	 */
+	using const_vertex_t = vertex<GraphSchema, true>;
 		/**
 		 * @brief A type representing an edge.
 		 * @see edge
 		 */
 	using edge_t = edge<GraphSchema>;
+	/**
+	 * @brief A type representing an edge of a const database, its setters do not compile.
+	 * @see const_vertex_t
+	 */
+	using const_edge_t = edge<GraphSchema, true>;
 
 		/**
 		 * @brief A type representing a vertex iterator. Must be at least of output iterator. Returned value_type is a vertex.
-		 * @note Iterate in insertion order.
+		 * @note Iterate in insertion order, also after reorder() renumbered the dense indices.
+		 * @note It is a random access iterator over the live dense indices, or over the insertion order after reorder(),
+		 * get_vertexes() is a sized range. Removed vertexes are skipped by arithmetic and sizes too.
 		 */
 		using vertex_it_t = vertex_it_t_class<GraphSchema>;
+		using const_vertex_it_t = vertex_it_t_class<GraphSchema, true>;
 
 		/**
 		 * @brief A type representing a edge iterator. Must be at least an output iterator. Returned value_type is an edge.
 		 * @note Iterate in insertion order.
+		 * @note It is a random access iterator over the live dense indices, get_edges() is a sized range.
+		 * Removed edges are skipped by arithmetic and sizes too.
 		 */
 		using edge_it_t = edge_it_t_class<GraphSchema>;
+		using const_edge_it_t = edge_it_t_class<GraphSchema, true>;
 
 		/**
 		 * @brief A type representing a neighbor iterator. Must be at least an output iterator. Returned value_type is an edge.
-		 * @note Iterate in insertion order.
+		 * @note Iterate in insertion order, or by the other endpoint if the schema enables schema_sorted_adjacency.
+		 * @note Backed by the CSR adjacency index, a scan costs O(degree) over contiguous memory.
 		 */
-		using neighbor_it_t = edge_it_t; //TODO oddlenej iterator
+		using neighbor_it_t = neighbor_it_t_class<GraphSchema>;
+		using const_neighbor_it_t = neighbor_it_t_class<GraphSchema, true>;
 
 		/**
 		 * @brief Insert a vertex into the database.
 		 * @param vuid A user id of the newly created vertex.
 		 * @return The newly created vertex.
 		 * @note The vertex's properties have default values.
+		 * @throws std::invalid_argument If a vertex with the same user id already exists.
 		 */
 		vertex_t add_vertex(typename GraphSchema::vertex_user_id_t&& vuid)
 		{
-			vertex_ids.push_back(vuid);
-
+			auto timer = instruments.time(graph_op::add_vertex);
+			push_vertex_id(std::move(vuid));
+			std::apply([](auto&... columns) { (columns.emplace_back(), ...); }, vertex_properties);
+			return finish_vertex();
 		}
 		vertex_t add_vertex(const typename GraphSchema::vertex_user_id_t& vuid)
 		{
-
+			return add_vertex(typename GraphSchema::vertex_user_id_t(vuid));
 	}
 
 	/**
@@ -104,15 +398,35 @@ public:
 	 * @note Should not compile if not provided with all properties.
 	 */
 	template<typename ...Props>
-	vertex_t add_vertex(typename GraphSchema::vertex_user_id_t&& vuid, Props &&...props);
+		requires (sizeof...(Props) == std::tuple_size_v<typename GraphSchema::vertex_property_t>)
+	vertex_t add_vertex(typename GraphSchema::vertex_user_id_t&& vuid, Props &&...props)
+	{
+		auto timer = instruments.time(graph_op::add_vertex);
+		push_vertex_id(std::move(vuid));
+		push_columns(vertex_properties, std::forward<Props>(props)...);
+		return finish_vertex();
+	}
 	template<typename ...Props>
-	vertex_t add_vertex(const typename GraphSchema::vertex_user_id_t& vuid, Props &&...props);
+		requires (sizeof...(Props) == std::tuple_size_v<typename GraphSchema::vertex_property_t>)
+	vertex_t add_vertex(const typename GraphSchema::vertex_user_id_t& vuid, Props &&...props)
+	{
+		return add_vertex(typename GraphSchema::vertex_user_id_t(vuid), std::forward<Props>(props)...);
+	}
 
 	/**
 	 * @brief Returns begin() and end() iterators to all vertexes in the database.
 	 * @return A ranges::subrange(begin(), end()) of vertex iterators.
+	 * @note Removed vertexes are skipped, the size of the range counts only the live ones.
+	 * @note A const database hands out const_vertex_t handles.
 	 */
-	std::ranges::subrange<vertex_it_t> get_vertexes() const;
+	std::ranges::subrange<vertex_it_t> get_vertexes()
+	{
+		return vertex_range<vertex_it_t>(this);
+	}
+	std::ranges::subrange<const_vertex_it_t> get_vertexes() const
+	{
+		return vertex_range<const_vertex_it_t>(this);
+	}
 
 	/**
 	 * @brief Insert a directed edge between v1 and v2 with a given user id.
@@ -121,9 +435,20 @@ public:
 	 * @param v2 A destination vertex of the edge.
 	 * @return The newly create edge.
 	 * @note The edge's properties have default values.
+	 * @throws std::invalid_argument If an edge with the same user id already exists or an endpoint is removed.
 	 */
-	edge_t add_edge(typename GraphSchema::edge_user_id_t&& euid, const vertex_t& v1, const vertex_t& v2);
-	edge_t add_edge(const typename GraphSchema::edge_user_id_t& euid, const vertex_t& v1, const vertex_t& v2);
+	edge_t add_edge(typename GraphSchema::edge_user_id_t&& euid, const const_vertex_t& v1, const const_vertex_t& v2)
+	{
+		auto timer = instruments.time(graph_op::add_edge);
+		check_endpoints(v1, v2);
+		push_edge_id(std::move(euid));
+		std::apply([](auto&... columns) { (columns.emplace_back(), ...); }, edge_properties);
+		return finish_edge(v1, v2);
+	}
+	edge_t add_edge(const typename GraphSchema::edge_user_id_t& euid, const const_vertex_t& v1, const const_vertex_t& v2)
+	{
+		return add_edge(typename GraphSchema::edge_user_id_t(euid), v1, v2);
+	}
 
 	/**
 	 * @brief Insert a directed edge between v1 and v2 with a given user id and given properties.
@@ -136,23 +461,1665 @@ public:
 	 * @note Should not compile if not provided with all properties.
 	 */
 	template<typename ...Props>
-	edge_t add_edge(typename GraphSchema::edge_user_id_t&& euid, const vertex_t& v1, const vertex_t& v2, Props &&...props);
+		requires (sizeof...(Props) == std::tuple_size_v<typename GraphSchema::edge_property_t>)
+	edge_t add_edge(typename GraphSchema::edge_user_id_t&& euid, const const_vertex_t& v1, const const_vertex_t& v2, Props &&...props)
+	{
+		auto timer = instruments.time(graph_op::add_edge);
+		check_endpoints(v1, v2);
+		push_edge_id(std::move(euid));
+		push_columns(edge_properties, std::forward<Props>(props)...);
+		return finish_edge(v1, v2);
+	}
 	template<typename ...Props>
-	edge_t add_edge(const typename GraphSchema::edge_user_id_t& euid, const vertex_t& v1, const vertex_t& v2, Props &&...props);
+		requires (sizeof...(Props) == std::tuple_size_v<typename GraphSchema::edge_property_t>)
+	edge_t add_edge(const typename GraphSchema::edge_user_id_t& euid, const const_vertex_t& v1, const const_vertex_t& v2, Props &&...props)
+	{
+		return add_edge(typename GraphSchema::edge_user_id_t(euid), v1, v2, std::forward<Props>(props)...);
+	}
 
 	/**
 	 * @brief Returns begin() and end() iterators to all edges in the database.
 	 * @return A ranges::subrange(begin(), end()) of edge iterators.
+	 * @note Removed edges are skipped, the size of the range counts only the live ones.
+	 * @note A const database hands out const_edge_t handles.
 	 */
-	std::ranges::subrange<edge_it_t> get_edges() const;
-private:
+	std::ranges::subrange<edge_it_t> get_edges()
+	{
+		return edge_range<edge_it_t>(this);
+	}
+	std::ranges::subrange<const_edge_it_t> get_edges() const
+	{
+		return edge_range<const_edge_it_t>(this);
+	}
+
+	/**
+	 * @brief Returns the vertex with the given dense index.
+	 */
+	vertex_t vertex_at(size_t index)
+	{
+		return make_vertex(index);
+	}
+	const_vertex_t vertex_at(size_t index) const
+	{
+		return make_vertex(index);
+	}
+
+	/**
+	 * @brief Returns the edge with the given dense index.
+	 */
+	edge_t edge_at(size_t index)
+	{
+		return make_edge(index);
+	}
+	const_edge_t edge_at(size_t index) const
+	{
+		return make_edge(index);
+	}
+
+	/**
+	 * @brief Removes a vertex together with all its forward and incoming edges.
+	 * @throws std::invalid_argument If the vertex is removed already.
+	 * @note The vertex only gets a tombstone, its dense index stays taken until compact().
+	 * Incoming edges are found through the reverse index if the schema has one, otherwise by a scan of all edges.
+	 */
+	void remove_vertex(const const_vertex_t& v)
+	{
+		size_t index = v.get_index();
+		if (removed_vertices.test(index)) {
+			throw std::invalid_argument("graph_db: vertex already removed");
+		}
+		for (size_t e : adjacency.neighbors(index)) {
+			if (!removed_edges.test(e)) {
+				bury_edge(e);
+			}
+		}
+		if constexpr (has_reverse_index) {
+			for (size_t e : reverse_adjacency.neighbors(index)) {
+				if (!removed_edges.test(e)) {
+					bury_edge(e);
+				}
+			}
+		}
+		else {
+			for (size_t e = 0; e < edge_dst.size(); ++e) {
+				if (edge_dst[e] == index && !removed_edges.test(e)) {
+					bury_edge(e);
+				}
+			}
+		}
+		vertex_index.erase(vertex_ids[index], index);
+		unindex_row(vertex_properties, vertex_property_indexes, index);
+		removed_vertices.set(index);
+		log_vertex(wal_record::remove_vertex, index);
+	}
+
+	/**
+	 * @brief Removes an edge.
+	 * @throws std::invalid_argument If the edge is removed already.
+	 * @note The edge only gets a tombstone, its dense index stays taken until compact().
+	 */
+	void remove_edge(const const_edge_t& e)
+	{
+		if (removed_edges.test(e.get_index())) {
+			throw std::invalid_argument("graph_db: edge already removed");
+		}
+		bury_edge(e.get_index());
+		log_edge(wal_record::remove_edge, e.get_index());
+	}
+
+	/**
+	 * @brief Checks whether the vertex with the given dense index was removed.
+	 */
+	bool vertex_removed(size_t index) const
+	{
+		return removed_vertices.test(index);
+	}
+
+	/**
+	 * @brief Checks whether the edge with the given dense index was removed.
+	 */
+	bool edge_removed(size_t index) const
+	{
+		return removed_edges.test(index);
+	}
+
+	/**
+	 * @brief Returns the number of vertexes removed since the last compact().
+	 */
+	size_t removed_vertex_count() const
+	{
+		return removed_vertices.count();
+	}
+
+	/**
+	 * @brief Returns the number of edges removed since the last compact().
+	 */
+	size_t removed_edge_count() const
+	{
+		return removed_edges.count();
+	}
+
+	/**
+	 * @brief Drops removed vertexes and edges for good.
+	 * @note The columns are rewritten in place in parallel, one task per column, then the id indexes,
+	 * the adjacency indexes and the property indexes are rebuilt in parallel too.
+	 * @param pool The threads the columns and indexes are rewritten on.
+	 * @note Dense indices are renumbered in their current order, handles and iterators obtained before are invalidated.
+	 */
+	void compact(thread_pool& pool = default_thread_pool())
+	{
+		if (removed_vertices.empty() && removed_edges.empty()) {
+			return;
+		}
+		std::vector<size_t> vertex_rows = removed_vertices.live_indices(vertex_ids.size());
+		std::vector<size_t> edge_rows = removed_edges.live_indices(edge_ids.size());
+		std::vector<size_t> renumbered(vertex_ids.size(), 0);
+		for (size_t i = 0; i < vertex_rows.size(); ++i) {
+			renumbered[vertex_rows[i]] = i;
+		}
+
+		std::vector<std::function<void()>> tasks;
+		tasks.push_back([&] { column_retain(vertex_ids, vertex_rows); });
+		tasks.push_back([&] { column_retain(edge_ids, edge_rows); });
+		std::apply([&](auto&... columns) { (tasks.push_back([&] { column_retain(columns, vertex_rows); }), ...); }, vertex_properties);
+		std::apply([&](auto&... columns) { (tasks.push_back([&] { column_retain(columns, edge_rows); }), ...); }, edge_properties);
+		for (auto* endpoints : { &edge_src, &edge_dst }) {
+			tasks.push_back([&, endpoints] {
+				column_retain(*endpoints, edge_rows);
+				for (auto&& v : *endpoints) {
+					v = renumbered[v];
+				}
+			});
+		}
+		tasks.push_back([&] {
+			std::erase_if(insertion_order, [this](size_t v) { return removed_vertices.test(v); });
+			for (auto&& v : insertion_order) {
+				v = renumbered[v];
+			}
+		});
+		run_tasks(tasks, pool);
+		removed_vertices.clear();
+		removed_edges.clear();
+
+		tasks.clear();
+		tasks.push_back([this] { adjacency = build_adjacency(edge_src, edge_dst); });
+		if constexpr (has_reverse_index) {
+			tasks.push_back([this] { reverse_adjacency = build_adjacency(edge_dst, edge_src); });
+		}
+		tasks.push_back([this] { vertex_index = build_id_index<decltype(vertex_index)>(vertex_ids); });
+		tasks.push_back([this] { edge_index = build_id_index<decltype(edge_index)>(edge_ids); });
+		tasks.push_back([this] {
+			vertex_property_indexes = vertex_indexes_t();
+			index_rows(vertex_properties, vertex_property_indexes, 0, vertex_ids.size());
+		});
+		tasks.push_back([this] {
+			edge_property_indexes = edge_indexes_t();
+			index_rows(edge_properties, edge_property_indexes, 0, edge_ids.size());
+		});
+		run_tasks(tasks, pool);
+	}
+
+	/**
+	 * @brief Renumbers the vertexes in a cache-friendly order, so traversals touch nearby rows of the columns.
+	 * @param strategy How the new dense indices are assigned, vertex_order::insertion restores the insertion order.
+	 * @param pool The threads the order is computed and the columns and indexes are rewritten on.
+	 * @note Removed elements are dropped first as by compact(). Then every vertex column and the endpoints
+	 * of the edges are permuted in place in parallel, one task per column, and the id index, the adjacency
+	 * indexes and the vertex property indexes are rebuilt in parallel too. Edges keep their dense indices.
+	 * @note get_vertexes() keeps iterating in insertion order through a mapping array of 8 bytes per vertex,
+	 * which is dropped again by vertex_order::insertion.
+	 * @note Dense indices change, handles and iterators obtained before are invalidated.
+	 * @see vertex_permutation
+	 */
+	void reorder(vertex_order strategy, thread_pool& pool = default_thread_pool())
+	{
+		compact(pool);
+		size_t n = vertex_ids.size();
+		std::vector<size_t> order = strategy == vertex_order::insertion && !insertion_order.empty()
+			? std::move(insertion_order)
+			: vertex_permutation(strategy, n, edge_src, edge_dst, pool);
+		std::vector<size_t> renumbered(n);
+		bool identity = true;
+		for (size_t v = 0; v < n; ++v) {
+			renumbered[order[v]] = v;
+			identity = identity && order[v] == v;
+		}
+		if (identity) {
+			insertion_order.clear();
+			return;
+		}
+
+		std::vector<std::function<void()>> tasks;
+		tasks.push_back([&] { column_permute(vertex_ids, order); });
+		std::apply([&](auto&... columns) { (tasks.push_back([&] { column_permute(columns, order); }), ...); }, vertex_properties);
+		for (auto* endpoints : { &edge_src, &edge_dst }) {
+			tasks.push_back([&, endpoints] {
+				for (auto&& v : *endpoints) {
+					v = renumbered[v];
+				}
+			});
+		}
+		tasks.push_back([&] {
+			if (strategy == vertex_order::insertion) {
+				insertion_order.clear();
+			}
+			else if (insertion_order.empty()) {
+				insertion_order = renumbered;
+			}
+			else {
+				for (auto&& v : insertion_order) {
+					v = renumbered[v];
+				}
+			}
+		});
+		run_tasks(tasks, pool);
+
+		tasks.clear();
+		tasks.push_back([this] { adjacency = build_adjacency(edge_src, edge_dst); });
+		if constexpr (has_reverse_index) {
+			tasks.push_back([this] { reverse_adjacency = build_adjacency(edge_dst, edge_src); });
+		}
+		tasks.push_back([this] { vertex_index = build_id_index<decltype(vertex_index)>(vertex_ids); });
+		tasks.push_back([this] {
+			vertex_property_indexes = vertex_indexes_t();
+			index_rows(vertex_properties, vertex_property_indexes, 0, vertex_ids.size());
+		});
+		run_tasks(tasks, pool);
+	}
+
+	/**
+	 * @brief Returns the number of vertexes in the database.
+	 * @note Removed vertexes are counted until compact(), it is the size of the dense index space.
+	 */
+	size_t vertex_count() const
+	{
+		return vertex_ids.size();
+	}
+
+	/**
+	 * @brief Returns the number of edges in the database.
+	 * @note Removed edges are counted until compact(), it is the size of the dense index space.
+	 */
+	size_t edge_count() const
+	{
+		return edge_ids.size();
+	}
+
+	/**
+	 * @brief Returns the CSR index of forward edges, for algorithms working on dense indices.
+	 */
+	const adjacency_index& forward_index() const
+	{
+		return adjacency;
+	}
+
+	/**
+	 * @brief Returns the CSR index of incoming edges grouped by the destination vertex, for pull-style algorithms.
+	 */
+	const adjacency_index& backward_index() const
+		requires has_reverse_index
+	{
+		return reverse_adjacency;
+	}
+
+	/**
+	 * @brief Returns the dense index of the source vertex of the e-th edge.
+	 */
+	size_t source_of(size_t e) const
+	{
+		return edge_src[e];
+	}
+
+	/**
+	 * @brief Returns the dense index of the destination vertex of the e-th edge.
+	 */
+	size_t target_of(size_t e) const
+	{
+		return edge_dst[e];
+	}
+
+	/**
+	 * @brief Returns the column of the I-th vertex property, for algorithms working on dense indices.
+	 */
+	template<size_t I>
+	const auto& vertex_column() const
+	{
+		return std::get<I>(vertex_properties);
+	}
+
+	/**
+	 * @brief Returns the column of the I-th edge property, for algorithms working on dense indices.
+	 */
+	template<size_t I>
+	const auto& edge_column() const
+	{
+		return std::get<I>(edge_properties);
+	}
+
+	/**
+	 * @brief Sets the I-th property of every live vertex to values[index] by its dense index, as set_property<I> would.
+	 * @param values A random access range of at least vertex_count() values, those of removed vertexes are ignored.
+	 * @note Columns of plain values without a secondary index are written in parallel over default_thread_pool().
+	 */
+	template<size_t I, typename Values>
+	void set_vertex_column(const Values& values)
+	{
+		fill_property(std::get<I>(vertex_properties), std::get<I>(vertex_property_indexes), removed_vertices, values);
+		for (size_t i = removed_vertices.next_live(0); wal && i < vertex_ids.size(); i = removed_vertices.next_live(i + 1)) {
+			log_vertex_property<I>(i);
+		}
+	}
+
+	/**
+	 * @brief Sets the I-th property of every live edge to values[index] by its dense index, as set_property<I> would.
+	 * @param values A random access range of at least edge_count() values, those of removed edges are ignored.
+	 * @note Columns of plain values without a secondary index are written in parallel over default_thread_pool().
+	 */
+	template<size_t I, typename Values>
+	void set_edge_column(const Values& values)
+	{
+		fill_property(std::get<I>(edge_properties), std::get<I>(edge_property_indexes), removed_edges, values);
+		for (size_t i = removed_edges.next_live(0); wal && i < edge_ids.size(); i = removed_edges.next_live(i + 1)) {
+			log_edge_property<I>(i);
+		}
+	}
+
+	/**
+	 * @brief Preallocates storage of all vertex columns, the id index and the adjacency index.
+	 * @param n The total number of vertexes the database should hold without reallocation.
+	 */
+	void reserve_vertices(size_t n)
+	{
+		vertex_ids.reserve(n);
+		std::apply([n](auto&... columns) { (columns.reserve(n), ...); }, vertex_properties);
+		vertex_index.reserve(n);
+		adjacency.reserve(n, edge_ids.capacity());
+		if constexpr (has_reverse_index) {
+			reverse_adjacency.reserve(n, edge_ids.capacity());
+		}
+		report_vertex_capacity();
+	}
+
+	/**
+	 * @brief Preallocates storage of all edge columns, the id index and the adjacency index.
+	 * @param n The total number of edges the database should hold without reallocation.
+	 */
+	void reserve_edges(size_t n)
+	{
+		edge_ids.reserve(n);
+		std::apply([n](auto&... columns) { (columns.reserve(n), ...); }, edge_properties);
+		edge_src.reserve(n);
+		edge_dst.reserve(n);
+		edge_index.reserve(n);
+		adjacency.reserve(vertex_ids.capacity(), n);
+		if constexpr (has_reverse_index) {
+			reverse_adjacency.reserve(vertex_ids.capacity(), n);
+		}
+		report_edge_capacity();
+	}
+
+	/**
+	 * @brief Insert a batch of vertexes into the database.
+	 * @tparam Range A forward range of tuples (user id, all properties...).
+	 * @param rows The vertexes to insert, moved from when the range is an rvalue.
+	 * @return A ranges::subrange(begin(), end()) of the newly created vertexes.
+	 * @throws std::invalid_argument If any user id is a duplicate, the database is left unchanged then.
+	 * @note Each column is filled in one pass and the id and adjacency indexes are updated once at the end.
+	 */
+	template<std::ranges::forward_range Range>
+		requires (std::tuple_size_v<std::remove_cvref_t<std::ranges::range_value_t<Range>>>
+			== 1 + std::tuple_size_v<typename GraphSchema::vertex_property_t>)
+	std::ranges::subrange<vertex_it_t> add_vertices(Range&& rows)
+	{
+		size_t first = vertex_ids.size();
+		size_t count = static_cast<size_t>(std::ranges::distance(rows));
+		auto timer = instruments.time(graph_op::add_vertex, count);
+		reserve_vertices(first + count);
+
+		fill_column<Range, 0>(vertex_ids, rows);
+		[&]<size_t ...Is>(std::index_sequence<Is...>) {
+			(fill_column<Range, Is + 1>(std::get<Is>(vertex_properties), rows), ...);
+		}(std::make_index_sequence<std::tuple_size_v<vertex_properties_t>>{});
+
+		for (size_t i = first; i < vertex_ids.size(); ++i) {
+			if (vertex_index.try_insert(vertex_ids[i], i, vertex_ids) != vertex_index.npos) {
+				truncate_vertices(first, i);
+				throw std::invalid_argument("graph_db: duplicate vertex user id");
+			}
+		}
+		index_rows(vertex_properties, vertex_property_indexes, first, vertex_ids.size());
+		adjacency.add_vertices(count);
+		if constexpr (has_reverse_index) {
+			reverse_adjacency.add_vertices(count);
+		}
+		for (size_t i = first; !insertion_order.empty() && i < vertex_ids.size(); ++i) {
+			insertion_order.push_back(i);
+		}
+		for (size_t i = first; wal && i < vertex_ids.size(); ++i) {
+			log_vertex(wal_record::add_vertex, i);
+		}
+		report_vertex_capacity();
+		return { vertex_it_t(this, first), vertex_it_t(this, vertex_ids.size()) };
+	}
+
+	/**
+	 * @brief Insert a batch of directed edges into the database.
+	 * @tparam Range A forward range of tuples (user id, source vertex, destination vertex, all properties...).
+	 * @param rows The edges to insert, moved from when the range is an rvalue.
+	 * @return A ranges::subrange(begin(), end()) of the newly created edges.
+	 * @throws std::invalid_argument If any user id is a duplicate or an endpoint is removed, the database is left unchanged then.
+	 * @note Each column is filled in one pass and the id and adjacency indexes are updated once at the end.
+	 */
+	template<std::ranges::forward_range Range>
+		requires (std::tuple_size_v<std::remove_cvref_t<std::ranges::range_value_t<Range>>>
+			== 3 + std::tuple_size_v<typename GraphSchema::edge_property_t>)
+	std::ranges::subrange<edge_it_t> add_edges(Range&& rows)
+	{
+		size_t first = edge_ids.size();
+		size_t count = static_cast<size_t>(std::ranges::distance(rows));
+		auto timer = instruments.time(graph_op::add_edge, count);
+		for (auto&& row : rows) {
+			check_endpoints(std::get<1>(row), std::get<2>(row));
+		}
+		reserve_edges(first + count);
+
+		fill_column<Range, 0>(edge_ids, rows);
+		for (auto&& row : rows) {
+			edge_src.push_back(std::get<1>(row).get_index());
+			edge_dst.push_back(std::get<2>(row).get_index());
+		}
+		[&]<size_t ...Is>(std::index_sequence<Is...>) {
+			(fill_column<Range, Is + 3>(std::get<Is>(edge_properties), rows), ...);
+		}(std::make_index_sequence<std::tuple_size_v<edge_properties_t>>{});
+
+		for (size_t i = first; i < edge_ids.size(); ++i) {
+			if (edge_index.try_insert(edge_ids[i], i, edge_ids) != edge_index.npos) {
+				truncate_edges(first, i);
+				throw std::invalid_argument("graph_db: duplicate edge user id");
+			}
+		}
+		index_rows(edge_properties, edge_property_indexes, first, edge_ids.size());
+		for (size_t i = first; i < edge_ids.size(); ++i) {
+			adjacency.add_edge(edge_src[i], i, edge_dst[i]);
+		}
+		adjacency.merge();
+		if constexpr (has_reverse_index) {
+			for (size_t i = first; i < edge_ids.size(); ++i) {
+				reverse_adjacency.add_edge(edge_dst[i], i, edge_src[i]);
+			}
+			reverse_adjacency.merge();
+		}
+		for (size_t i = first; wal && i < edge_ids.size(); ++i) {
+			log_edge(wal_record::add_edge, i);
+		}
+		report_edge_capacity();
+		return { edge_it_t(this, first), edge_it_t(this, edge_ids.size()) };
+	}
+
+	/**
+	 * @brief Finds a vertex by its user id.
+	 * @param vuid The user id of the vertex.
+	 * @return The vertex or std::nullopt if there is no such vertex.
+	 * @note Expected O(1) thanks to the hash index of user ids.
+	 */
+	std::optional<vertex_t> find_vertex(const typename GraphSchema::vertex_user_id_t& vuid)
+	{
+		size_t index = find_vertex_index(vuid);
+		return index == vertex_index.npos ? std::nullopt : std::optional<vertex_t>(make_vertex(index));
+	}
+	std::optional<const_vertex_t> find_vertex(const typename GraphSchema::vertex_user_id_t& vuid) const
+	{
+		size_t index = find_vertex_index(vuid);
+		return index == vertex_index.npos ? std::nullopt : std::optional<const_vertex_t>(make_vertex(index));
+	}
+
+	/**
+	 * @brief Finds an edge by its user id.
+	 * @param euid The user id of the edge.
+	 * @return The edge or std::nullopt if there is no such edge.
+	 * @note Expected O(1) thanks to the hash index of user ids.
+	 */
+	std::optional<edge_t> find_edge(const typename GraphSchema::edge_user_id_t& euid)
+	{
+		size_t index = find_edge_index(euid);
+		return index == edge_index.npos ? std::nullopt : std::optional<edge_t>(make_edge(index));
+	}
+	std::optional<const_edge_t> find_edge(const typename GraphSchema::edge_user_id_t& euid) const
+	{
+		size_t index = find_edge_index(euid);
+		return index == edge_index.npos ? std::nullopt : std::optional<const_edge_t>(make_edge(index));
+	}
+	/**
+	 * @brief Finds the vertexes both v1 and v2 have a forward edge to.
+	 * @return The common destinations ordered by their dense index, each one once.
+	 * @note With schema_sorted_adjacency the stored destination lists are intersected directly by simd_intersect
+	 * in O(d1 + d2), otherwise they are gathered and sorted first. Removed edges are not followed.
+	 */
+	std::vector<vertex_t> common_neighbors(const const_vertex_t& v1, const const_vertex_t& v2)
+	{
+		return handles_of<vertex_t>(this, common_destinations(v1, v2));
+	}
+	std::vector<const_vertex_t> common_neighbors(const const_vertex_t& v1, const const_vertex_t& v2) const
+	{
+		return handles_of<const_vertex_t>(this, common_destinations(v1, v2));
+	}
+
+	/**
+	 * @brief Returns a snapshot of the operation statistics recorded so far.
+	 * @return Calls, elements and latency histograms per graph_op, and the growth events of the columns.
+	 * @note Available only if the schema enables schema_instrumented. graph_stats::write_prometheus exports it.
+	 * @note Neighbor scans and traversals are timed up to the range being handed out, which includes merging
+	 * pending adjacency updates, the elements of the range count as their items.
+	 */
+	graph_stats stats() const
+		requires has_instrumentation
+	{
+		return instruments.snapshot();
+	}
+
+	/**
+	 * @brief Clears the statistics returned by stats(), the reported column capacities are kept.
+	 */
+	void reset_stats()
+		requires has_instrumentation
+	{
+		instruments.reset();
+	}
+
+	/**
+	 * @brief Selects vertexes by a predicate over some of their properties, evaluated in parallel.
+	 * @tparam Is Indices of the properties the predicate reads.
+	 * @param pred A predicate called as pred(get_property<Is>()...) for every vertex.
+	 * @return The bitmap of dense indices of the matching vertexes.
+	 * @note Only the columns Is... are read, in cache sized chunks spread over default_thread_pool().
+	 */
+	template<size_t ...Is, typename Predicate>
+	selection_bitmap scan_vertices(const Predicate& pred) const
+	{
+		return live(scan_columns(vertex_ids.size(), pred, std::get<Is>(vertex_properties)...), removed_vertices);
+	}
+
+	/**
+	 * @brief Selects edges by a predicate over some of their properties, evaluated in parallel.
+	 * @tparam Is Indices of the properties the predicate reads.
+	 * @param pred A predicate called as pred(get_property<Is>()...) for every edge.
+	 * @return The bitmap of dense indices of the matching edges.
+	 * @note Only the columns Is... are read, in cache sized chunks spread over default_thread_pool().
+	 */
+	template<size_t ...Is, typename Predicate>
+	selection_bitmap scan_edges(const Predicate& pred) const
+	{
+		return live(scan_columns(edge_ids.size(), pred, std::get<Is>(edge_properties)...), removed_edges);
+	}
+
+	/**
+	 * @brief Selects vertexes whose I-th property compares with a constant, using SIMD kernels.
+	 * @tparam I An index of an int, float or double property stored contiguously.
+	 * @return The bitmap of dense indices of the matching vertexes.
+	 * @see simd_compare
+	 */
+	template<size_t I, typename V>
+	selection_bitmap filter_vertices(compare_op op, const V& value) const
+	{
+		return live(filter_column(std::get<I>(vertex_properties), op, value), removed_vertices);
+	}
+
+	/**
+	 * @brief Selects vertexes whose I-th property lies in [lo, hi], using SIMD kernels.
+	 * @see filter_vertices
+	 */
+	template<size_t I, typename V>
+	selection_bitmap filter_vertices_between(const V& lo, const V& hi) const
+	{
+		return live(filter_column_range(std::get<I>(vertex_properties), lo, hi), removed_vertices);
+	}
+
+	/**
+	 * @brief Computes min, max, sum and count of the I-th vertex property, using SIMD kernels.
+	 * @see filter_vertices
+	 */
+	template<size_t I>
+	auto aggregate_vertices() const
+	{
+		return aggregate_column(std::get<I>(vertex_properties), removed_vertices);
+	}
+
+	/**
+	 * @brief Selects edges whose I-th property compares with a constant, using SIMD kernels.
+	 * @tparam I An index of an int, float or double property stored contiguously.
+	 * @return The bitmap of dense indices of the matching edges.
+	 * @see simd_compare
+	 */
+	template<size_t I, typename V>
+	selection_bitmap filter_edges(compare_op op, const V& value) const
+	{
+		return live(filter_column(std::get<I>(edge_properties), op, value), removed_edges);
+	}
+
+	/**
+	 * @brief Selects edges whose I-th property lies in [lo, hi], using SIMD kernels.
+	 * @see filter_edges
+	 */
+	template<size_t I, typename V>
+	selection_bitmap filter_edges_between(const V& lo, const V& hi) const
+	{
+		return live(filter_column_range(std::get<I>(edge_properties), lo, hi), removed_edges);
+	}
+
+	/**
+	 * @brief Computes min, max, sum and count of the I-th edge property, using SIMD kernels.
+	 * @see filter_edges
+	 */
+	template<size_t I>
+	auto aggregate_edges() const
+	{
+		return aggregate_column(std::get<I>(edge_properties), removed_edges);
+	}
+
+	/**
+	 * @brief Finds the vertexes whose I-th property equals the value through a secondary index.
+	 * @tparam I An index of a property listed in vertex_hash_indexes or vertex_sorted_indexes of the schema.
+	 * @return Dense indices of the matching vertexes, valid until the next modification of the database.
+	 * @note Expected O(1) with a hash index, O(log n) with a sorted one.
+	 * @see schema_property_indexes
+	 */
+	template<size_t I, typename V>
+	std::span<const size_t> lookup_vertices(const V& value) const
+	{
+		return std::get<I>(vertex_property_indexes).find(std::get<I>(vertex_properties), value);
+	}
+
+	/**
+	 * @brief Finds the vertexes whose I-th property lies in [lo, hi] through a sorted secondary index.
+	 * @tparam I An index of a property listed in vertex_sorted_indexes of the schema.
+	 * @return Dense indices of the matching vertexes ordered by the property, valid until the next modification of the database.
+	 * @note O(log n) plus merging the rows inserted or updated since the previous lookup.
+	 */
+	template<size_t I, typename V>
+	std::span<const size_t> lookup_vertices_between(const V& lo, const V& hi) const
+	{
+		return std::get<I>(vertex_property_indexes).find_between(std::get<I>(vertex_properties), lo, hi);
+	}
+
+	/**
+	 * @brief Finds the edges whose I-th property equals the value through a secondary index.
+	 * @see lookup_vertices
+	 */
+	template<size_t I, typename V>
+	std::span<const size_t> lookup_edges(const V& value) const
+	{
+		return std::get<I>(edge_property_indexes).find(std::get<I>(edge_properties), value);
+	}
+
+	/**
+	 * @brief Finds the edges whose I-th property lies in [lo, hi] through a sorted secondary index.
+	 * @see lookup_vertices_between
+	 */
+	template<size_t I, typename V>
+	std::span<const size_t> lookup_edges_between(const V& lo, const V& hi) const
+	{
+		return std::get<I>(edge_property_indexes).find_between(std::get<I>(edge_properties), lo, hi);
+	}
+
+	/**
+	 * @brief Merges pending updates into the sorted property indexes, which otherwise happens on the next range lookup.
+	 */
+	void merge_property_indexes() const
+	{
+		merge_indexes(vertex_properties, vertex_property_indexes);
+		merge_indexes(edge_properties, edge_property_indexes);
+	}
+
+	/**
+	 * @brief Writes the whole database into a binary snapshot file.
+	 * @param path The path of the snapshot file, it is overwritten.
+	 * @throws std::runtime_error If the file cannot be written.
+	 * @see snapshot_format
+	 * @note If some elements were removed, a compacted copy of the database is written.
+	 * @note Vertexes are written in their current order, together with the insertion order left by reorder().
+	 * @note The sequence number of the last logged mutation is stored too, see open_log().
+	 */
+	void save(const std::string& path) const
+	{
+		if (!removed_vertices.empty() || !removed_edges.empty()) {
+			graph_db copy(*this);
+			copy.compact();
+			copy.save(path);
+			return;
+		}
+		snapshot_writer writer(path);
+		writer.write_header(vertex_ids.size(), edge_ids.size(),
+			std::tuple_size_v<vertex_properties_t>, std::tuple_size_v<edge_properties_t>,
+			insertion_order.empty() ? 0 : snapshot_format::insertion_order, log_sequence);
+		writer.write_column(vertex_ids);
+		writer.write_column(edge_ids);
+		std::apply([&writer](const auto&... columns) { (writer.write_column(columns), ...); }, vertex_properties);
+		std::apply([&writer](const auto&... columns) { (writer.write_column(columns), ...); }, edge_properties);
+		writer.write_column(edge_src);
+		writer.write_column(edge_dst);
+		writer.write_column(adjacency.offsets_array());
+		writer.write_column(adjacency.targets_array());
+		if (!insertion_order.empty()) {
+			writer.write_column(insertion_order);
+		}
+		writer.finish();
+	}
+
+	/**
+	 * @brief Loads a database from a snapshot file written by save().
+	 * @param path The path of the snapshot file.
+	 * @param alloc The allocator of the columns of the loaded database.
+	 * @return The loaded database.
+	 * @throws std::runtime_error If the file is missing, corrupted or was written with a different schema.
+	 * @note The file is memory mapped. Property columns of a schema column_t of mapped_column_t stay views of
+	 * the mapping until they are modified, so processes loading the same snapshot share those pages. The other
+	 * fixed-size columns are bulk-copied out of the mapping, the adjacency index is taken over as is after it is
+	 * validated against the endpoints, and only the id indexes and the reverse index are rebuilt.
+	 * @see mapped_column
+	 */
+	static graph_db open_mmap(const std::string& path, const allocator_type& alloc = allocator_type())
+	{
+		snapshot_reader reader(path);
+		const auto& header = reader.read_header(std::tuple_size_v<vertex_properties_t>, std::tuple_size_v<edge_properties_t>);
+		uint64_t vertex_count = header.vertex_count;
+		uint64_t edge_count = header.edge_count;
+
+		graph_db db(alloc);
+		db.log_sequence = header.log_sequence;
+		reader.read_column(db.vertex_ids, vertex_count);
+		reader.read_column(db.edge_ids, edge_count);
+		std::apply([&](auto&... columns) { (reader.read_column(columns, vertex_count), ...); }, db.vertex_properties);
+		std::apply([&](auto&... columns) { (reader.read_column(columns, edge_count), ...); }, db.edge_properties);
+		reader.read_column(db.edge_src, edge_count);
+		reader.read_column(db.edge_dst, edge_count);
+		std::vector<size_t> offsets;
+		std::vector<size_t> targets;
+		reader.read_column(offsets, vertex_count + 1);
+		reader.read_column(targets, edge_count);
+		for (size_t e = 0; e < edge_count; ++e) {
+			if (db.edge_src[e] >= vertex_count || db.edge_dst[e] >= vertex_count) {
+				throw std::runtime_error("snapshot: corrupted edge endpoints");
+			}
+		}
+		if (header.flags & snapshot_format::insertion_order) {
+			reader.read_column(db.insertion_order, vertex_count);
+			std::vector<bool> seen(db.insertion_order.size(), false);
+			for (size_t v : db.insertion_order) {
+				if (v >= seen.size() || seen[v]) {
+					throw std::runtime_error("snapshot: corrupted insertion order");
+				}
+				seen[v] = true;
+			}
+		}
+		if constexpr (has_sorted_adjacency) {
+			// The file may come from a schema without sorting, the order is established anew.
+			db.adjacency = db.build_adjacency(db.edge_src, db.edge_dst);
+		}
+		else {
+			// Every edge must be listed exactly once, among the edges of its source vertex.
+			std::vector<bool> listed(edge_count, false);
+			if (offsets[0] != 0 || offsets[vertex_count] != edge_count) {
+				throw std::runtime_error("snapshot: corrupted adjacency index");
+			}
+			for (size_t v = 0; v < vertex_count; ++v) {
+				if (offsets[v] > offsets[v + 1]) {
+					throw std::runtime_error("snapshot: corrupted adjacency index");
+				}
+				for (size_t i = offsets[v]; i < offsets[v + 1]; ++i) {
+					size_t e = targets[i];
+					if (e >= edge_count || listed[e] || db.edge_src[e] != v) {
+						throw std::runtime_error("snapshot: corrupted adjacency index");
+					}
+					listed[e] = true;
+				}
+			}
+			db.adjacency.assign(std::move(offsets), std::move(targets));
+		}
+		if constexpr (has_reverse_index) {
+			db.reverse_adjacency = db.build_adjacency(db.edge_dst, db.edge_src);
+		}
+
+		index_rows(db.vertex_properties, db.vertex_property_indexes, 0, db.vertex_ids.size());
+		index_rows(db.edge_properties, db.edge_property_indexes, 0, db.edge_ids.size());
+
+		db.vertex_index.reserve(db.vertex_ids.size());
+		for (size_t i = 0; i < db.vertex_ids.size(); ++i) {
+			if (db.vertex_index.try_insert(db.vertex_ids[i], i, db.vertex_ids) != db.vertex_index.npos) {
+				throw std::runtime_error("snapshot: duplicate vertex user id");
+			}
+		}
+		db.edge_index.reserve(db.edge_ids.size());
+		for (size_t i = 0; i < db.edge_ids.size(); ++i) {
+			if (db.edge_index.try_insert(db.edge_ids[i], i, db.edge_ids) != db.edge_index.npos) {
+				throw std::runtime_error("snapshot: duplicate edge user id");
+			}
+		}
+		return db;
+	}
+
+	/**
+	 * @brief Replays a write-ahead log on top of the database and logs all further mutations into it.
+	 * @param path The log file, created if missing.
+	 * @param options How the records are committed.
+	 * @param pool The threads the log is verified and decoded on.
+	 * @throws std::runtime_error If the log is corrupted, was written with a different schema or starts after
+	 * the last mutation the database holds, i.e. belongs to a newer snapshot.
+	 * @note Records the database holds already, by the sequence number saved with its snapshot, are skipped
+	 * and a torn tail left by a crash is cut off.
+	 * @note The frames are verified and decoded in parallel, several MiB at a time. Every run of records
+	 * of one kind is applied at once, vertexes and edges through add_vertices() and add_edges(),
+	 * the other records after looking up their elements in parallel.
+	 * @note Mutations are logged once they succeed. compact() and reorder() leave the contents as they are
+	 * and are not logged. Copies do not log, assigning another database to this one closes the log.
+	 * @see write_ahead_log
+	 */
+	void open_log(const std::string& path, const wal_options& options = wal_options(), thread_pool& pool = default_thread_pool())
+	{
+		if (wal) {
+			throw std::runtime_error("graph_db: a log is open already");
+		}
+		uint64_t schema = wal_schema_fingerprint<GraphSchema>();
+		uint64_t valid_length = 0;
+		if (wal_reader::exists(path)) {
+			wal_reader reader(path, schema, pool);
+			if (reader.base_sequence() > log_sequence) {
+				throw std::runtime_error("wal: the log starts after the last mutation the database holds");
+			}
+			replay(reader, pool);
+			// A log behind a newer snapshot has nothing to add and starts over.
+			if (reader.last_sequence() == log_sequence) {
+				valid_length = reader.valid_length();
+			}
+		}
+		wal = std::make_unique<write_ahead_log>(path, schema, options, log_sequence, valid_length);
+	}
+
+	/**
+	 * @brief Commits the records of all mutations so far, without waiting for the next group commit.
+	 * @return The sequence number of the last mutation.
+	 */
+	uint64_t sync_log()
+	{
+		return wal ? wal->sync() : log_sequence;
+	}
+
+	/**
+	 * @brief Commits the pending records and stops logging.
+	 */
+	void close_log()
+	{
+		wal.reset();
+	}
+
+	/**
+	 * @brief Returns the sequence number of the last mutation logged or replayed.
+	 */
+	uint64_t log_position() const
+	{
+		return log_sequence;
+	}
+
+	/**
+	 * @brief Writes a snapshot which holds all logged mutations, then empties the log.
+	 * @param path The snapshot file. It is replaced atomically, by a synced file written next to it and renamed.
+	 * @note The log goes on with the following sequence numbers. After a crash at any point, open_mmap() of
+	 * the snapshot and open_log() recover all committed mutations.
+	 */
+	void checkpoint(const std::string& path)
+	{
+		sync_log();
+		std::string temporary = path + ".tmp";
+		save(temporary);
+		wal_sync_path(temporary);
+		std::filesystem::rename(temporary, path);
+		wal_sync_path(path, true);
+		if (wal) {
+			wal->reset(log_sequence);
+		}
+	}
+private:
+	template<class, bool>
+	friend class vertex;
+	template<class, bool>
+	friend class edge;
+
+	/**
+	 * @brief Makes all dictionary-encoded columns intern into the pool of the first one.
+	 */
+	void share_string_pool()
+	{
+		std::shared_ptr<string_pool> pool;
+		auto attach = [&pool](auto& column) {
+			if constexpr (std::is_same_v<std::remove_cvref_t<decltype(column)>, dictionary_column>) {
+				if (pool) {
+					column.share_pool(pool);
+				}
+				else {
+					pool = column.pool();
+				}
+			}
+		};
+		attach(vertex_ids);
+		attach(edge_ids);
+		std::apply([&attach](auto&... columns) { (attach(columns), ...); }, vertex_properties);
+		std::apply([&attach](auto&... columns) { (attach(columns), ...); }, edge_properties);
+	}
+
+	/**
+	 * @brief Replaces the string pool shared by the dictionary-encoded columns with a private copy.
+	 */
+	void clone_string_pool()
+	{
+		std::shared_ptr<string_pool> clone;
+		auto detach = [&clone](auto& column) {
+			if constexpr (std::is_same_v<std::remove_cvref_t<decltype(column)>, dictionary_column>) {
+				if (!clone) {
+					clone = std::make_shared<string_pool>(*column.pool());
+				}
+				column.rebind_pool(clone);
+			}
+		};
+		detach(vertex_ids);
+		detach(edge_ids);
+		std::apply([&detach](auto&... columns) { (detach(columns), ...); }, vertex_properties);
+		std::apply([&detach](auto&... columns) { (detach(columns), ...); }, edge_properties);
+	}
+
+	template<typename Column>
+	static Column make_column(const allocator_type& alloc)
+	{
+		if constexpr (std::uses_allocator_v<Column, allocator_type>) {
+			return Column(alloc);
+		}
+		else {
+			return Column();
+		}
+	}
+
+	template<typename Columns>
+	static Columns make_columns(const allocator_type& alloc)
+	{
+		return [&]<size_t ...Is>(std::index_sequence<Is...>) {
+			return Columns(make_column<std::tuple_element_t<Is, Columns>>(alloc)...);
+		}(std::make_index_sequence<std::tuple_size_v<Columns>>{});
+	}
+
+	template<typename Columns, typename ...Props>
+	static void push_columns(Columns& columns, Props &&...props)
+	{
+		[&]<size_t ...Is>(std::index_sequence<Is...>) {
+			auto values = std::forward_as_tuple(std::forward<Props>(props)...);
+			(std::get<Is>(columns).emplace_back(std::get<Is>(std::move(values))), ...);
+		}(std::index_sequence_for<Props...>{});
+	}
+
+	/**
+	 * @brief Appends the I-th element of every row to the column, moving it out of an rvalue range.
+	 */
+	template<typename Range, size_t I, typename Column, typename Rows>
+	static void fill_column(Column& column, Rows& rows)
+	{
+		for (auto&& row : rows) {
+			if constexpr (std::is_lvalue_reference_v<Range>) {
+				column.emplace_back(std::get<I>(std::as_const(row)));
+			}
+			else {
+				column.emplace_back(std::get<I>(std::move(row)));
+			}
+		}
+	}
+
+	/**
+	 * @brief Adds the rows [first, last) to the secondary indexes of the properties which have one.
+	 */
+	template<typename Columns, typename Indexes>
+	static void index_rows(const Columns& columns, Indexes& indexes, size_t first, size_t last)
+	{
+		[&]<size_t ...Is>(std::index_sequence<Is...>) {
+			([&] {
+				if constexpr (std::tuple_element_t<Is, Indexes>::enabled) {
+					for (size_t i = first; i < last; ++i) {
+						std::get<Is>(indexes).insert(std::get<Is>(columns), i);
+					}
+				}
+			}(), ...);
+		}(std::make_index_sequence<std::tuple_size_v<Columns>>{});
+	}
+
+	/**
+	 * @brief Removes the row from the secondary indexes of the properties which have one.
+	 */
+	template<typename Columns, typename Indexes>
+	static void unindex_row(const Columns& columns, Indexes& indexes, size_t index)
+	{
+		[&]<size_t ...Is>(std::index_sequence<Is...>) {
+			(std::get<Is>(indexes).remove(std::get<Is>(columns), index), ...);
+		}(std::make_index_sequence<std::tuple_size_v<Columns>>{});
+	}
+
+	template<typename Columns, typename Indexes>
+	static void merge_indexes(const Columns& columns, const Indexes& indexes)
+	{
+		[&]<size_t ...Is>(std::index_sequence<Is...>) {
+			(std::get<Is>(indexes).merge(std::get<Is>(columns)), ...);
+		}(std::make_index_sequence<std::tuple_size_v<Columns>>{});
+	}
+
+	void check_endpoints(const const_vertex_t& v1, const const_vertex_t& v2) const
+	{
+		if (removed_vertices.test(v1.get_index()) || removed_vertices.test(v2.get_index())) {
+			throw std::invalid_argument("graph_db: edge endpoint is removed");
+		}
+	}
+
+	void bury_edge(size_t index)
+	{
+		edge_index.erase(edge_ids[index], index);
+		unindex_row(edge_properties, edge_property_indexes, index);
+		removed_edges.set(index);
+	}
+
+	template<typename Column, typename Index, typename Values>
+	static void fill_property(Column& column, Index& index, const tombstone_bitmap& removed, const Values& values)
+	{
+		using value_t = std::remove_cvref_t<decltype(column_get(column, 0))>;
+		// Distinct rows of a column handing out references never share memory, except bits of std::vector<bool>.
+		constexpr bool disjoint = std::is_lvalue_reference_v<decltype(column_get(column, 0))> && !std::is_same_v<value_t, bool>;
+		size_t n = column.size();
+		if constexpr (disjoint && !Index::enabled) {
+			default_thread_pool().parallel_for(0, n, size_t(1) << 14, [&](size_t b, size_t e) {
+				for (size_t i = removed.next_live(b); i < e; i = removed.next_live(i + 1)) {
+					column_get(column, i) = values[i];
+				}
+			});
+		}
+		else {
+			for (size_t i = removed.next_live(0); i < n; i = removed.next_live(i + 1)) {
+				index.erase(column, i);
+				column_set(column, i, values[i]);
+				index.insert(column, i);
+			}
+		}
+	}
+
+	static selection_bitmap live(selection_bitmap selection, const tombstone_bitmap& removed)
+	{
+		removed.exclude(selection);
+		return selection;
+	}
+
+	static void run_tasks(const std::vector<std::function<void()>>& tasks, thread_pool& pool)
+	{
+		pool.parallel_for(0, tasks.size(), 1, [&tasks](size_t b, size_t e) {
+			for (size_t i = b; i < e; ++i) {
+				tasks[i]();
+			}
+		});
+	}
+
+	/**
+	 * @brief Returns the distinct destinations of the live forward edges of the vertex v in increasing order.
+	 * @param scratch Holds the result unless it is the stored list of a sorted adjacency index.
+	 * @note Parallel edges repeat a key of the stored list, such lists are copied without the repeats.
+	 */
+	std::span<const size_t> sorted_destinations(size_t v, std::vector<size_t>& scratch) const
+	{
+		if constexpr (has_sorted_adjacency) {
+			std::span<const size_t> keys = adjacency.neighbor_keys(v);
+			if (removed_edges.empty() && std::adjacent_find(keys.begin(), keys.end()) == keys.end()) {
+				return keys;
+			}
+		}
+		scratch.clear();
+		for (size_t e : adjacency.neighbors(v)) {
+			if (!removed_edges.test(e)) {
+				scratch.push_back(edge_dst[e]);
+			}
+		}
+		if constexpr (!has_sorted_adjacency) {
+			std::sort(scratch.begin(), scratch.end());
+		}
+		scratch.erase(std::unique(scratch.begin(), scratch.end()), scratch.end());
+		return scratch;
+	}
+
+	adjacency_index build_adjacency(const schema_vector_t<GraphSchema, size_t>& sources,
+		const schema_vector_t<GraphSchema, size_t>& others) const
+	{
+		adjacency_index index(has_sorted_adjacency);
+		index.add_vertices(vertex_ids.size());
+		index.reserve(vertex_ids.size(), sources.size());
+		for (size_t e = 0; e < sources.size(); ++e) {
+			index.add_edge(sources[e], e, others[e]);
+		}
+		index.merge();
+		return index;
+	}
+
+	template<typename Index, typename Ids>
+	static Index build_id_index(const Ids& ids)
+	{
+		Index index;
+		index.reserve(ids.size());
+		for (size_t i = 0; i < ids.size(); ++i) {
+			index.try_insert(ids[i], i, ids);
+		}
+		return index;
+	}
+
+	/**
+	 * @brief Rolls back a failed add_vertices(), whose rows [n, indexed) made it into the id index.
+	 * @note Only the keys of the batch are erased, so removed vertexes stay out of the index.
+	 */
+	void truncate_vertices(size_t n, size_t indexed)
+	{
+		for (size_t i = n; i < indexed; ++i) {
+			vertex_index.erase(vertex_ids[i], i);
+		}
+		vertex_ids.resize(n);
+		std::apply([n](auto&... columns) { (columns.resize(n), ...); }, vertex_properties);
+	}
+
+	/**
+	 * @brief Rolls back a failed add_edges(), whose rows [n, indexed) made it into the id index.
+	 */
+	void truncate_edges(size_t n, size_t indexed)
+	{
+		for (size_t i = n; i < indexed; ++i) {
+			edge_index.erase(edge_ids[i], i);
+		}
+		edge_ids.resize(n);
+		std::apply([n](auto&... columns) { (columns.resize(n), ...); }, edge_properties);
+		edge_src.resize(n);
+		edge_dst.resize(n);
+	}
+
+	template<typename Tuple, typename Columns>
+	static Tuple gather_row(const Columns& columns, size_t index)
+	{
+		return std::apply([index](const auto&... column) { return Tuple(column_get(column, index)...); }, columns);
+	}
+
+	void push_vertex_id(typename GraphSchema::vertex_user_id_t&& vuid)
+	{
+		if (vertex_index.try_insert(vuid, vertex_ids.size(), vertex_ids) != vertex_index.npos) {
+			throw std::invalid_argument("graph_db: duplicate vertex user id");
+		}
+		vertex_ids.push_back(std::move(vuid));
+	}
+
+	void push_edge_id(typename GraphSchema::edge_user_id_t&& euid)
+	{
+		if (edge_index.try_insert(euid, edge_ids.size(), edge_ids) != edge_index.npos) {
+			throw std::invalid_argument("graph_db: duplicate edge user id");
+		}
+		edge_ids.push_back(std::move(euid));
+	}
+
+	vertex_t finish_vertex()
+	{
+		index_rows(vertex_properties, vertex_property_indexes, vertex_ids.size() - 1, vertex_ids.size());
+		adjacency.add_vertex();
+		if constexpr (has_reverse_index) {
+			reverse_adjacency.add_vertex();
+		}
+		if (!insertion_order.empty()) {
+			insertion_order.push_back(vertex_ids.size() - 1);
+		}
+		log_vertex(wal_record::add_vertex, vertex_ids.size() - 1);
+		report_vertex_capacity();
+		return make_vertex(vertex_ids.size() - 1);
+	}
+
+	edge_t finish_edge(const const_vertex_t& v1, const const_vertex_t& v2)
+	{
+		edge_src.push_back(v1.get_index());
+		edge_dst.push_back(v2.get_index());
+		index_rows(edge_properties, edge_property_indexes, edge_ids.size() - 1, edge_ids.size());
+		adjacency.add_edge(v1.get_index(), edge_ids.size() - 1, v2.get_index());
+		if constexpr (has_reverse_index) {
+			reverse_adjacency.add_edge(v2.get_index(), edge_ids.size() - 1, v1.get_index());
+		}
+		log_edge(wal_record::add_edge, edge_ids.size() - 1);
+		report_edge_capacity();
+		return make_edge(edge_ids.size() - 1);
+	}
+
+	/**
+	 * @brief Logs a mutation of the vertex with the given dense index, if a log is open.
+	 * @note Records of added vertexes and of set_properties carry all the properties, as the columns hold them.
+	 */
+	void log_vertex(wal_record kind, size_t index)
+	{
+		if (!wal) {
+			return;
+		}
+		log_sequence = wal->append([&](wal_encoder& out) {
+			out.put_byte(static_cast<uint8_t>(kind));
+			out.put<typename GraphSchema::vertex_user_id_t>(vertex_id(index));
+			if (kind != wal_record::remove_vertex) {
+				encode_row<typename GraphSchema::vertex_property_t>(out, vertex_properties, index);
+			}
+		});
+	}
+
+	void log_edge(wal_record kind, size_t index)
+	{
+		if (!wal) {
+			return;
+		}
+		log_sequence = wal->append([&](wal_encoder& out) {
+			out.put_byte(static_cast<uint8_t>(kind));
+			out.put<typename GraphSchema::edge_user_id_t>(edge_id(index));
+			if (kind == wal_record::add_edge) {
+				out.put<typename GraphSchema::vertex_user_id_t>(vertex_id(edge_src[index]));
+				out.put<typename GraphSchema::vertex_user_id_t>(vertex_id(edge_dst[index]));
+			}
+			if (kind != wal_record::remove_edge) {
+				encode_row<typename GraphSchema::edge_property_t>(out, edge_properties, index);
+			}
+		});
+	}
+
+	template<size_t I>
+	void log_vertex_property(size_t index)
+	{
+		if (!wal) {
+			return;
+		}
+		log_sequence = wal->append([&](wal_encoder& out) {
+			out.put_byte(static_cast<uint8_t>(wal_record::set_vertex_property));
+			out.put<typename GraphSchema::vertex_user_id_t>(vertex_id(index));
+			out.put_varint(I);
+			out.put<std::tuple_element_t<I, typename GraphSchema::vertex_property_t>>(get_vertex_property<I>(index));
+		});
+	}
+
+	template<size_t I>
+	void log_edge_property(size_t index)
+	{
+		if (!wal) {
+			return;
+		}
+		log_sequence = wal->append([&](wal_encoder& out) {
+			out.put_byte(static_cast<uint8_t>(wal_record::set_edge_property));
+			out.put<typename GraphSchema::edge_user_id_t>(edge_id(index));
+			out.put_varint(I);
+			out.put<std::tuple_element_t<I, typename GraphSchema::edge_property_t>>(get_edge_property<I>(index));
+		});
+	}
+
+	template<typename Tuple, typename Columns>
+	static void encode_row(wal_encoder& out, const Columns& columns, size_t index)
+	{
+		[&]<size_t ...Is>(std::index_sequence<Is...>) {
+			(out.put<std::tuple_element_t<Is, Tuple>>(column_get(std::get<Is>(columns), index)), ...);
+		}(std::make_index_sequence<std::tuple_size_v<Tuple>>{});
+	}
+
+	/**
+	 * @brief Applies the records of a log behind log_sequence, see open_log().
+	 */
+	void replay(const wal_reader& reader, thread_pool& pool)
+	{
+		constexpr size_t window_bytes = size_t(8) << 20;
+
+		const std::vector<wal_frame>& frames = reader.frames();
+		for (size_t first = 0; first < frames.size();) {
+			size_t last = first;
+			for (size_t bytes = 0; last < frames.size() && bytes < window_bytes; ++last) {
+				bytes += frames[last].payload_size;
+			}
+			std::vector<std::vector<wal_entry<GraphSchema>>> decoded(last - first);
+			pool.parallel_for(first, last, 1, [&](size_t b, size_t e) {
+				for (size_t f = b; f < e; ++f) {
+					wal_decoder in = reader.records(frames[f]);
+					for (uint64_t sequence = frames[f].first_sequence; sequence <= frames[f].last_sequence(); ++sequence) {
+						wal_entry<GraphSchema> entry = decode_wal_entry<GraphSchema>(in);
+						if (sequence > log_sequence) {
+							decoded[f - first].push_back(std::move(entry));
+						}
+					}
+					if (!in.done()) {
+						throw std::runtime_error("wal: corrupted record");
+					}
+				}
+			});
+			std::vector<wal_entry<GraphSchema>> entries;
+			for (auto&& frame_entries : decoded) {
+				std::ranges::move(frame_entries, std::back_inserter(entries));
+			}
+			apply_entries(entries, pool);
+			log_sequence = std::max(log_sequence, frames[last - 1].last_sequence());
+			first = last;
+		}
+	}
+
+	void apply_entries(std::vector<wal_entry<GraphSchema>>& entries, thread_pool& pool)
+	{
+		using vertex_row_t = decltype(std::tuple_cat(std::declval<std::tuple<typename GraphSchema::vertex_user_id_t>>(),
+			std::declval<typename GraphSchema::vertex_property_t>()));
+		using edge_row_t = decltype(std::tuple_cat(std::declval<std::tuple<typename GraphSchema::edge_user_id_t, vertex_t, vertex_t>>(),
+			std::declval<typename GraphSchema::edge_property_t>()));
+
+		for (size_t b = 0; b < entries.size();) {
+			wal_record kind = entries[b].kind;
+			size_t e = b;
+			while (e < entries.size() && entries[e].kind == kind) {
+				++e;
+			}
+			std::span<wal_entry<GraphSchema>> run(entries.data() + b, e - b);
+			b = e;
+
+			if (kind == wal_record::add_vertex) {
+				std::vector<vertex_row_t> rows;
+				rows.reserve(run.size());
+				for (auto&& entry : run) {
+					rows.push_back(std::tuple_cat(std::make_tuple(std::move(entry.vertex)), std::move(entry.vertex_properties)));
+				}
+				add_vertices(std::move(rows));
+				continue;
+			}
+			bool of_vertex = kind == wal_record::add_edge || kind == wal_record::set_vertex_property
+				|| kind == wal_record::set_vertex_properties || kind == wal_record::remove_vertex;
+			std::vector<size_t> found = lookup_all(run, pool, [&](const wal_entry<GraphSchema>& entry) {
+				return of_vertex ? vertex_index.find(entry.vertex, vertex_ids) : edge_index.find(entry.edge, edge_ids);
+			});
+			if (kind == wal_record::add_edge) {
+				std::vector<size_t> targets = lookup_all(run, pool, [&](const wal_entry<GraphSchema>& entry) {
+					return vertex_index.find(entry.target, vertex_ids);
+				});
+				std::vector<edge_row_t> rows;
+				rows.reserve(run.size());
+				for (size_t i = 0; i < run.size(); ++i) {
+					rows.push_back(std::tuple_cat(std::make_tuple(std::move(run[i].edge), make_vertex(found[i]), make_vertex(targets[i])),
+						std::move(run[i].edge_properties)));
+				}
+				add_edges(std::move(rows));
+				continue;
+			}
+			for (size_t i = 0; i < run.size(); ++i) {
+				apply_entry(run[i], found[i]);
+			}
+		}
+	}
+
+	/**
+	 * @brief Looks up the elements of log records in parallel, add_edge records by their source vertex.
+	 * @throws std::runtime_error If an element is missing, which a log written by this database never leads to.
+	 */
+	template<typename Lookup>
+	std::vector<size_t> lookup_all(std::span<wal_entry<GraphSchema>> run, thread_pool& pool, Lookup&& lookup)
+	{
+		std::vector<size_t> found(run.size());
+		pool.parallel_for(0, run.size(), 1024, [&](size_t b, size_t e) {
+			for (size_t i = b; i < e; ++i) {
+				found[i] = lookup(run[i]);
+				if (found[i] == vertex_index.npos) {
+					throw std::runtime_error("wal: record of a missing element");
+				}
+			}
+		});
+		return found;
+	}
+
+	void apply_entry(wal_entry<GraphSchema>& entry, size_t index)
+	{
+		switch (entry.kind) {
+		case wal_record::set_vertex_property:
+			[&]<size_t ...Is>(std::index_sequence<Is...>) {
+				((entry.property == Is ? set_vertex_property<Is>(index, std::move(std::get<Is>(entry.vertex_properties))) : void()), ...);
+			}(std::make_index_sequence<std::tuple_size_v<vertex_properties_t>>{});
+			break;
+		case wal_record::set_edge_property:
+			[&]<size_t ...Is>(std::index_sequence<Is...>) {
+				((entry.property == Is ? set_edge_property<Is>(index, std::move(std::get<Is>(entry.edge_properties))) : void()), ...);
+			}(std::make_index_sequence<std::tuple_size_v<edge_properties_t>>{});
+			break;
+		case wal_record::set_vertex_properties:
+			std::apply([&](auto&... values) { set_vertex_properties(index, std::move(values)...); }, entry.vertex_properties);
+			break;
+		case wal_record::set_edge_properties:
+			std::apply([&](auto&... values) { set_edge_properties(index, std::move(values)...); }, entry.edge_properties);
+			break;
+		case wal_record::remove_vertex:
+			remove_vertex(make_vertex(index));
+			break;
+		case wal_record::remove_edge:
+			remove_edge(make_edge(index));
+			break;
+		default:
+			break;
+		}
+	}
+
+	/**
+	 * @brief Reports the row capacity of the vertex columns to the instrumentation, the lowest one among them.
+	 */
+	void report_vertex_capacity() const
+	{
+		if constexpr (has_instrumentation) {
+			size_t capacity = vertex_ids.capacity();
+			std::apply([&capacity](const auto&... columns) { ((capacity = std::min(capacity, columns.capacity())), ...); }, vertex_properties);
+			instruments.column_capacity(true, capacity);
+		}
+	}
+
+	void report_edge_capacity() const
+	{
+		if constexpr (has_instrumentation) {
+			size_t capacity = std::min({ edge_ids.capacity(), edge_src.capacity(), edge_dst.capacity() });
+			std::apply([&capacity](const auto&... columns) { ((capacity = std::min(capacity, columns.capacity())), ...); }, edge_properties);
+			instruments.column_capacity(false, capacity);
+		}
+	}
+
+	vertex_t make_vertex(size_t index)
+	{
+		return vertex_t(this, index);
+	}
+
+	const_vertex_t make_vertex(size_t index) const
+	{
+		return const_vertex_t(this, index);
+	}
+
+	edge_t make_edge(size_t index)
+	{
+		return edge_t(this, index);
+	}
+
+	const_edge_t make_edge(size_t index) const
+	{
+		return const_edge_t(this, index);
+	}
+
+	/**
+	 * @brief Returns the handles of the elements with the given dense indices, going through db.
+	 */
+	template<class Handle>
+	static std::vector<Handle> handles_of(typename Handle::db_pointer db, const std::vector<size_t>& indices)
+	{
+		std::vector<Handle> result;
+		result.reserve(indices.size());
+		for (size_t i : indices) {
+			result.emplace_back(db, i);
+		}
+		return result;
+	}
+
+	/**
+	 * @brief Returns the range of get_vertexes() with handles going through db, which is this database.
+	 */
+	template<class It>
+	std::ranges::subrange<It> vertex_range(typename It::value_type::db_pointer db) const
+	{
+		auto timer = instruments.time(graph_op::traversal, vertex_ids.size() - removed_vertices.count());
+		const tombstone_bitmap* removed = removed_vertices.empty() ? nullptr : &removed_vertices;
+		const std::vector<size_t>* order = insertion_order.empty() ? nullptr : &insertion_order;
+		return { It::first_live(db, 0, removed, order), It(db, vertex_ids.size(), removed, order) };
+	}
+
+	/**
+	 * @brief Returns the range of get_edges() with handles going through db, which is this database.
+	 */
+	template<class It>
+	std::ranges::subrange<It> edge_range(typename It::value_type::db_pointer db) const
+	{
+		auto timer = instruments.time(graph_op::traversal, edge_ids.size() - removed_edges.count());
+		const tombstone_bitmap* removed = removed_edges.empty() ? nullptr : &removed_edges;
+		return { It(db, removed_edges.next_live(0), removed), It(db, edge_ids.size(), removed) };
+	}
+
+	size_t find_vertex_index(const typename GraphSchema::vertex_user_id_t& vuid) const
+	{
+		auto timer = instruments.time(graph_op::id_lookup, 0);
+		size_t index = vertex_index.find(vuid, vertex_ids);
+		if (index != vertex_index.npos) {
+			timer.add_items(1);
+		}
+		return index;
+	}
+
+	size_t find_edge_index(const typename GraphSchema::edge_user_id_t& euid) const
+	{
+		auto timer = instruments.time(graph_op::id_lookup, 0);
+		size_t index = edge_index.find(euid, edge_ids);
+		if (index != edge_index.npos) {
+			timer.add_items(1);
+		}
+		return index;
+	}
+
+	/**
+	 * @brief Returns the dense indices of common_neighbors().
+	 */
+	std::vector<size_t> common_destinations(const const_vertex_t& v1, const const_vertex_t& v2) const
+	{
+		std::vector<size_t> scratch1;
+		std::vector<size_t> scratch2;
+		std::span<const size_t> a = sorted_destinations(v1.get_index(), scratch1);
+		std::span<const size_t> b = sorted_destinations(v2.get_index(), scratch2);
+		std::vector<size_t> common(std::min(a.size(), b.size()));
+		common.resize(simd_intersect(a.data(), a.size(), b.data(), b.size(), common.data()));
+		return common;
+	}
+
+	decltype(auto) vertex_id(size_t index) const
+	{
+		return column_get(vertex_ids, index);
+	}
+
+	decltype(auto) edge_id(size_t index) const
+	{
+		return column_get(edge_ids, index);
+	}
+
+	typename GraphSchema::vertex_property_t get_vertex_properties(size_t index) const
+	{
+		return gather_row<typename GraphSchema::vertex_property_t>(vertex_properties, index);
+	}
+
+	typename GraphSchema::edge_property_t get_edge_properties(size_t index) const
+	{
+		return gather_row<typename GraphSchema::edge_property_t>(edge_properties, index);
+	}
+
+	template<size_t I>
+	decltype(auto) get_vertex_property(size_t index) const
+	{
+		return column_get(std::get<I>(vertex_properties), index);
+	}
+
+	template<size_t I>
+	decltype(auto) get_edge_property(size_t index) const
+	{
+		return column_get(std::get<I>(edge_properties), index);
+	}
+
+	template<size_t I, typename PropType>
+	void set_vertex_property(size_t index, PropType&& prop)
+	{
+		store_vertex_property<I>(index, std::forward<PropType>(prop));
+		log_vertex_property<I>(index);
+	}
+
+	template<size_t I, typename PropType>
+	void set_edge_property(size_t index, PropType&& prop)
+	{
+		store_edge_property<I>(index, std::forward<PropType>(prop));
+		log_edge_property<I>(index);
+	}
+
+	template<size_t I, typename PropType>
+	void store_vertex_property(size_t index, PropType&& prop)
+	{
+		auto timer = instruments.time(graph_op::set_property);
+		if (removed_vertices.test(index)) {
+			throw std::invalid_argument("graph_db: vertex is removed");
+		}
+		auto& column = std::get<I>(vertex_properties);
+		std::get<I>(vertex_property_indexes).erase(column, index);
+		column_set(column, index, std::forward<PropType>(prop));
+		std::get<I>(vertex_property_indexes).insert(column, index);
+	}
+
+	template<size_t I, typename PropType>
+	void store_edge_property(size_t index, PropType&& prop)
+	{
+		auto timer = instruments.time(graph_op::set_property);
+		if (removed_edges.test(index)) {
+			throw std::invalid_argument("graph_db: edge is removed");
+		}
+		auto& column = std::get<I>(edge_properties);
+		std::get<I>(edge_property_indexes).erase(column, index);
+		column_set(column, index, std::forward<PropType>(prop));
+		std::get<I>(edge_property_indexes).insert(column, index);
+	}
+
+	template<typename ...Props>
+	void set_vertex_properties(size_t index, Props &&...props)
+	{
+		[&]<size_t ...Is>(std::index_sequence<Is...>) {
+			auto values = std::forward_as_tuple(std::forward<Props>(props)...);
+			(store_vertex_property<Is>(index, std::get<Is>(std::move(values))), ...);
+		}(std::index_sequence_for<Props...>{});
+		log_vertex(wal_record::set_vertex_properties, index);
+	}
+
+	template<typename ...Props>
+	void set_edge_properties(size_t index, Props &&...props)
+	{
+		[&]<size_t ...Is>(std::index_sequence<Is...>) {
+			auto values = std::forward_as_tuple(std::forward<Props>(props)...);
+			(store_edge_property<Is>(index, std::get<Is>(std::move(values))), ...);
+		}(std::index_sequence_for<Props...>{});
+		log_edge(wal_record::set_edge_properties, index);
+	}
+
 	//std::vector<vertex_t> vertices_;
 //	std::vector<edge_t> edges_;
 
-	std::vector<vertex_user_id_t> vertex_ids;
-	std::vector<edge_user_id_t> edge_ids;
+	vertex_ids_t vertex_ids;
+	edge_ids_t edge_ids;
 	vertex_properties_t vertex_properties;
 	edge_properties_t edge_properties;
+	schema_vector_t<GraphSchema, size_t> edge_src;
+	schema_vector_t<GraphSchema, size_t> edge_dst;
+	adjacency_index adjacency{ has_sorted_adjacency };
+	adjacency_index reverse_adjacency{ has_sorted_adjacency };
+	id_index<typename schema_id_column<GraphSchema, typename GraphSchema::vertex_user_id_t>::key_type> vertex_index;
+	id_index<typename schema_id_column<GraphSchema, typename GraphSchema::edge_user_id_t>::key_type> edge_index;
+	vertex_indexes_t vertex_property_indexes;
+	edge_indexes_t edge_property_indexes;
+	tombstone_bitmap removed_vertices;
+	tombstone_bitmap removed_edges;
+	// The dense index of every vertex by its insertion rank once reorder() permuted them, empty before.
+	std::vector<size_t> insertion_order;
+	[[no_unique_address]] graph_instruments<has_instrumentation> instruments;
+	std::unique_ptr<write_ahead_log> wal;
+	// The sequence number of the last mutation logged or replayed, saved with snapshots.
+	uint64_t log_sequence = 0;
 };
 
 #endif //GRAPH_DB_HPP
@@ -0,0 +1,54 @@
+#ifndef GRAPH_GENERATORS_HPP
+#define GRAPH_GENERATORS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Generates m directed edges between uniformly random vertexes of [0, n) (Erdos-Renyi G(n, m) with repetitions).
+ * @return Pairs of (source, destination) dense indices.
+ */
+inline std::vector<std::pair<size_t, size_t>> uniform_edges(size_t n, size_t m, uint64_t seed = 1)
+{
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<size_t> vertex(0, n - 1);
+    std::vector<std::pair<size_t, size_t>> edges(m);
+    for (auto&& e : edges) {
+        e.first = vertex(rng);
+        e.second = vertex(rng);
+    }
+    return edges;
+}
+
+/**
+ * @brief Generates m directed edges of a power-law graph on 2^scale vertexes with the R-MAT model.
+ * @param a, b, c The probabilities of the top-left, top-right and bottom-left quadrant, the rest is the bottom-right one.
+ * @return Pairs of (source, destination) dense indices.
+ * @note The defaults are those of Graph500. Vertex indices are not scrambled, so low indices are the hubs.
+ */
+inline std::vector<std::pair<size_t, size_t>> rmat_edges(size_t scale, size_t m, uint64_t seed = 1,
+    double a = 0.57, double b = 0.19, double c = 0.19)
+{
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+    std::vector<std::pair<size_t, size_t>> edges(m);
+    for (auto&& e : edges) {
+        size_t src = 0;
+        size_t dst = 0;
+        for (size_t bit = 0; bit < scale; ++bit) {
+            double r = coin(rng);
+            bool down = r >= a + b;
+            bool right = down ? r >= a + b + c : r >= a;
+            src = (src << 1) | down;
+            dst = (dst << 1) | right;
+        }
+        e.first = src;
+        e.second = dst;
+    }
+    return edges;
+}
+
+#endif // !GRAPH_GENERATORS_HPP
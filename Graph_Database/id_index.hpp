@@ -0,0 +1,178 @@
+#ifndef ID_INDEX_HPP
+#define ID_INDEX_HPP
+
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+/**
+ * @brief An open-addressing hash index from a user id to the dense index of the element.
+ * @tparam Key The type of the user id.
+ * @tparam Hash The hash function of the user id.
+ * @note The keys themselves are not stored, the slots only keep the hash and the dense index
+ * and the keys are compared through the id column of the database.
+ */
+template<typename Key, typename Hash = std::hash<Key>>
+class id_index {
+public:
+    /**
+     * @brief The value returned when the key is not present.
+     */
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    /**
+     * @brief Looks up the dense index of the given key.
+     * @param key The user id.
+     * @param keys The id column, keys[i] is the user id of the i-th element.
+     * @return The dense index or npos.
+     */
+    template<typename Keys>
+    size_t find(const Key& key, const Keys& keys) const
+    {
+        if (slots.empty()) {
+            return npos;
+        }
+        size_t hash = hash_of(key);
+        for (size_t pos = hash & mask();; pos = (pos + 1) & mask()) {
+            const slot& s = slots[pos];
+            if (s.index == npos) {
+                return npos;
+            }
+            if (s.hash == hash && keys[s.index] == key) {
+                return s.index;
+            }
+        }
+    }
+
+    /**
+     * @brief Inserts the key unless it is already present, in a single probe sequence.
+     * @param key The user id.
+     * @param index The dense index the key maps to.
+     * @param keys The id column, the key itself does not have to be in it yet.
+     * @return npos if the key was inserted, otherwise the dense index of the already present key.
+     */
+    template<typename Keys>
+    size_t try_insert(const Key& key, size_t index, const Keys& keys)
+    {
+        if ((count + 1) * 4 > slots.size() * 3) {
+            rehash(slots.empty() ? min_capacity : slots.size() * 2);
+        }
+        size_t hash = hash_of(key);
+        for (size_t pos = hash & mask();; pos = (pos + 1) & mask()) {
+            slot& s = slots[pos];
+            if (s.index == npos) {
+                s = { hash, index };
+                ++count;
+                return npos;
+            }
+            if (s.hash == hash && keys[s.index] == key) {
+                return s.index;
+            }
+        }
+    }
+
+    /**
+     * @brief Removes the key which maps to the given dense index.
+     * @param key The user id.
+     * @param index The dense index the key maps to.
+     * @return False if the key does not map to the index.
+     * @note The following slots of the probe sequence are shifted back, so lookups stay correct without tombstones.
+     */
+    bool erase(const Key& key, size_t index)
+    {
+        if (slots.empty()) {
+            return false;
+        }
+        size_t pos = hash_of(key) & mask();
+        while (slots[pos].index != index) {
+            if (slots[pos].index == npos) {
+                return false;
+            }
+            pos = (pos + 1) & mask();
+        }
+        for (size_t next = (pos + 1) & mask(); slots[next].index != npos; next = (next + 1) & mask()) {
+            // The slot may move to the hole unless its home lies cyclically in (pos, next].
+            size_t home = slots[next].hash & mask();
+            if (((next - home) & mask()) >= ((next - pos) & mask())) {
+                slots[pos] = slots[next];
+                pos = next;
+            }
+        }
+        slots[pos] = slot();
+        --count;
+        return true;
+    }
+
+    /**
+     * @brief Makes room for n keys so that inserting them does not rehash.
+     */
+    void reserve(size_t n)
+    {
+        size_t capacity = std::bit_ceil((n * 4 + 2) / 3 + 1);
+        if (capacity > slots.size()) {
+            rehash(capacity < min_capacity ? min_capacity : capacity);
+        }
+    }
+
+    /**
+     * @brief Returns the number of keys in the index.
+     */
+    size_t size() const
+    {
+        return count;
+    }
+
+    /**
+     * @brief Removes all keys.
+     */
+    void clear()
+    {
+        slots.clear();
+        count = 0;
+    }
+
+private:
+    struct slot {
+        size_t hash = 0;
+        size_t index = npos;
+    };
+
+    static constexpr size_t min_capacity = 16;
+
+    static size_t hash_of(const Key& key)
+    {
+        // Mixes the bits so that identity hashes of integers spread over the whole table.
+        size_t h = Hash{}(key);
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    size_t mask() const
+    {
+        return slots.size() - 1;
+    }
+
+    void rehash(size_t capacity)
+    {
+        std::vector<slot> old(capacity);
+        old.swap(slots);
+        for (auto&& s : old) {
+            if (s.index == npos) {
+                continue;
+            }
+            size_t pos = s.hash & mask();
+            while (slots[pos].index != npos) {
+                pos = (pos + 1) & mask();
+            }
+            slots[pos] = s;
+        }
+    }
+
+    std::vector<slot> slots;
+    size_t count = 0;
+};
+
+#endif // !ID_INDEX_HPP
@@ -0,0 +1,467 @@
+#ifndef INSTRUMENTATION_HPP
+#define INSTRUMENTATION_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief The operations of graph_db whose calls and latencies are recorded.
+ */
+enum class graph_op : size_t {
+    add_vertex,
+    add_edge,
+    set_property,
+    /**
+     * @brief find_vertex and find_edge.
+     */
+    id_lookup,
+    /**
+     * @brief vertex::edges and vertex::in_edges.
+     */
+    neighbor_scan,
+    /**
+     * @brief get_vertexes and get_edges.
+     */
+    traversal,
+    count,
+};
+
+inline constexpr size_t graph_op_count = static_cast<size_t>(graph_op::count);
+
+/**
+ * @brief Returns the snake_case name of the operation, used as a metric label.
+ */
+inline constexpr std::string_view graph_op_name(graph_op op)
+{
+    constexpr std::string_view names[graph_op_count] = {
+        "add_vertex", "add_edge", "set_property", "id_lookup", "neighbor_scan", "traversal",
+    };
+    return names[static_cast<size_t>(op)];
+}
+
+template<bool Enabled>
+class graph_instruments;
+
+/**
+ * @brief A histogram of nanosecond latencies with logarithmic buckets split linearly, in the manner of HdrHistogram.
+ * @note Values below 32 have buckets of their own, every larger power of two range is split into 16 buckets,
+ * so any quantile is reported within 1/16 of the recorded value over the whole 64-bit range in 7.6 KiB.
+ */
+class latency_histogram {
+public:
+    static constexpr size_t sub_bits = 4;
+    static constexpr size_t sub_count = size_t(1) << sub_bits;
+    static constexpr size_t bucket_count = (64 - sub_bits + 1) * sub_count;
+
+    static constexpr size_t bucket_of(uint64_t value)
+    {
+        if (value < 2 * sub_count) {
+            return static_cast<size_t>(value);
+        }
+        size_t exponent = static_cast<size_t>(std::bit_width(value)) - 1;
+        size_t shift = exponent - sub_bits;
+        return (shift + 1) * sub_count + static_cast<size_t>((value >> shift) & (sub_count - 1));
+    }
+
+    /**
+     * @brief Returns the lowest value of the bucket.
+     */
+    static constexpr uint64_t bucket_floor(size_t bucket)
+    {
+        if (bucket < 2 * sub_count) {
+            return bucket;
+        }
+        size_t shift = bucket / sub_count - 1;
+        return (sub_count + bucket % sub_count) << shift;
+    }
+
+    /**
+     * @brief Returns the highest value of the bucket.
+     */
+    static constexpr uint64_t bucket_ceiling(size_t bucket)
+    {
+        if (bucket < 2 * sub_count) {
+            return bucket;
+        }
+        return bucket_floor(bucket) + (uint64_t(1) << (bucket / sub_count - 1)) - 1;
+    }
+
+    latency_histogram() : buckets(bucket_count, 0) {}
+
+    void record(uint64_t value, uint64_t times = 1)
+    {
+        buckets[bucket_of(value)] += times;
+        min_ = total == 0 ? value : std::min(min_, value);
+        max_ = std::max(max_, value);
+        total += times;
+        sum_ += value * times;
+    }
+
+    /**
+     * @brief Adds all values of another histogram.
+     */
+    void merge(const latency_histogram& other)
+    {
+        if (other.total == 0) {
+            return;
+        }
+        for (size_t b = 0; b < bucket_count; ++b) {
+            buckets[b] += other.buckets[b];
+        }
+        min_ = total == 0 ? other.min_ : std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+        total += other.total;
+        sum_ += other.sum_;
+    }
+
+    uint64_t count() const
+    {
+        return total;
+    }
+
+    uint64_t sum() const
+    {
+        return sum_;
+    }
+
+    uint64_t min() const
+    {
+        return min_;
+    }
+
+    uint64_t max() const
+    {
+        return max_;
+    }
+
+    double mean() const
+    {
+        return total == 0 ? 0 : static_cast<double>(sum_) / static_cast<double>(total);
+    }
+
+    /**
+     * @brief Returns the value below or at which the fraction q of the recorded values lies.
+     * @param q A quantile in [0, 1].
+     * @return The highest value of the bucket holding the quantile, capped by the maximum, or 0 if nothing was recorded.
+     */
+    uint64_t quantile(double q) const
+    {
+        if (total == 0) {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(std::clamp(q, 0.0, 1.0) * static_cast<double>(total - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t b = 0; b < bucket_count; ++b) {
+            seen += buckets[b];
+            if (seen >= rank) {
+                return std::clamp(bucket_ceiling(b), min_, max_);
+            }
+        }
+        return max_;
+    }
+
+    /**
+     * @brief Returns the number of values recorded in the bucket.
+     */
+    uint64_t bucket(size_t b) const
+    {
+        return buckets[b];
+    }
+
+private:
+    template<bool Enabled>
+    friend class graph_instruments;
+
+    std::vector<uint64_t> buckets;
+    uint64_t total = 0;
+    uint64_t sum_ = 0;
+    uint64_t min_ = 0;
+    uint64_t max_ = 0;
+};
+
+/**
+ * @brief The statistics of one graph_db operation.
+ */
+struct operation_stats {
+    /**
+     * @brief The number of calls.
+     */
+    uint64_t calls = 0;
+    /**
+     * @brief The number of elements the calls inserted, updated, found or handed out for iteration.
+     */
+    uint64_t items = 0;
+    /**
+     * @brief The latency of every call in nanoseconds.
+     */
+    latency_histogram latency;
+};
+
+/**
+ * @brief A snapshot of the statistics of a graph_db, see graph_db::stats().
+ */
+struct graph_stats {
+    std::array<operation_stats, graph_op_count> operations;
+    /**
+     * @brief The number of insertions and reservations that made the vertex columns reallocate.
+     */
+    uint64_t vertex_column_growths = 0;
+    /**
+     * @brief The number of insertions and reservations that made the edge columns reallocate.
+     */
+    uint64_t edge_column_growths = 0;
+    /**
+     * @brief The capacity of the vertex columns in rows, the lowest one among the columns.
+     */
+    uint64_t vertex_capacity = 0;
+    /**
+     * @brief The capacity of the edge columns in rows, the lowest one among the columns.
+     */
+    uint64_t edge_capacity = 0;
+
+    const operation_stats& operator[](graph_op op) const
+    {
+        return operations[static_cast<size_t>(op)];
+    }
+
+    /**
+     * @brief Writes the statistics in the Prometheus text exposition format.
+     * @param out The stream to write to.
+     * @param prefix The prefix of the metric names.
+     * @note Latencies become a summary in seconds with the 0.5, 0.9, 0.99 and 0.999 quantiles.
+     */
+    void write_prometheus(std::ostream& out, std::string_view prefix = "graph_db") const
+    {
+        out << "# TYPE " << prefix << "_calls_total counter\n";
+        for (size_t i = 0; i < graph_op_count; ++i) {
+            out << prefix << "_calls_total{op=\"" << graph_op_name(static_cast<graph_op>(i)) << "\"} " << operations[i].calls << '\n';
+        }
+        out << "# TYPE " << prefix << "_items_total counter\n";
+        for (size_t i = 0; i < graph_op_count; ++i) {
+            out << prefix << "_items_total{op=\"" << graph_op_name(static_cast<graph_op>(i)) << "\"} " << operations[i].items << '\n';
+        }
+        out << "# TYPE " << prefix << "_latency_seconds summary\n";
+        for (size_t i = 0; i < graph_op_count; ++i) {
+            std::string_view name = graph_op_name(static_cast<graph_op>(i));
+            const latency_histogram& h = operations[i].latency;
+            for (double q : { 0.5, 0.9, 0.99, 0.999 }) {
+                out << prefix << "_latency_seconds{op=\"" << name << "\",quantile=\"" << q << "\"} "
+                    << static_cast<double>(h.quantile(q)) * 1e-9 << '\n';
+            }
+            out << prefix << "_latency_seconds_sum{op=\"" << name << "\"} " << static_cast<double>(h.sum()) * 1e-9 << '\n';
+            out << prefix << "_latency_seconds_count{op=\"" << name << "\"} " << h.count() << '\n';
+        }
+        out << "# TYPE " << prefix << "_column_growths_total counter\n";
+        out << prefix << "_column_growths_total{element=\"vertex\"} " << vertex_column_growths << '\n';
+        out << prefix << "_column_growths_total{element=\"edge\"} " << edge_column_growths << '\n';
+        out << "# TYPE " << prefix << "_column_capacity gauge\n";
+        out << prefix << "_column_capacity{element=\"vertex\"} " << vertex_capacity << '\n';
+        out << prefix << "_column_capacity{element=\"edge\"} " << edge_capacity << '\n';
+    }
+};
+
+/**
+ * @brief Records the statistics of a graph_db, the no-op primary template is used when instrumentation is off.
+ * @note All members are empty inline functions, so a disabled recorder compiles away entirely.
+ */
+template<bool Enabled>
+class graph_instruments {
+public:
+    struct timer {
+        // User-provided like the RAII timer of graph_instruments<true>, so variables holding it do not warn as unused.
+        ~timer() {}
+
+        void add_items(uint64_t) {}
+    };
+
+    timer time(graph_op, uint64_t = 1) const
+    {
+        return {};
+    }
+
+    void column_capacity(bool, uint64_t) const {}
+};
+
+/**
+ * @brief Records the statistics of an instrumented graph_db with relaxed atomics.
+ * @note Const operations of the database record too, so the counters are atomic and concurrent readers may record
+ * at the same time. A recording costs two reads of the steady clock and a few uncontended atomic additions.
+ * @note Copies start with the statistics of the original.
+ */
+template<>
+class graph_instruments<true> {
+public:
+    /**
+     * @brief Measures one call from its construction to its destruction.
+     */
+    class timer {
+    public:
+        timer(const graph_instruments* owner, graph_op op, uint64_t items)
+            : owner(owner), op(op), items(items), start(std::chrono::steady_clock::now())
+        {}
+
+        timer(const timer&) = delete;
+        timer& operator=(const timer&) = delete;
+
+        ~timer()
+        {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            owner->record(op, items, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+
+        /**
+         * @brief Counts more elements towards the call, for operations whose size is known only at their end.
+         */
+        void add_items(uint64_t n)
+        {
+            items += n;
+        }
+
+    private:
+        const graph_instruments* owner;
+        graph_op op;
+        uint64_t items;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    graph_instruments() = default;
+
+    graph_instruments(const graph_instruments& other)
+    {
+        copy_from(other);
+    }
+
+    graph_instruments& operator=(const graph_instruments& other)
+    {
+        if (this != &other) {
+            copy_from(other);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Starts measuring a call of the operation, which counts the given number of elements.
+     */
+    timer time(graph_op op, uint64_t items = 1) const
+    {
+        return timer(this, op, items);
+    }
+
+    /**
+     * @brief Reports the capacity of the vertex or edge columns after an insertion or a reservation.
+     * @note A capacity other than the last reported one counts as a growth event.
+     */
+    void column_capacity(bool vertex_columns, uint64_t capacity) const
+    {
+        column_counter& c = vertex_columns ? vertex_growth : edge_growth;
+        if (c.capacity.exchange(capacity, std::memory_order_relaxed) != capacity) {
+            c.events.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    graph_stats snapshot() const
+    {
+        graph_stats stats;
+        for (size_t i = 0; i < graph_op_count; ++i) {
+            const op_counter& c = counters[i];
+            operation_stats& s = stats.operations[i];
+            s.calls = c.calls.load(std::memory_order_relaxed);
+            s.items = c.items.load(std::memory_order_relaxed);
+            latency_histogram& h = s.latency;
+            for (size_t b = 0; b < latency_histogram::bucket_count; ++b) {
+                h.buckets[b] = c.buckets[b].load(std::memory_order_relaxed);
+                h.total += h.buckets[b];
+            }
+            if (h.total != 0) {
+                h.sum_ = c.sum.load(std::memory_order_relaxed);
+                h.min_ = c.min.load(std::memory_order_relaxed);
+                h.max_ = c.max.load(std::memory_order_relaxed);
+            }
+        }
+        stats.vertex_column_growths = vertex_growth.events.load(std::memory_order_relaxed);
+        stats.edge_column_growths = edge_growth.events.load(std::memory_order_relaxed);
+        stats.vertex_capacity = vertex_growth.capacity.load(std::memory_order_relaxed);
+        stats.edge_capacity = edge_growth.capacity.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    void reset()
+    {
+        for (auto&& c : counters) {
+            c.calls.store(0, std::memory_order_relaxed);
+            c.items.store(0, std::memory_order_relaxed);
+            c.sum.store(0, std::memory_order_relaxed);
+            c.min.store(UINT64_MAX, std::memory_order_relaxed);
+            c.max.store(0, std::memory_order_relaxed);
+            for (auto&& b : c.buckets) {
+                b.store(0, std::memory_order_relaxed);
+            }
+        }
+        for (column_counter* c : { &vertex_growth, &edge_growth }) {
+            c->events.store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    struct op_counter {
+        std::atomic<uint64_t> calls{ 0 };
+        std::atomic<uint64_t> items{ 0 };
+        std::atomic<uint64_t> sum{ 0 };
+        std::atomic<uint64_t> min{ UINT64_MAX };
+        std::atomic<uint64_t> max{ 0 };
+        std::array<std::atomic<uint64_t>, latency_histogram::bucket_count> buckets{};
+    };
+
+    struct column_counter {
+        std::atomic<uint64_t> events{ 0 };
+        std::atomic<uint64_t> capacity{ 0 };
+    };
+
+    void record(graph_op op, uint64_t items, uint64_t nanoseconds) const
+    {
+        op_counter& c = counters[static_cast<size_t>(op)];
+        c.calls.fetch_add(1, std::memory_order_relaxed);
+        c.items.fetch_add(items, std::memory_order_relaxed);
+        c.sum.fetch_add(nanoseconds, std::memory_order_relaxed);
+        c.buckets[latency_histogram::bucket_of(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+        uint64_t low = c.min.load(std::memory_order_relaxed);
+        while (nanoseconds < low && !c.min.compare_exchange_weak(low, nanoseconds, std::memory_order_relaxed)) {}
+        uint64_t high = c.max.load(std::memory_order_relaxed);
+        while (nanoseconds > high && !c.max.compare_exchange_weak(high, nanoseconds, std::memory_order_relaxed)) {}
+    }
+
+    void copy_from(const graph_instruments& other)
+    {
+        for (size_t i = 0; i < graph_op_count; ++i) {
+            op_counter& c = counters[i];
+            const op_counter& o = other.counters[i];
+            c.calls.store(o.calls.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            c.items.store(o.items.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            c.sum.store(o.sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            c.min.store(o.min.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            c.max.store(o.max.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            for (size_t b = 0; b < latency_histogram::bucket_count; ++b) {
+                c.buckets[b].store(o.buckets[b].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            }
+        }
+        for (auto [c, o] : { std::pair(&vertex_growth, &other.vertex_growth), std::pair(&edge_growth, &other.edge_growth) }) {
+            c->events.store(o->events.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            c->capacity.store(o->capacity.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+    }
+
+    mutable std::array<op_counter, graph_op_count> counters;
+    mutable column_counter vertex_growth;
+    mutable column_counter edge_growth;
+};
+
+#endif // !INSTRUMENTATION_HPP
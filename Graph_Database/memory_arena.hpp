@@ -0,0 +1,129 @@
+#ifndef MEMORY_ARENA_HPP
+#define MEMORY_ARENA_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+/**
+ * @brief A monotonic memory resource which carves allocations out of a few large chunks.
+ * @note Deallocation is a no-op and all memory is returned at once by release() or the destructor,
+ * so filling the columns of a graph costs a handful of upstream allocations and tearing them down is O(chunks).
+ * @note It is not synchronized, like graph_db itself it is meant for a single writer.
+ * Parallel loaders should give every thread its own arena.
+ * @see schema_allocator
+ */
+class arena_resource : public std::pmr::memory_resource {
+public:
+    /**
+     * @param initial_chunk The size of the first chunk in bytes, every next chunk is twice as big up to max_chunk.
+     * @param upstream The resource the chunks are taken from.
+     */
+    explicit arena_resource(size_t initial_chunk = 64 * 1024,
+        std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : next_chunk(std::max<size_t>(initial_chunk, 64)), upstream(upstream)
+    {}
+
+    arena_resource(const arena_resource&) = delete;
+    arena_resource& operator=(const arena_resource&) = delete;
+
+    ~arena_resource() override
+    {
+        release();
+    }
+
+    /**
+     * @brief Returns all chunks to the upstream resource, memory handed out before must not be used anymore.
+     */
+    void release()
+    {
+        for (auto&& c : chunks) {
+            upstream->deallocate(c.data, c.size, alignof(std::max_align_t));
+        }
+        chunks.clear();
+        cursor = nullptr;
+        space = 0;
+        used = 0;
+        reserved = 0;
+    }
+
+    /**
+     * @brief Returns the number of bytes handed out since the last release().
+     */
+    size_t bytes_allocated() const
+    {
+        return used;
+    }
+
+    /**
+     * @brief Returns the number of bytes taken from the upstream resource.
+     */
+    size_t bytes_reserved() const
+    {
+        return reserved;
+    }
+
+    static constexpr size_t max_chunk = size_t(64) * 1024 * 1024;
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override
+    {
+        void* p = std::align(alignment, bytes, cursor, space);
+        if (p == nullptr) {
+            // Requests bigger than a chunk get a chunk of their own, the current one stays open for small ones.
+            if (bytes + alignment > next_chunk) {
+                used += bytes;
+                return add_chunk(bytes + alignment, alignment, false);
+            }
+            add_chunk(next_chunk, alignment, true);
+            next_chunk = std::min(next_chunk * 2, max_chunk);
+            p = std::align(alignment, bytes, cursor, space);
+        }
+        cursor = static_cast<std::byte*>(cursor) + bytes;
+        space -= bytes;
+        used += bytes;
+        return p;
+    }
+
+    void do_deallocate(void*, size_t, size_t) override
+    {}
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+
+private:
+    struct chunk {
+        void* data;
+        size_t size;
+    };
+
+    void* add_chunk(size_t size, size_t alignment, bool make_current)
+    {
+        chunks.reserve(chunks.size() + 1);
+        void* data = upstream->allocate(size, alignof(std::max_align_t));
+        chunks.push_back({ data, size });
+        reserved += size;
+        if (!make_current) {
+            void* p = data;
+            size_t rest = size;
+            return std::align(alignment, size - alignment, p, rest);
+        }
+        cursor = data;
+        space = size;
+        return data;
+    }
+
+    std::vector<chunk> chunks;
+    void* cursor = nullptr;
+    size_t space = 0;
+    size_t next_chunk;
+    size_t used = 0;
+    size_t reserved = 0;
+    std::pmr::memory_resource* upstream;
+};
+
+#endif // !MEMORY_ARENA_HPP
@@ -0,0 +1,413 @@
+#ifndef PROPERTY_INDEX_HPP
+#define PROPERTY_INDEX_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "column_storage.hpp"
+#include "simd_kernels.hpp"
+
+namespace property_index_detail {
+
+template<typename T>
+bool is_nan(const T& x)
+{
+    if constexpr (std::is_floating_point_v<T>) {
+        return std::isnan(x);
+    }
+    else {
+        return false;
+    }
+}
+
+/**
+ * @brief x < y with NaN above every other value and equivalent to itself, a strict weak order also on NaN.
+ */
+template<typename X, typename Y>
+bool total_less(const X& x, const Y& y)
+{
+    if (is_nan(x)) {
+        return false;
+    }
+    if (is_nan(y)) {
+        return true;
+    }
+    return x < y;
+}
+
+/**
+ * @brief std::hash and std::equal_to, except that all NaNs are one key.
+ */
+template<typename T>
+struct key_hash {
+    size_t operator()(const T& x) const
+    {
+        return is_nan(x) ? static_cast<size_t>(-1) : std::hash<T>()(x);
+    }
+};
+
+template<typename T>
+struct key_equal {
+    bool operator()(const T& x, const T& y) const
+    {
+        return x == y || (is_nan(x) && is_nan(y));
+    }
+};
+
+} // namespace property_index_detail
+
+/**
+ * @brief A hash index of the values of a property column, for equality lookups.
+ * @note Every distinct value owns a list of the rows holding it, in no particular order. The position of every row
+ * in its list is kept as well, so moving a row between two lists on update costs O(1).
+ * @note NaNs share one list so that they can be erased again, find() never returns them, as NaN equals nothing.
+ */
+template<typename T>
+class hash_property_index {
+public:
+    /**
+     * @brief Adds the i-th row under its current value in the column.
+     */
+    template<typename Column>
+    void insert(const Column& column, size_t i)
+    {
+        auto& list = rows[T(column_get(column, i))];
+        if (i >= positions.size()) {
+            positions.resize(i + 1);
+        }
+        positions[i] = list.size();
+        list.push_back(i);
+    }
+
+    /**
+     * @brief Removes the i-th row, it must be called before the value in the column is overwritten.
+     */
+    template<typename Column>
+    void erase(const Column& column, size_t i)
+    {
+        auto found = rows.find(T(column_get(column, i)));
+        if (found == rows.end()) {
+            return;
+        }
+        auto& list = found->second;
+        size_t last = list.back();
+        list[positions[i]] = last;
+        positions[last] = positions[i];
+        list.pop_back();
+        if (list.empty()) {
+            rows.erase(found);
+        }
+    }
+
+    /**
+     * @brief Removes the i-th row for good, the value in the column must still be the indexed one.
+     */
+    template<typename Column>
+    void remove(const Column& column, size_t i)
+    {
+        erase(column, i);
+    }
+
+    /**
+     * @brief Returns the rows whose value equals the given one.
+     * @note Numbers are compared exactly, as by filter_column, a value no T equals finds nothing.
+     * @note The span is valid until the next modification of the index.
+     */
+    template<typename V>
+    std::span<const size_t> find(const V& value) const
+    {
+        T key;
+        if constexpr (std::is_arithmetic_v<T> && std::is_arithmetic_v<V>
+            && !std::is_same_v<T, bool> && !std::is_same_v<V, bool>) {
+            auto compare = simd_detail::narrow_compare<T>(compare_op::eq, value);
+            if (compare.constant || property_index_detail::is_nan(compare.value)) {
+                return {};
+            }
+            key = compare.value;
+        }
+        else {
+            key = T(value);
+        }
+        auto found = rows.find(key);
+        if (found == rows.end()) {
+            return {};
+        }
+        return found->second;
+    }
+
+    /**
+     * @brief Returns the number of distinct values.
+     */
+    size_t size() const
+    {
+        return rows.size();
+    }
+
+private:
+    std::unordered_map<T, std::vector<size_t>, property_index_detail::key_hash<T>, property_index_detail::key_equal<T>> rows;
+    std::vector<size_t> positions;
+};
+
+/**
+ * @brief A sorted index of the values of a property column, for range and equality lookups.
+ * @note It is an array of rows ordered by (value, row). Inserted and updated rows are only marked and
+ * merged into the array in one pass on the next lookup, so a batch of updates costs O(n + k log k).
+ * @note The merge is guarded like the one of adjacency_index, concurrent lookups of an index which is
+ * not being modified are safe.
+ * @note NaNs are ordered after every other value, so they are kept in the array but never found.
+ */
+class sorted_property_index {
+public:
+    sorted_property_index() = default;
+
+    sorted_property_index(const sorted_property_index& other)
+    {
+        std::lock_guard<std::mutex> lock(other.merge_mutex);
+        order = other.order;
+        pending = other.pending;
+        dirty = other.dirty;
+        stale.store(other.stale.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    sorted_property_index(sorted_property_index&& other) noexcept
+        : order(std::move(other.order)), pending(std::move(other.pending)), dirty(std::move(other.dirty)),
+        stale(other.stale.load(std::memory_order_relaxed))
+    {
+    }
+
+    sorted_property_index& operator=(const sorted_property_index& other)
+    {
+        if (this != &other) {
+            sorted_property_index copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    sorted_property_index& operator=(sorted_property_index&& other) noexcept
+    {
+        order = std::move(other.order);
+        pending = std::move(other.pending);
+        dirty = std::move(other.dirty);
+        stale.store(other.stale.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return *this;
+    }
+
+    template<typename Column>
+    void insert(const Column&, size_t i)
+    {
+        mark(i);
+    }
+
+    /**
+     * @brief Marks the i-th row as changed, its entry in the array is dropped on the next merge.
+     */
+    template<typename Column>
+    void erase(const Column&, size_t i)
+    {
+        mark(i);
+    }
+
+    /**
+     * @brief Removes the i-th row for good, its entry in the array is dropped on the next merge.
+     */
+    template<typename Column>
+    void remove(const Column&, size_t i)
+    {
+        mark(i);
+        dirty[i] = removed;
+    }
+
+    /**
+     * @brief Returns the rows whose value equals the given one, ordered by the row.
+     * @note The span is valid until the next modification of the index.
+     */
+    template<typename Column, typename V>
+    std::span<const size_t> find(const Column& column, const V& value) const
+    {
+        return find_between(column, value, value);
+    }
+
+    /**
+     * @brief Returns the rows whose value lies in [lo, hi], ordered by the value.
+     * @note The span is valid until the next modification of the index.
+     */
+    template<typename Column, typename V>
+    std::span<const size_t> find_between(const Column& column, const V& lo, const V& hi) const
+    {
+        using property_index_detail::total_less;
+        if (property_index_detail::is_nan(lo) || property_index_detail::is_nan(hi)) {
+            return {};
+        }
+        merge(column);
+        auto first = std::partition_point(order.begin(), order.end(),
+            [&](size_t i) { return total_less(column_get(column, i), lo); });
+        auto last = std::partition_point(first, order.end(),
+            [&](size_t i) { return !total_less(hi, column_get(column, i)); });
+        return { first, last };
+    }
+
+    /**
+     * @brief Merges the rows changed since the last merge into the sorted array.
+     * @note Safe to call from concurrent readers, see the class notes.
+     */
+    template<typename Column>
+    void merge(const Column& column) const
+    {
+        if (!stale.load(std::memory_order_acquire)) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(merge_mutex);
+        if (!stale.load(std::memory_order_relaxed)) {
+            return;
+        }
+        using property_index_detail::total_less;
+        auto less = [&column](size_t a, size_t b) {
+            decltype(auto) x = column_get(column, a);
+            decltype(auto) y = column_get(column, b);
+            return total_less(x, y) || (!total_less(y, x) && a < b);
+        };
+        std::erase_if(order, [this](size_t i) { return dirty[i] != clean; });
+        std::erase_if(pending, [this](size_t i) { return dirty[i] == removed; });
+        std::sort(pending.begin(), pending.end(), less);
+        size_t middle = order.size();
+        order.insert(order.end(), pending.begin(), pending.end());
+        std::inplace_merge(order.begin(), order.begin() + middle, order.end(), less);
+        for (size_t i : pending) {
+            dirty[i] = clean;
+        }
+        pending.clear();
+        stale.store(false, std::memory_order_release);
+    }
+
+    /**
+     * @brief Returns one past the highest row ever indexed, removed rows included.
+     */
+    size_t size() const
+    {
+        return dirty.size();
+    }
+
+private:
+    static constexpr uint8_t clean = 0;
+    static constexpr uint8_t changed = 1;
+    static constexpr uint8_t removed = 2;
+
+    void mark(size_t i)
+    {
+        if (i >= dirty.size()) {
+            dirty.resize(i + 1, clean);
+        }
+        if (dirty[i] == clean) {
+            dirty[i] = changed;
+            pending.push_back(i);
+            stale.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    mutable std::vector<size_t> order;
+    mutable std::vector<size_t> pending;
+    mutable std::vector<uint8_t> dirty;
+    // Set while rows wait in pending, lookups only take the mutex then.
+    mutable std::atomic<bool> stale = false;
+    mutable std::mutex merge_mutex;
+};
+
+/**
+ * @brief Placeholder of an index a property does not have, all its operations are no-ops.
+ */
+struct no_property_index {
+    template<typename Column>
+    void insert(const Column&, size_t)
+    {}
+
+    template<typename Column>
+    void erase(const Column&, size_t)
+    {}
+
+    template<typename Column>
+    void remove(const Column&, size_t)
+    {}
+
+    template<typename Column>
+    void merge(const Column&) const
+    {}
+};
+
+/**
+ * @brief The secondary indexes of one property column of type T, a hash index, a sorted index, both or none.
+ * @note The owner calls erase() before it overwrites a row and insert() after it writes one.
+ * @see schema_property_indexes
+ */
+template<typename T, bool Hashed, bool Sorted>
+class property_index {
+public:
+    static constexpr bool hashed = Hashed;
+    static constexpr bool sorted = Sorted;
+    static constexpr bool enabled = Hashed || Sorted;
+
+    template<typename Column>
+    void insert(const Column& column, size_t i)
+    {
+        hash.insert(column, i);
+        order.insert(column, i);
+    }
+
+    template<typename Column>
+    void erase(const Column& column, size_t i)
+    {
+        hash.erase(column, i);
+        order.erase(column, i);
+    }
+
+    template<typename Column>
+    void remove(const Column& column, size_t i)
+    {
+        hash.remove(column, i);
+        order.remove(column, i);
+    }
+
+    template<typename Column>
+    void merge(const Column& column) const
+    {
+        order.merge(column);
+    }
+
+    /**
+     * @brief Returns the rows whose value equals the given one, through the hash index if there is one.
+     */
+    template<typename Column, typename V>
+    std::span<const size_t> find(const Column& column, const V& value) const
+        requires enabled
+    {
+        if constexpr (Hashed) {
+            return hash.find(value);
+        }
+        else {
+            return order.find(column, value);
+        }
+    }
+
+    template<typename Column, typename V>
+    std::span<const size_t> find_between(const Column& column, const V& lo, const V& hi) const
+        requires Sorted
+    {
+        return order.find_between(column, lo, hi);
+    }
+
+private:
+    [[no_unique_address]] std::conditional_t<Hashed, hash_property_index<T>, no_property_index> hash;
+    [[no_unique_address]] std::conditional_t<Sorted, sorted_property_index, no_property_index> order;
+};
+
+#endif // !PROPERTY_INDEX_HPP
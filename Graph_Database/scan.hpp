@@ -0,0 +1,152 @@
+#ifndef SCAN_HPP
+#define SCAN_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "column_storage.hpp"
+#include "thread_pool.hpp"
+
+/**
+ * @brief A set of dense indices of selected elements stored as a bitmap.
+ */
+class selection_bitmap {
+public:
+    selection_bitmap() = default;
+
+    /**
+     * @brief Creates an empty selection over n elements.
+     */
+    explicit selection_bitmap(size_t n) : bits((n + 63) / 64, 0), count_(n) {}
+
+    /**
+     * @brief Returns the number of elements the selection is over.
+     */
+    size_t size() const
+    {
+        return count_;
+    }
+
+    bool test(size_t i) const
+    {
+        return (bits[i >> 6] >> (i & 63)) & 1;
+    }
+
+    void set(size_t i)
+    {
+        bits[i >> 6] |= uint64_t(1) << (i & 63);
+    }
+
+    /**
+     * @brief Selects all elements.
+     */
+    void set_all()
+    {
+        std::fill(bits.begin(), bits.end(), ~uint64_t(0));
+        if ((count_ & 63) != 0) {
+            bits.back() = (uint64_t(1) << (count_ & 63)) - 1;
+        }
+    }
+
+    /**
+     * @brief Returns the number of selected elements.
+     */
+    size_t count() const
+    {
+        size_t c = 0;
+        for (auto w : bits) {
+            c += std::popcount(w);
+        }
+        return c;
+    }
+
+    /**
+     * @brief Returns the selection vector, i.e. the dense indices of the selected elements in increasing order.
+     */
+    std::vector<size_t> indices() const
+    {
+        std::vector<size_t> result;
+        result.reserve(count());
+        for (size_t w = 0; w < bits.size(); ++w) {
+            for (uint64_t word = bits[w]; word != 0; word &= word - 1) {
+                result.push_back(w * 64 + std::countr_zero(word));
+            }
+        }
+        return result;
+    }
+
+    selection_bitmap& operator&=(const selection_bitmap& other)
+    {
+        for (size_t w = 0; w < bits.size(); ++w) {
+            bits[w] &= other.bits[w];
+        }
+        return *this;
+    }
+
+    selection_bitmap& operator|=(const selection_bitmap& other)
+    {
+        for (size_t w = 0; w < bits.size(); ++w) {
+            bits[w] |= other.bits[w];
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Returns the words of the bitmap, bit i % 64 of the word i / 64 stands for the i-th element.
+     */
+    uint64_t* word_data()
+    {
+        return bits.data();
+    }
+
+    const uint64_t* word_data() const
+    {
+        return bits.data();
+    }
+
+    size_t word_count() const
+    {
+        return bits.size();
+    }
+
+private:
+    std::vector<uint64_t> bits;
+    size_t count_ = 0;
+};
+
+/**
+ * @brief The number of rows one task of a scan evaluates, it keeps a chunk of a 8-byte column within L2 cache.
+ * @note It is a multiple of 64 so that tasks never share a word of the result bitmap.
+ */
+inline constexpr size_t scan_chunk_rows = 16384;
+
+/**
+ * @brief Evaluates a predicate over the rows of the given columns in parallel.
+ * @param n The number of rows.
+ * @param pred A predicate called as pred(columns[i]...) for every row i.
+ * @param columns The only columns the scan touches.
+ * @return The bitmap of rows the predicate holds for.
+ */
+template<typename Predicate, typename ...Columns>
+selection_bitmap scan_columns(size_t n, const Predicate& pred, const Columns&... columns)
+{
+    selection_bitmap result(n);
+    uint64_t* words = result.word_data();
+    default_thread_pool().parallel_for(0, result.word_count(), scan_chunk_rows / 64, [&](size_t wb, size_t we) {
+        for (size_t w = wb; w < we; ++w) {
+            size_t base = w * 64;
+            size_t end = std::min(base + 64, n);
+            uint64_t word = 0;
+            for (size_t i = base; i < end; ++i) {
+                word |= uint64_t(static_cast<bool>(pred(column_get(columns, i)...))) << (i - base);
+            }
+            words[w] = word;
+        }
+    });
+    return result;
+}
+
+#endif // !SCAN_HPP
@@ -0,0 +1,890 @@
+#ifndef SIMD_KERNELS_HPP
+#define SIMD_KERNELS_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "scan.hpp"
+#include "thread_pool.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define GRAPH_DB_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define GRAPH_DB_TARGET(isa) __attribute__((target(isa)))
+#else
+#define GRAPH_DB_TARGET(isa)
+#endif
+
+/**
+ * @brief The instruction set a kernel runs with.
+ */
+enum class simd_level {
+    scalar,
+    avx2,
+    avx512,
+};
+
+/**
+ * @brief Detects the best instruction set the CPU and the OS support, once per process.
+ */
+inline simd_level detected_simd_level()
+{
+    static const simd_level level = []() {
+#if defined(GRAPH_DB_X86) && (defined(__GNUC__) || defined(__clang__))
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) {
+            return simd_level::avx512;
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            return simd_level::avx2;
+        }
+#elif defined(GRAPH_DB_X86) && defined(_MSC_VER)
+        int regs[4];
+        __cpuid(regs, 1);
+        bool osxsave = (regs[2] & (1 << 27)) != 0;
+        if (osxsave) {
+            unsigned long long xcr0 = _xgetbv(0);
+            __cpuidex(regs, 7, 0);
+            if ((xcr0 & 0xE6) == 0xE6 && (regs[1] & (1 << 16)) != 0) {
+                return simd_level::avx512;
+            }
+            if ((xcr0 & 0x6) == 0x6 && (regs[1] & (1 << 5)) != 0) {
+                return simd_level::avx2;
+            }
+        }
+#endif
+        return simd_level::scalar;
+    }();
+    return level;
+}
+
+/**
+ * @brief A comparison of a column value x with a constant v.
+ */
+enum class compare_op {
+    eq, ///< x == v
+    ne, ///< x != v
+    lt, ///< x < v
+    le, ///< x <= v
+    gt, ///< x > v
+    ge, ///< x >= v
+};
+
+/**
+ * @brief The result of aggregating an arithmetic column.
+ * @note Integers are summed in int64_t and floats in double. The result for NaNs is unspecified.
+ */
+template<typename T>
+struct column_aggregate {
+    using sum_t = std::conditional_t<std::is_integral_v<T>, int64_t, double>;
+
+    T min = std::numeric_limits<T>::max();
+    T max = std::numeric_limits<T>::lowest();
+    sum_t sum = 0;
+    size_t count = 0;
+
+    column_aggregate& operator+=(const column_aggregate& other)
+    {
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+        sum += other.sum;
+        count += other.count;
+        return *this;
+    }
+};
+
+template<typename T>
+concept simd_arithmetic = std::is_same_v<T, int> || std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+namespace simd_detail {
+
+template<compare_op Op, typename T>
+inline bool compare(T x, T v)
+{
+    if constexpr (Op == compare_op::eq) return x == v;
+    else if constexpr (Op == compare_op::ne) return x != v;
+    else if constexpr (Op == compare_op::lt) return x < v;
+    else if constexpr (Op == compare_op::le) return x <= v;
+    else if constexpr (Op == compare_op::gt) return x > v;
+    else return x >= v;
+}
+
+/**
+ * @brief A comparison of column values of type T with a constant of the same type, equivalent to one with another type.
+ */
+template<typename T>
+struct narrowed_compare {
+    compare_op op;
+    T value;
+    /**
+     * @brief Set if the comparison has the same result for every value of T, then op and value are meaningless.
+     */
+    std::optional<bool> constant;
+};
+
+/**
+ * @brief The comparison with a constant below every value of T, or above every one if not below.
+ */
+template<typename T>
+narrowed_compare<T> narrowed_outside(compare_op op, bool below)
+{
+    bool result = op == compare_op::ne || (below ? op == compare_op::gt || op == compare_op::ge
+        : op == compare_op::lt || op == compare_op::le);
+    return { op, T(), result };
+}
+
+/**
+ * @brief The comparison with a constant between the adjacent values down and up of T.
+ */
+template<typename T>
+narrowed_compare<T> narrowed_between(compare_op op, T down, T up)
+{
+    if (op == compare_op::eq || op == compare_op::ne) {
+        return { op, T(), op == compare_op::ne };
+    }
+    bool lower = op == compare_op::lt || op == compare_op::le;
+    return { lower ? compare_op::le : compare_op::ge, lower ? down : up, std::nullopt };
+}
+
+/**
+ * @brief Turns x op value, compared exactly rather than after converting value to T, into a comparison with a T.
+ * @note A constant between two values of T is rounded down for lt and le and up for gt and ge, one out of
+ * the range of T makes the result constant. Integer constants compared with floating-point columns are converted,
+ * as they would be by the built-in comparison.
+ */
+template<typename T, typename V>
+narrowed_compare<T> narrow_compare(compare_op op, V value)
+{
+    if constexpr (std::is_same_v<T, V> || (std::is_floating_point_v<T> && std::is_integral_v<V>)) {
+        return { op, static_cast<T>(value), std::nullopt };
+    }
+    else if constexpr (std::is_integral_v<T> && std::is_integral_v<V>) {
+        if (std::cmp_less(value, std::numeric_limits<T>::min())) {
+            return narrowed_outside<T>(op, true);
+        }
+        if (std::cmp_greater(value, std::numeric_limits<T>::max())) {
+            return narrowed_outside<T>(op, false);
+        }
+        return { op, static_cast<T>(value), std::nullopt };
+    }
+    else if constexpr (std::is_integral_v<T>) {
+        if (std::isnan(value)) {
+            return { op, T(), op == compare_op::ne };
+        }
+        // The minimum is a power of two and exact in V, the maximum may round up to the next one.
+        if (value < static_cast<V>(std::numeric_limits<T>::min())) {
+            return narrowed_outside<T>(op, true);
+        }
+        if (value > static_cast<V>(std::numeric_limits<T>::max())
+            || value >= static_cast<V>(std::numeric_limits<T>::max() / 2 + 1) * 2) {
+            return narrowed_outside<T>(op, false);
+        }
+        V down = std::floor(value);
+        if (down == value) {
+            return { op, static_cast<T>(value), std::nullopt };
+        }
+        return narrowed_between<T>(op, static_cast<T>(down), static_cast<T>(std::ceil(value)));
+    }
+    else {
+        if (std::isnan(value) || std::isinf(value)) {
+            return { op, static_cast<T>(value), std::nullopt };
+        }
+        if (value > std::numeric_limits<T>::max()) {
+            return narrowed_between<T>(op, std::numeric_limits<T>::max(), std::numeric_limits<T>::infinity());
+        }
+        if (value < std::numeric_limits<T>::lowest()) {
+            return narrowed_between<T>(op, -std::numeric_limits<T>::infinity(), std::numeric_limits<T>::lowest());
+        }
+        T t = static_cast<T>(value);
+        if (static_cast<V>(t) == value) {
+            return { op, t, std::nullopt };
+        }
+        if (t < value) {
+            return narrowed_between<T>(op, t, std::nextafter(t, std::numeric_limits<T>::infinity()));
+        }
+        return narrowed_between<T>(op, std::nextafter(t, -std::numeric_limits<T>::infinity()), t);
+    }
+}
+
+template<compare_op Op, typename T>
+inline uint64_t scalar_block(const T* p, size_t n, T v)
+{
+    uint64_t word = 0;
+    for (size_t i = 0; i < n; ++i) {
+        word |= uint64_t(compare<Op>(p[i], v)) << i;
+    }
+    return word;
+}
+
+template<typename T>
+inline void scalar_aggregate(const T* p, size_t n, column_aggregate<T>& acc)
+{
+    for (size_t i = 0; i < n; ++i) {
+        acc.min = std::min(acc.min, p[i]);
+        acc.max = std::max(acc.max, p[i]);
+        acc.sum += p[i];
+    }
+    acc.count += n;
+}
+
+/**
+ * @brief Intersects sorted arrays by merging, or by galloping through the longer one if their lengths differ a lot.
+ * @return The number of distinct common values, which are written to out if Write.
+ */
+template<bool Write>
+inline size_t scalar_intersect(const size_t* a, size_t na, const size_t* b, size_t nb, size_t* out)
+{
+    if (na > nb) {
+        std::swap(a, b);
+        std::swap(na, nb);
+    }
+    size_t count = 0;
+    if (na * 32 < nb) {
+        const size_t* first = b;
+        const size_t* last = b + nb;
+        for (size_t i = 0; i < na && first != last; ++i) {
+            if (i > 0 && a[i] == a[i - 1]) {
+                continue;
+            }
+            size_t step = 1;
+            while (step < static_cast<size_t>(last - first) && first[step] < a[i]) {
+                step *= 2;
+            }
+            first = std::lower_bound(first + step / 2, first + std::min(step + 1, static_cast<size_t>(last - first)), a[i]);
+            if (first != last && *first == a[i]) {
+                if constexpr (Write) {
+                    out[count] = a[i];
+                }
+                ++count;
+            }
+        }
+        return count;
+    }
+    size_t i = 0;
+    size_t j = 0;
+    while (i < na && j < nb) {
+        if (a[i] < b[j]) {
+            ++i;
+        }
+        else if (b[j] < a[i]) {
+            ++j;
+        }
+        else {
+            size_t x = a[i];
+            if constexpr (Write) {
+                out[count] = x;
+            }
+            ++count;
+            for (; i < na && a[i] == x; ++i) {
+            }
+            for (; j < nb && b[j] == x; ++j) {
+            }
+        }
+    }
+    return count;
+}
+
+#ifdef GRAPH_DB_X86
+
+// The immediates are variables rather than function calls, unoptimized builds only fold those into intrinsics.
+template<compare_op Op>
+inline constexpr int float_predicate =
+    Op == compare_op::eq ? _CMP_EQ_OQ :
+    Op == compare_op::ne ? _CMP_NEQ_UQ :
+    Op == compare_op::lt ? _CMP_LT_OQ :
+    Op == compare_op::le ? _CMP_LE_OQ :
+    Op == compare_op::gt ? _CMP_GT_OQ : _CMP_GE_OQ;
+
+template<compare_op Op>
+inline constexpr auto int_predicate =
+    Op == compare_op::eq ? _MM_CMPINT_EQ :
+    Op == compare_op::ne ? _MM_CMPINT_NE :
+    Op == compare_op::lt ? _MM_CMPINT_LT :
+    Op == compare_op::le ? _MM_CMPINT_LE :
+    Op == compare_op::gt ? _MM_CMPINT_NLE : _MM_CMPINT_NLT;
+
+template<compare_op Op>
+GRAPH_DB_TARGET("avx2") inline uint64_t avx2_block(const int* p, int v)
+{
+    __m256i vv = _mm256_set1_epi32(v);
+    uint64_t word = 0;
+    for (int k = 0; k < 8; ++k) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 8 * k));
+        __m256i m;
+        if constexpr (Op == compare_op::eq || Op == compare_op::ne) {
+            m = _mm256_cmpeq_epi32(x, vv);
+        }
+        else if constexpr (Op == compare_op::gt || Op == compare_op::le) {
+            m = _mm256_cmpgt_epi32(x, vv);
+        }
+        else {
+            m = _mm256_cmpgt_epi32(vv, x);
+        }
+        uint64_t bits = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(m)));
+        if constexpr (Op == compare_op::ne || Op == compare_op::le || Op == compare_op::ge) {
+            bits ^= 0xFF;
+        }
+        word |= bits << (8 * k);
+    }
+    return word;
+}
+
+template<compare_op Op>
+GRAPH_DB_TARGET("avx2") inline uint64_t avx2_block(const float* p, float v)
+{
+    __m256 vv = _mm256_set1_ps(v);
+    uint64_t word = 0;
+    for (int k = 0; k < 8; ++k) {
+        __m256 m = _mm256_cmp_ps(_mm256_loadu_ps(p + 8 * k), vv, float_predicate<Op>);
+        word |= uint64_t(static_cast<uint32_t>(_mm256_movemask_ps(m))) << (8 * k);
+    }
+    return word;
+}
+
+template<compare_op Op>
+GRAPH_DB_TARGET("avx2") inline uint64_t avx2_block(const double* p, double v)
+{
+    __m256d vv = _mm256_set1_pd(v);
+    uint64_t word = 0;
+    for (int k = 0; k < 16; ++k) {
+        __m256d m = _mm256_cmp_pd(_mm256_loadu_pd(p + 4 * k), vv, float_predicate<Op>);
+        word |= uint64_t(static_cast<uint32_t>(_mm256_movemask_pd(m))) << (4 * k);
+    }
+    return word;
+}
+
+template<compare_op Op>
+GRAPH_DB_TARGET("avx512f") inline uint64_t avx512_block(const int* p, int v)
+{
+    __m512i vv = _mm512_set1_epi32(v);
+    uint64_t word = 0;
+    for (int k = 0; k < 4; ++k) {
+        __m512i x = _mm512_loadu_si512(p + 16 * k);
+        word |= uint64_t(_mm512_cmp_epi32_mask(x, vv, int_predicate<Op>)) << (16 * k);
+    }
+    return word;
+}
+
+template<compare_op Op>
+GRAPH_DB_TARGET("avx512f") inline uint64_t avx512_block(const float* p, float v)
+{
+    __m512 vv = _mm512_set1_ps(v);
+    uint64_t word = 0;
+    for (int k = 0; k < 4; ++k) {
+        word |= uint64_t(_mm512_cmp_ps_mask(_mm512_loadu_ps(p + 16 * k), vv, float_predicate<Op>)) << (16 * k);
+    }
+    return word;
+}
+
+template<compare_op Op>
+GRAPH_DB_TARGET("avx512f") inline uint64_t avx512_block(const double* p, double v)
+{
+    __m512d vv = _mm512_set1_pd(v);
+    uint64_t word = 0;
+    for (int k = 0; k < 8; ++k) {
+        word |= uint64_t(_mm512_cmp_pd_mask(_mm512_loadu_pd(p + 8 * k), vv, float_predicate<Op>)) << (8 * k);
+    }
+    return word;
+}
+
+GRAPH_DB_TARGET("avx2") inline void avx2_aggregate(const int* p, size_t n, column_aggregate<int>& acc)
+{
+    size_t i = 0;
+    if (n >= 8) {
+        __m256i mn = _mm256_set1_epi32(acc.min);
+        __m256i mx = _mm256_set1_epi32(acc.max);
+        __m256i sum = _mm256_setzero_si256();
+        for (; i + 8 <= n; i += 8) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+            mn = _mm256_min_epi32(mn, x);
+            mx = _mm256_max_epi32(mx, x);
+            sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(x)));
+            sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(x, 1)));
+        }
+        alignas(32) int mins[8];
+        alignas(32) int maxs[8];
+        alignas(32) int64_t sums[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(mins), mn);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(maxs), mx);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(sums), sum);
+        for (int k = 0; k < 8; ++k) {
+            acc.min = std::min(acc.min, mins[k]);
+            acc.max = std::max(acc.max, maxs[k]);
+        }
+        acc.sum += sums[0] + sums[1] + sums[2] + sums[3];
+        acc.count += i;
+    }
+    scalar_aggregate(p + i, n - i, acc);
+}
+
+GRAPH_DB_TARGET("avx2") inline void avx2_aggregate(const float* p, size_t n, column_aggregate<float>& acc)
+{
+    size_t i = 0;
+    if (n >= 8) {
+        __m256 mn = _mm256_set1_ps(acc.min);
+        __m256 mx = _mm256_set1_ps(acc.max);
+        __m256d sum = _mm256_setzero_pd();
+        for (; i + 8 <= n; i += 8) {
+            __m256 x = _mm256_loadu_ps(p + i);
+            mn = _mm256_min_ps(mn, x);
+            mx = _mm256_max_ps(mx, x);
+            sum = _mm256_add_pd(sum, _mm256_cvtps_pd(_mm256_castps256_ps128(x)));
+            sum = _mm256_add_pd(sum, _mm256_cvtps_pd(_mm256_extractf128_ps(x, 1)));
+        }
+        alignas(32) float mins[8];
+        alignas(32) float maxs[8];
+        alignas(32) double sums[4];
+        _mm256_store_ps(mins, mn);
+        _mm256_store_ps(maxs, mx);
+        _mm256_store_pd(sums, sum);
+        for (int k = 0; k < 8; ++k) {
+            acc.min = std::min(acc.min, mins[k]);
+            acc.max = std::max(acc.max, maxs[k]);
+        }
+        acc.sum += sums[0] + sums[1] + sums[2] + sums[3];
+        acc.count += i;
+    }
+    scalar_aggregate(p + i, n - i, acc);
+}
+
+GRAPH_DB_TARGET("avx2") inline void avx2_aggregate(const double* p, size_t n, column_aggregate<double>& acc)
+{
+    size_t i = 0;
+    if (n >= 4) {
+        __m256d mn = _mm256_set1_pd(acc.min);
+        __m256d mx = _mm256_set1_pd(acc.max);
+        __m256d sum = _mm256_setzero_pd();
+        for (; i + 4 <= n; i += 4) {
+            __m256d x = _mm256_loadu_pd(p + i);
+            mn = _mm256_min_pd(mn, x);
+            mx = _mm256_max_pd(mx, x);
+            sum = _mm256_add_pd(sum, x);
+        }
+        alignas(32) double mins[4];
+        alignas(32) double maxs[4];
+        alignas(32) double sums[4];
+        _mm256_store_pd(mins, mn);
+        _mm256_store_pd(maxs, mx);
+        _mm256_store_pd(sums, sum);
+        for (int k = 0; k < 4; ++k) {
+            acc.min = std::min(acc.min, mins[k]);
+            acc.max = std::max(acc.max, maxs[k]);
+        }
+        acc.sum += sums[0] + sums[1] + sums[2] + sums[3];
+        acc.count += i;
+    }
+    scalar_aggregate(p + i, n - i, acc);
+}
+
+// GCC 12 implements the unmasked forms of many AVX-512 intrinsics with a self-initialized _mm512_undefined_*()
+// pass-through, which -Wmaybe-uninitialized reports wherever they are inlined. The kernels below use the
+// zero-masking forms with a full mask, which compile to the same instructions, extract halves instead of casting
+// and reduce the lanes in scalar code.
+constexpr __mmask8 avx512_all8 = 0xFF;
+constexpr __mmask16 avx512_all16 = 0xFFFF;
+
+GRAPH_DB_TARGET("avx512f") inline void avx512_aggregate(const int* p, size_t n, column_aggregate<int>& acc)
+{
+    size_t i = 0;
+    if (n >= 16) {
+        __m512i mn = _mm512_set1_epi32(acc.min);
+        __m512i mx = _mm512_set1_epi32(acc.max);
+        __m512i sum = _mm512_setzero_si512();
+        for (; i + 16 <= n; i += 16) {
+            __m512i x = _mm512_loadu_si512(p + i);
+            mn = _mm512_maskz_min_epi32(avx512_all16, mn, x);
+            mx = _mm512_maskz_max_epi32(avx512_all16, mx, x);
+            sum = _mm512_add_epi64(sum, _mm512_maskz_cvtepi32_epi64(avx512_all8, _mm512_maskz_extracti64x4_epi64(0xF, x, 0)));
+            sum = _mm512_add_epi64(sum, _mm512_maskz_cvtepi32_epi64(avx512_all8, _mm512_maskz_extracti64x4_epi64(0xF, x, 1)));
+        }
+        alignas(64) int mins[16];
+        alignas(64) int maxs[16];
+        alignas(64) int64_t sums[8];
+        _mm512_store_si512(mins, mn);
+        _mm512_store_si512(maxs, mx);
+        _mm512_store_si512(sums, sum);
+        for (int k = 0; k < 16; ++k) {
+            acc.min = std::min(acc.min, mins[k]);
+            acc.max = std::max(acc.max, maxs[k]);
+        }
+        for (int k = 0; k < 8; ++k) {
+            acc.sum += sums[k];
+        }
+        acc.count += i;
+    }
+    scalar_aggregate(p + i, n - i, acc);
+}
+
+GRAPH_DB_TARGET("avx512f") inline void avx512_aggregate(const float* p, size_t n, column_aggregate<float>& acc)
+{
+    size_t i = 0;
+    if (n >= 16) {
+        __m512 mn = _mm512_set1_ps(acc.min);
+        __m512 mx = _mm512_set1_ps(acc.max);
+        __m512d sum = _mm512_setzero_pd();
+        for (; i + 16 <= n; i += 16) {
+            __m512 x = _mm512_loadu_ps(p + i);
+            mn = _mm512_maskz_min_ps(avx512_all16, mn, x);
+            mx = _mm512_maskz_max_ps(avx512_all16, mx, x);
+            // The upper half is extracted as doubles, the float variant of the extraction needs AVX-512 DQ.
+            __m256 low = _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0xF, _mm512_castps_pd(x), 0));
+            __m256 high = _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0xF, _mm512_castps_pd(x), 1));
+            sum = _mm512_add_pd(sum, _mm512_maskz_cvtps_pd(avx512_all8, low));
+            sum = _mm512_add_pd(sum, _mm512_maskz_cvtps_pd(avx512_all8, high));
+        }
+        alignas(64) float mins[16];
+        alignas(64) float maxs[16];
+        alignas(64) double sums[8];
+        _mm512_store_ps(mins, mn);
+        _mm512_store_ps(maxs, mx);
+        _mm512_store_pd(sums, sum);
+        for (int k = 0; k < 16; ++k) {
+            acc.min = std::min(acc.min, mins[k]);
+            acc.max = std::max(acc.max, maxs[k]);
+        }
+        for (int k = 0; k < 8; ++k) {
+            acc.sum += sums[k];
+        }
+        acc.count += i;
+    }
+    scalar_aggregate(p + i, n - i, acc);
+}
+
+GRAPH_DB_TARGET("avx512f") inline void avx512_aggregate(const double* p, size_t n, column_aggregate<double>& acc)
+{
+    size_t i = 0;
+    if (n >= 8) {
+        __m512d mn = _mm512_set1_pd(acc.min);
+        __m512d mx = _mm512_set1_pd(acc.max);
+        __m512d sum = _mm512_setzero_pd();
+        for (; i + 8 <= n; i += 8) {
+            __m512d x = _mm512_loadu_pd(p + i);
+            mn = _mm512_maskz_min_pd(avx512_all8, mn, x);
+            mx = _mm512_maskz_max_pd(avx512_all8, mx, x);
+            sum = _mm512_add_pd(sum, x);
+        }
+        alignas(64) double mins[8];
+        alignas(64) double maxs[8];
+        alignas(64) double sums[8];
+        _mm512_store_pd(mins, mn);
+        _mm512_store_pd(maxs, mx);
+        _mm512_store_pd(sums, sum);
+        for (int k = 0; k < 8; ++k) {
+            acc.min = std::min(acc.min, mins[k]);
+            acc.max = std::max(acc.max, maxs[k]);
+            acc.sum += sums[k];
+        }
+        acc.count += i;
+    }
+    scalar_aggregate(p + i, n - i, acc);
+}
+
+/**
+ * @brief Intersects blocks of 4 values of both arrays, each value of a block of a is compared with all rotations
+ * of the block of b, then the block with the lower maximum is left behind.
+ * @note Matches come out in increasing order, a lane repeating the lane before it or the last match is dropped.
+ */
+template<bool Write>
+GRAPH_DB_TARGET("avx2") inline size_t avx2_intersect(const size_t* a, size_t na, const size_t* b, size_t nb, size_t* out)
+{
+    size_t i = 0;
+    size_t j = 0;
+    size_t count = 0;
+    size_t last = 0;
+    while (i + 4 <= na && j + 4 <= nb) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + j));
+        __m256i m = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi64(va, vb), _mm256_cmpeq_epi64(va, _mm256_permute4x64_epi64(vb, 0x39))),
+            _mm256_or_si256(_mm256_cmpeq_epi64(va, _mm256_permute4x64_epi64(vb, 0x4E)),
+                _mm256_cmpeq_epi64(va, _mm256_permute4x64_epi64(vb, 0x93))));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(m)));
+        __m256i repeated = _mm256_cmpeq_epi64(va, _mm256_permute4x64_epi64(va, 0x93));
+        mask &= ~static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(repeated))) | 1u;
+        if (mask != 0 && count != 0 && a[i + std::countr_zero(mask)] == last) {
+            mask &= mask - 1;
+        }
+        if (mask != 0) {
+            last = a[i + 31 - std::countl_zero(mask)];
+        }
+        if constexpr (Write) {
+            for (; mask != 0; mask &= mask - 1) {
+                out[count++] = a[i + std::countr_zero(mask)];
+            }
+        }
+        else {
+            count += std::popcount(mask);
+        }
+        size_t a_max = a[i + 3];
+        size_t b_max = b[j + 3];
+        i += a_max <= b_max ? 4 : 0;
+        j += b_max <= a_max ? 4 : 0;
+    }
+    // The rest only matches values from the last match on.
+    for (; count != 0 && i < na && a[i] <= last; ++i) {
+    }
+    return count + scalar_intersect<Write>(a + i, na - i, b + j, nb - j, out + (Write ? count : 0));
+}
+
+/**
+ * @brief Intersects blocks of 8 values like avx2_intersect, matches are written with a compressing store.
+ */
+template<bool Write>
+GRAPH_DB_TARGET("avx512f") inline size_t avx512_intersect(const size_t* a, size_t na, const size_t* b, size_t nb, size_t* out)
+{
+    size_t i = 0;
+    size_t j = 0;
+    size_t count = 0;
+    size_t last = 0;
+    while (i + 8 <= na && j + 8 <= nb) {
+        __m512i va = _mm512_loadu_si512(a + i);
+        __m512i vb = _mm512_loadu_si512(b + j);
+        __mmask8 mask = _mm512_cmpeq_epi64_mask(va, vb);
+        mask |= _mm512_cmpeq_epi64_mask(va, _mm512_maskz_alignr_epi64(avx512_all8, vb, vb, 1));
+        mask |= _mm512_cmpeq_epi64_mask(va, _mm512_maskz_alignr_epi64(avx512_all8, vb, vb, 2));
+        mask |= _mm512_cmpeq_epi64_mask(va, _mm512_maskz_alignr_epi64(avx512_all8, vb, vb, 3));
+        mask |= _mm512_cmpeq_epi64_mask(va, _mm512_maskz_alignr_epi64(avx512_all8, vb, vb, 4));
+        mask |= _mm512_cmpeq_epi64_mask(va, _mm512_maskz_alignr_epi64(avx512_all8, vb, vb, 5));
+        mask |= _mm512_cmpeq_epi64_mask(va, _mm512_maskz_alignr_epi64(avx512_all8, vb, vb, 6));
+        mask |= _mm512_cmpeq_epi64_mask(va, _mm512_maskz_alignr_epi64(avx512_all8, vb, vb, 7));
+        mask &= static_cast<__mmask8>(~_mm512_cmpeq_epi64_mask(va, _mm512_maskz_alignr_epi64(avx512_all8, va, va, 7)) | 1u);
+        if (mask != 0 && count != 0 && a[i + std::countr_zero(static_cast<unsigned>(mask))] == last) {
+            mask &= static_cast<__mmask8>(mask - 1);
+        }
+        if (mask != 0) {
+            last = a[i + 31 - std::countl_zero(static_cast<unsigned>(mask))];
+        }
+        if constexpr (Write) {
+            _mm512_mask_compressstoreu_epi64(out + count, mask, va);
+        }
+        count += std::popcount(static_cast<unsigned>(mask));
+        size_t a_max = a[i + 7];
+        size_t b_max = b[j + 7];
+        i += a_max <= b_max ? 8 : 0;
+        j += b_max <= a_max ? 8 : 0;
+    }
+    for (; count != 0 && i < na && a[i] <= last; ++i) {
+    }
+    return count + scalar_intersect<Write>(a + i, na - i, b + j, nb - j, out + (Write ? count : 0));
+}
+
+#endif // GRAPH_DB_X86
+
+template<bool Write>
+inline size_t intersect(const size_t* a, size_t na, const size_t* b, size_t nb, size_t* out, simd_level level)
+{
+#ifdef GRAPH_DB_X86
+    // Blocks only pay off while both arrays are of comparable length, galloping is better otherwise.
+    if constexpr (sizeof(size_t) == 8) {
+        if (std::min(na, nb) * 32 >= std::max(na, nb)) {
+            if (level == simd_level::avx512) {
+                return avx512_intersect<Write>(a, na, b, nb, out);
+            }
+            if (level == simd_level::avx2) {
+                return avx2_intersect<Write>(a, na, b, nb, out);
+            }
+        }
+    }
+#endif
+    return scalar_intersect<Write>(a, na, b, nb, out);
+}
+
+template<compare_op Op, typename T>
+inline void compare_words(const T* p, size_t n, T v, uint64_t* words, simd_level level)
+{
+    size_t full = n / 64;
+#ifdef GRAPH_DB_X86
+    if (level == simd_level::avx512) {
+        for (size_t w = 0; w < full; ++w) {
+            words[w] = avx512_block<Op>(p + w * 64, v);
+        }
+    }
+    else if (level == simd_level::avx2) {
+        for (size_t w = 0; w < full; ++w) {
+            words[w] = avx2_block<Op>(p + w * 64, v);
+        }
+    }
+    else
+#endif
+    {
+        for (size_t w = 0; w < full; ++w) {
+            words[w] = scalar_block<Op>(p + w * 64, 64, v);
+        }
+    }
+    if (n % 64 != 0) {
+        words[full] = scalar_block<Op>(p + full * 64, n % 64, v);
+    }
+}
+
+template<typename T, typename F>
+inline void dispatch_op(compare_op op, F&& f)
+{
+    switch (op) {
+    case compare_op::eq: f.template operator()<compare_op::eq>(); break;
+    case compare_op::ne: f.template operator()<compare_op::ne>(); break;
+    case compare_op::lt: f.template operator()<compare_op::lt>(); break;
+    case compare_op::le: f.template operator()<compare_op::le>(); break;
+    case compare_op::gt: f.template operator()<compare_op::gt>(); break;
+    case compare_op::ge: f.template operator()<compare_op::ge>(); break;
+    }
+}
+
+} // namespace simd_detail
+
+/**
+ * @brief Compares every value of an array with a constant and writes the results as a bitmask.
+ * @param data The values.
+ * @param n The number of values.
+ * @param words The output, (n + 63) / 64 words, bit i % 64 of the word i / 64 is the result for data[i].
+ * @param level The instruction set to use, the best supported one by default.
+ */
+template<simd_arithmetic T>
+void simd_compare(const T* data, size_t n, compare_op op, T value, uint64_t* words, simd_level level = detected_simd_level())
+{
+    simd_detail::dispatch_op<T>(op, [&]<compare_op Op>() {
+        simd_detail::compare_words<Op>(data, n, value, words, level);
+    });
+}
+
+/**
+ * @brief Checks lo <= x && x <= hi for every value x of an array and writes the results as a bitmask.
+ * @see simd_compare
+ */
+template<simd_arithmetic T>
+void simd_range(const T* data, size_t n, T lo, T hi, uint64_t* words, simd_level level = detected_simd_level())
+{
+    // Processed in blocks that stay in L1 between the two passes.
+    constexpr size_t block = 4096;
+    uint64_t upper[block / 64];
+    for (size_t b = 0; b < n; b += block) {
+        size_t len = std::min(block, n - b);
+        simd_detail::compare_words<compare_op::ge>(data + b, len, lo, words + b / 64, level);
+        simd_detail::compare_words<compare_op::le>(data + b, len, hi, upper, level);
+        for (size_t w = 0; w < (len + 63) / 64; ++w) {
+            words[b / 64 + w] &= upper[w];
+        }
+    }
+}
+
+/**
+ * @brief Computes the minimum, maximum, sum and count of an array.
+ */
+template<simd_arithmetic T>
+column_aggregate<T> simd_aggregate(const T* data, size_t n, simd_level level = detected_simd_level())
+{
+    column_aggregate<T> acc;
+#ifdef GRAPH_DB_X86
+    if (level == simd_level::avx512) {
+        simd_detail::avx512_aggregate(data, n, acc);
+        return acc;
+    }
+    if (level == simd_level::avx2) {
+        simd_detail::avx2_aggregate(data, n, acc);
+        return acc;
+    }
+#endif
+    simd_detail::scalar_aggregate(data, n, acc);
+    return acc;
+}
+
+/**
+ * @brief Writes the values two sorted arrays have in common to out, in increasing order.
+ * @param out The output, room for min(na, nb) values.
+ * @return The number of common values.
+ * @note Repeated values are allowed, every common value is reported exactly once.
+ */
+inline size_t simd_intersect(const size_t* a, size_t na, const size_t* b, size_t nb, size_t* out,
+    simd_level level = detected_simd_level())
+{
+    return simd_detail::intersect<true>(a, na, b, nb, out, level);
+}
+
+/**
+ * @brief Counts the distinct values two sorted arrays have in common.
+ * @see simd_intersect
+ */
+inline size_t simd_intersect_count(const size_t* a, size_t na, const size_t* b, size_t nb,
+    simd_level level = detected_simd_level())
+{
+    return simd_detail::intersect<false>(a, na, b, nb, nullptr, level);
+}
+
+/**
+ * @brief Compares a whole contiguous or segmented column with a constant in parallel chunks.
+ * @return The bitmap of rows for which the comparison holds.
+ */
+template<typename Column, typename V>
+selection_bitmap filter_column(const Column& column, compare_op op, const V& value)
+{
+    using T = typename Column::value_type;
+    selection_bitmap result(column.size());
+    auto compare = simd_detail::narrow_compare<T>(op, value);
+    if (compare.constant) {
+        if (*compare.constant) {
+            result.set_all();
+        }
+        return result;
+    }
+    default_thread_pool().parallel_for(0, column.size(), scan_chunk_rows, [&](size_t b, size_t e) {
+        simd_compare<T>(column_block(column, b), e - b, compare.op, compare.value, result.word_data() + b / 64);
+    });
+    return result;
+}
+
+/**
+ * @brief Checks lo <= x && x <= hi over a whole contiguous or segmented column in parallel chunks.
+ * @return The bitmap of rows within the range.
+ */
+template<typename Column, typename V>
+selection_bitmap filter_column_range(const Column& column, const V& lo, const V& hi)
+{
+    using T = typename Column::value_type;
+    selection_bitmap result(column.size());
+    auto lower = simd_detail::narrow_compare<T>(compare_op::ge, lo);
+    auto upper = simd_detail::narrow_compare<T>(compare_op::le, hi);
+    if (lower.constant == false || upper.constant == false) {
+        return result;
+    }
+    // Only integer columns have bounds which hold for every value, the whole range of T stands for them.
+    T low = lower.constant ? std::numeric_limits<T>::lowest() : lower.value;
+    T high = upper.constant ? std::numeric_limits<T>::max() : upper.value;
+    default_thread_pool().parallel_for(0, column.size(), scan_chunk_rows, [&](size_t b, size_t e) {
+        simd_range<T>(column_block(column, b), e - b, low, high, result.word_data() + b / 64);
+    });
+    return result;
+}
+
+/**
+ * @brief Aggregates a whole contiguous or segmented column in parallel chunks.
+ */
+template<typename Column>
+column_aggregate<typename Column::value_type> aggregate_column(const Column& column)
+{
+    using T = typename Column::value_type;
+    size_t chunks = (column.size() + scan_chunk_rows - 1) / scan_chunk_rows;
+    std::vector<column_aggregate<T>> partial(chunks);
+    default_thread_pool().parallel_for(0, column.size(), scan_chunk_rows, [&](size_t b, size_t e) {
+        partial[b / scan_chunk_rows] = simd_aggregate<T>(column_block(column, b), e - b);
+    });
+    column_aggregate<T> result;
+    for (auto&& p : partial) {
+        result += p;
+    }
+    return result;
+}
+
+#endif // !SIMD_KERNELS_HPP
@@ -0,0 +1,588 @@
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief A read-only memory mapping of a whole file.
+ */
+class mapped_file {
+public:
+    /**
+     * @brief Maps the file into memory.
+     * @throws std::runtime_error If the file cannot be opened or mapped.
+     */
+    explicit mapped_file(const std::string& path)
+    {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("mapped_file: cannot open " + path);
+        }
+        LARGE_INTEGER file_size;
+        GetFileSizeEx(file, &file_size);
+        length = static_cast<size_t>(file_size.QuadPart);
+        if (length > 0) {
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping != nullptr) {
+                bytes = static_cast<const std::byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            }
+            if (bytes == nullptr) {
+                close();
+                throw std::runtime_error("mapped_file: cannot map " + path);
+            }
+        }
+#else
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("mapped_file: cannot open " + path);
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close();
+            throw std::runtime_error("mapped_file: cannot stat " + path);
+        }
+        length = static_cast<size_t>(st.st_size);
+        if (length > 0) {
+            void* p = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+            if (p == MAP_FAILED) {
+                close();
+                throw std::runtime_error("mapped_file: cannot map " + path);
+            }
+            bytes = static_cast<const std::byte*>(p);
+            madvise(p, length, MADV_SEQUENTIAL);
+        }
+#endif
+    }
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    ~mapped_file()
+    {
+        close();
+    }
+
+    /**
+     * @brief Returns the first byte of the mapping.
+     */
+    const std::byte* data() const
+    {
+        return bytes;
+    }
+
+    /**
+     * @brief Returns the length of the file in bytes.
+     */
+    size_t size() const
+    {
+        return length;
+    }
+
+    /**
+     * @brief Drops the sequential read-ahead hint for the pages of a range that stays in use after loading.
+     */
+    void advise_random_access(const std::byte* p, size_t n) const
+    {
+#ifndef _WIN32
+        if (n == 0) {
+            return;
+        }
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t first = static_cast<size_t>(p - bytes) / page * page;
+        madvise(const_cast<std::byte*>(bytes) + first, static_cast<size_t>(p - bytes) + n - first, MADV_NORMAL);
+#else
+        (void)p;
+        (void)n;
+#endif
+    }
+
+private:
+    void close()
+    {
+#ifdef _WIN32
+        if (bytes != nullptr) {
+            UnmapViewOfFile(bytes);
+        }
+        if (mapping != nullptr) {
+            CloseHandle(mapping);
+        }
+        if (file != INVALID_HANDLE_VALUE) {
+            CloseHandle(file);
+        }
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (bytes != nullptr) {
+            munmap(const_cast<std::byte*>(bytes), length);
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        fd = -1;
+#endif
+        bytes = nullptr;
+    }
+
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#else
+    int fd = -1;
+#endif
+    const std::byte* bytes = nullptr;
+    size_t length = 0;
+};
+
+/**
+ * @brief A column of plain values which can be a read-only view of a mapped snapshot file.
+ * @note snapshot_reader maps the column instead of copying it, the mapping is kept alive by the column and its copies.
+ * Processes which load the same snapshot then share its pages in the page cache. The values are copied into
+ * an owned array on the first modification, reads never modify the column.
+ * @see mapped_column_t
+ */
+template<typename T>
+class mapped_column {
+    static_assert(std::is_trivially_copyable_v<T> && !std::is_same_v<T, bool>, "mapped_column: unsupported value type");
+public:
+    using value_type = T;
+
+    /**
+     * @brief Makes the column a view of n values stored in a mapped file.
+     */
+    void map(std::shared_ptr<const mapped_file> file, const T* values, size_t n)
+    {
+        owned = std::vector<T>();
+        mapping = std::move(file);
+        view = values;
+        count = n;
+    }
+
+    /**
+     * @brief Checks whether the column still is a view of a mapped file.
+     */
+    bool is_mapped() const
+    {
+        return mapping != nullptr;
+    }
+
+    T operator[](size_t i) const
+    {
+        return data()[i];
+    }
+
+    const T* data() const
+    {
+        return mapping ? view : owned.data();
+    }
+
+    void set(size_t i, const T& value)
+    {
+        own();
+        owned[i] = value;
+    }
+
+    void emplace_back()
+    {
+        own();
+        owned.emplace_back();
+    }
+
+    template<typename V>
+    void emplace_back(V&& value)
+    {
+        own();
+        owned.emplace_back(std::forward<V>(value));
+    }
+
+    void push_back(const T& value)
+    {
+        emplace_back(value);
+    }
+
+    void reserve(size_t n)
+    {
+        own();
+        owned.reserve(n);
+    }
+
+    void resize(size_t n)
+    {
+        own();
+        owned.resize(n);
+    }
+
+    void clear()
+    {
+        mapping.reset();
+        view = nullptr;
+        owned.clear();
+    }
+
+    size_t size() const
+    {
+        return mapping ? count : owned.size();
+    }
+
+    size_t capacity() const
+    {
+        return mapping ? count : owned.capacity();
+    }
+
+private:
+    void own()
+    {
+        if (mapping) {
+            owned.assign(view, view + count);
+            mapping.reset();
+            view = nullptr;
+        }
+    }
+
+    std::shared_ptr<const mapped_file> mapping;
+    const T* view = nullptr;
+    size_t count = 0;
+    std::vector<T> owned;
+};
+
+/**
+ * @brief Selects a mapped_column for the properties it can hold and a std::vector for the others.
+ * @note A schema declares template<typename T> using column_t = mapped_column_t<T> to have graph_db::open_mmap
+ * load its trivially copyable property columns zero-copy.
+ */
+template<typename T>
+using mapped_column_t = std::conditional_t<std::is_trivially_copyable_v<T> && !std::is_same_v<T, bool>,
+    mapped_column<T>, std::vector<T>>;
+
+/**
+ * @brief Checks whether a column element is stored as a string, i.e. it is a std::string with any allocator.
+ */
+template<typename T>
+inline constexpr bool is_snapshot_string_v = false;
+template<typename Alloc>
+inline constexpr bool is_snapshot_string_v<std::basic_string<char, std::char_traits<char>, Alloc>> = true;
+
+/**
+ * @brief The on-disk layout of graph_db snapshots.
+ * @note The file is a header followed by columns, every column header and payload starts at a multiple of alignment.
+ * @note Trivially copyable columns (contiguous or segmented) are stored as raw arrays, bool as one byte per element
+ * and strings (std::string with any allocator) as an array of count + 1 offsets followed by the concatenated characters.
+ */
+struct snapshot_format {
+    static constexpr char magic[8] = { 'G', 'R', 'A', 'P', 'H', 'D', 'B', '\0' };
+    static constexpr uint32_t version = 1;
+    static constexpr uint32_t byte_order = 0x01020304;
+    static constexpr size_t alignment = 64;
+
+    /**
+     * @brief The header flag of files in which the dense index of every vertex by its insertion rank follows
+     * the adjacency, see graph_db::reorder.
+     */
+    static constexpr uint64_t insertion_order = 1;
+
+    enum column_kind : uint32_t {
+        trivial = 1,
+        boolean = 2,
+        string = 3,
+    };
+
+    struct header {
+        char magic[8];
+        uint32_t version;
+        uint32_t byte_order;
+        uint64_t vertex_count;
+        uint64_t edge_count;
+        uint32_t vertex_columns;
+        uint32_t edge_columns;
+        uint64_t flags;
+        /**
+         * @brief The sequence number of the last write-ahead log record the snapshot holds, see graph_db::checkpoint.
+         */
+        uint64_t log_sequence;
+        uint64_t reserved;
+    };
+
+    struct column_header {
+        uint32_t kind;
+        uint32_t element_size;
+        uint64_t count;
+        uint64_t payload_size;
+        uint64_t reserved;
+    };
+
+    template<typename T>
+    static constexpr uint32_t kind_of()
+    {
+        if constexpr (std::is_same_v<T, bool>) {
+            return boolean;
+        }
+        else if constexpr (is_snapshot_string_v<T>) {
+            return string;
+        }
+        else {
+            static_assert(std::is_trivially_copyable_v<T>, "snapshot: unsupported column type");
+            return trivial;
+        }
+    }
+};
+
+/**
+ * @brief Writes a snapshot file column by column.
+ */
+class snapshot_writer {
+public:
+    /**
+     * @throws std::runtime_error If the file cannot be created.
+     */
+    explicit snapshot_writer(const std::string& path) : out(path, std::ios::binary | std::ios::trunc)
+    {
+        if (!out) {
+            throw std::runtime_error("snapshot: cannot create " + path);
+        }
+    }
+
+    void write_header(uint64_t vertex_count, uint64_t edge_count, uint32_t vertex_columns, uint32_t edge_columns,
+        uint64_t flags = 0, uint64_t log_sequence = 0)
+    {
+        snapshot_format::header h{};
+        std::memcpy(h.magic, snapshot_format::magic, sizeof(h.magic));
+        h.version = snapshot_format::version;
+        h.byte_order = snapshot_format::byte_order;
+        h.vertex_count = vertex_count;
+        h.edge_count = edge_count;
+        h.vertex_columns = vertex_columns;
+        h.edge_columns = edge_columns;
+        h.flags = flags;
+        h.log_sequence = log_sequence;
+        write_raw(&h, sizeof(h));
+    }
+
+    template<typename Column>
+    void write_column(const Column& column)
+    {
+        using T = typename Column::value_type;
+        snapshot_format::column_header h{};
+        h.kind = snapshot_format::kind_of<T>();
+        h.element_size = sizeof(T);
+        h.count = column.size();
+
+        if constexpr (std::is_same_v<T, bool>) {
+            std::vector<uint8_t> bytes(column.size());
+            for (size_t i = 0; i < column.size(); ++i) {
+                bytes[i] = column[i];
+            }
+            h.payload_size = bytes.size();
+            write_section(h, bytes.data());
+        }
+        else if constexpr (is_snapshot_string_v<T>) {
+            std::vector<uint64_t> offsets(column.size() + 1, 0);
+            for (size_t i = 0; i < column.size(); ++i) {
+                offsets[i + 1] = offsets[i] + column[i].size();
+            }
+            h.payload_size = offsets.size() * sizeof(uint64_t) + offsets.back();
+            write_section(h, offsets.data(), offsets.size() * sizeof(uint64_t));
+            for (size_t i = 0; i < column.size(); ++i) {
+                write_raw(column[i].data(), column[i].size());
+            }
+        }
+        else {
+            h.payload_size = column.size() * sizeof(T);
+            if constexpr (requires { column.data(); }) {
+                write_section(h, column.data());
+            }
+            else {
+                write_section(h, nullptr, 0);
+                for (size_t b = 0; b < column.size(); b += Column::segment_size) {
+                    write_raw(&column[b], std::min(Column::segment_size, column.size() - b) * sizeof(T));
+                }
+            }
+        }
+    }
+
+    /**
+     * @throws std::runtime_error If anything failed to be written.
+     */
+    void finish()
+    {
+        out.flush();
+        if (!out) {
+            throw std::runtime_error("snapshot: write failed");
+        }
+    }
+
+private:
+    void write_section(const snapshot_format::column_header& h, const void* payload)
+    {
+        write_section(h, payload, h.payload_size);
+    }
+
+    void write_section(const snapshot_format::column_header& h, const void* payload, size_t payload_size)
+    {
+        pad();
+        write_raw(&h, sizeof(h));
+        pad();
+        write_raw(payload, payload_size);
+    }
+
+    void pad()
+    {
+        static const char zeros[snapshot_format::alignment] = {};
+        size_t rem = position % snapshot_format::alignment;
+        if (rem != 0) {
+            write_raw(zeros, snapshot_format::alignment - rem);
+        }
+    }
+
+    void write_raw(const void* p, size_t n)
+    {
+        out.write(static_cast<const char*>(p), static_cast<std::streamsize>(n));
+        position += n;
+    }
+
+    std::ofstream out;
+    size_t position = 0;
+};
+
+/**
+ * @brief Reads a snapshot file column by column from a read-only memory mapping.
+ * @note mapped_column columns become views of the mapped pages, other trivially copyable columns are bulk-copied
+ * out of them. Every column is validated, so a corrupted file throws rather than being read out of bounds.
+ */
+class snapshot_reader {
+public:
+    explicit snapshot_reader(const std::string& path) : file(std::make_shared<const mapped_file>(path)) {}
+
+    /**
+     * @brief Reads and validates the header.
+     * @throws std::runtime_error If the file is not a snapshot of the expected version and schema.
+     */
+    const snapshot_format::header& read_header(uint32_t vertex_columns, uint32_t edge_columns)
+    {
+        const auto* h = reinterpret_cast<const snapshot_format::header*>(take(sizeof(snapshot_format::header)));
+        if (std::memcmp(h->magic, snapshot_format::magic, sizeof(h->magic)) != 0) {
+            throw std::runtime_error("snapshot: not a graph_db snapshot");
+        }
+        if (h->version != snapshot_format::version || h->byte_order != snapshot_format::byte_order) {
+            throw std::runtime_error("snapshot: unsupported version or byte order");
+        }
+        if (h->vertex_columns != vertex_columns || h->edge_columns != edge_columns) {
+            throw std::runtime_error("snapshot: schema mismatch");
+        }
+        return *h;
+    }
+
+    /**
+     * @throws std::runtime_error If the column does not match the expected type or the file is truncated.
+     */
+    template<typename Column>
+    void read_column(Column& column, uint64_t expected_count)
+    {
+        using T = typename Column::value_type;
+        align();
+        const auto* h = reinterpret_cast<const snapshot_format::column_header*>(take(sizeof(snapshot_format::column_header)));
+        if (h->kind != snapshot_format::kind_of<T>() || h->element_size != sizeof(T) || h->count != expected_count) {
+            throw std::runtime_error("snapshot: schema mismatch");
+        }
+        align();
+        const std::byte* payload = take(h->payload_size);
+        size_t n = static_cast<size_t>(h->count);
+
+        if constexpr (std::is_same_v<T, bool>) {
+            if (h->payload_size != n) {
+                throw std::runtime_error("snapshot: corrupted column");
+            }
+            const auto* bytes = reinterpret_cast<const uint8_t*>(payload);
+            column.clear();
+            column.reserve(n);
+            for (size_t i = 0; i < n; ++i) {
+                column.emplace_back(bytes[i] != 0);
+            }
+        }
+        else if constexpr (is_snapshot_string_v<T>) {
+            if (n >= h->payload_size / sizeof(uint64_t)) {
+                throw std::runtime_error("snapshot: truncated file");
+            }
+            const auto* offsets = reinterpret_cast<const uint64_t*>(payload);
+            const char* blob = reinterpret_cast<const char*>(payload + (n + 1) * sizeof(uint64_t));
+            // Increasing offsets which end at the end of the blob keep every string within it.
+            if (offsets[0] != 0 || offsets[n] != h->payload_size - (n + 1) * sizeof(uint64_t)) {
+                throw std::runtime_error("snapshot: corrupted string column");
+            }
+            for (size_t i = 0; i < n; ++i) {
+                if (offsets[i] > offsets[i + 1]) {
+                    throw std::runtime_error("snapshot: corrupted string column");
+                }
+            }
+            column.clear();
+            column.reserve(n);
+            for (size_t i = 0; i < n; ++i) {
+                column.emplace_back(std::string_view(blob + offsets[i], offsets[i + 1] - offsets[i]));
+            }
+        }
+        else {
+            if (h->payload_size % sizeof(T) != 0 || h->payload_size / sizeof(T) != n) {
+                throw std::runtime_error("snapshot: corrupted column");
+            }
+            if constexpr (requires { column.map(file, static_cast<const T*>(nullptr), n); }) {
+                file->advise_random_access(payload, h->payload_size);
+                column.map(file, reinterpret_cast<const T*>(payload), n);
+            }
+            else if constexpr (requires { column.data(); }) {
+                column.resize(n);
+                std::memcpy(column.data(), payload, n * sizeof(T));
+            }
+            else {
+                column.resize(n);
+                for (size_t b = 0; b < n; b += Column::segment_size) {
+                    std::memcpy(&column[b], payload + b * sizeof(T), std::min(Column::segment_size, n - b) * sizeof(T));
+                }
+            }
+        }
+    }
+
+private:
+    const std::byte* take(uint64_t n)
+    {
+        if (n > file->size() - position) {
+            throw std::runtime_error("snapshot: truncated file");
+        }
+        const std::byte* p = file->data() + position;
+        position += static_cast<size_t>(n);
+        return p;
+    }
+
+    void align()
+    {
+        size_t rem = position % snapshot_format::alignment;
+        if (rem != 0) {
+            take(snapshot_format::alignment - rem);
+        }
+    }
+
+    std::shared_ptr<const mapped_file> file;
+    size_t position = 0;
+};
+
+#endif // !SNAPSHOT_HPP
@@ -9,7 +9,27 @@
 #include <iostream>
 #include <string>
 #include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <memory_resource>
+#include <thread>
+#include <atomic>
+#include <limits>
+#include <cmath>
+#include <span>
+#include <iterator>
+#include <random>
 #include "graph_db.hpp"
+#include "analytics.hpp"
+#include "traversal.hpp"
+#include "concurrent.hpp"
+#include "csv_import.hpp"
+#include "wal.hpp"
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 template<typename ... T>
 inline void spoil(T&&...)
@@ -259,6 +279,8 @@ class test_bench {
         auto e12 = gdb.add_edge("e12", v1, v2);
 
         static_assert(std::is_same_v<decltype(v1), typename gdb_t::vertex_t>, "Wrong vertex type from add_vertex()");
+        static_assert(std::is_trivially_copyable_v<typename gdb_t::vertex_t>, "Vertex should be a handle");
+        static_assert(std::is_trivially_copyable_v<typename gdb_t::edge_t>, "Edge should be a handle");
         static_assert(std::is_same_v<std::decay_t<decltype(
 #ifdef PAIR_INTERFACE
             * v1.edges().first
@@ -288,6 +310,28 @@ class test_bench {
         static_assert(std::is_same_v<decltype(e12.src()), typename gdb_t::vertex_t>, "Wrong vertex type from src()");
         static_assert(std::is_same_v<decltype(e12.dst()), typename gdb_t::vertex_t>, "Wrong vertex type from dst()");
 
+        // A const database hands out const handles, their setters do not compile.
+        const gdb_t& reader = gdb;
+        using const_vertex_t = typename gdb_t::const_vertex_t;
+        using const_edge_t = typename gdb_t::const_edge_t;
+        static_assert(std::is_trivially_copyable_v<const_vertex_t> && std::is_trivially_copyable_v<const_edge_t>);
+        static_assert(std::is_same_v<decltype(*reader.get_vertexes().begin()), const_vertex_t>);
+        static_assert(std::is_same_v<decltype(*reader.get_edges().begin()), const_edge_t>);
+        static_assert(std::is_same_v<decltype(reader.find_vertex("v1")), std::optional<const_vertex_t>>);
+        static_assert(std::is_same_v<decltype(reader.edge_at(0).src()), const_vertex_t>);
+        static_assert(std::is_same_v<decltype(*reader.vertex_at(0).edges().begin()), const_edge_t>);
+        auto settable = [](auto type) {
+            return requires(const typename decltype(type)::type & element) { element.template set_property<0>(0); };
+        };
+        static_assert(settable(std::type_identity<typename gdb_t::vertex_t>()) && settable(std::type_identity<typename gdb_t::edge_t>()));
+        static_assert(!settable(std::type_identity<const_vertex_t>()) && !settable(std::type_identity<const_edge_t>()));
+        static_assert(std::is_convertible_v<typename gdb_t::vertex_t, const_vertex_t>);
+        static_assert(!std::is_convertible_v<const_vertex_t, typename gdb_t::vertex_t>);
+        const_vertex_t c1 = v1;
+        assert(c1.id() == "v1" && reader.find_vertex("v2")->get_index() == v2.get_index());
+        gdb.add_edge("e21", reader.vertex_at(1), c1);
+        assert((*reader.vertex_at(1).edges().begin()).dst().id() == "v1");
+
         spoil(e12);
     }
 
@@ -324,9 +368,2313 @@ class test_bench {
         ++eb;
         eb2++;
 
+        static_assert(std::random_access_iterator<typename gdb_t::vertex_it_t>, "Vertex iterator should be random access");
+        static_assert(std::random_access_iterator<typename gdb_t::edge_it_t>, "Edge iterator should be random access");
+        static_assert(std::random_access_iterator<typename gdb_t::neighbor_it_t>, "Neighbor iterator should be random access");
+        static_assert(std::ranges::sized_range<decltype(gdb.get_vertexes())>, "Vertexes should be a sized range");
+        static_assert(std::ranges::sized_range<decltype(gdb.get_edges())>, "Edges should be a sized range");
+        auto vertexes = gdb.get_vertexes();
+        assert(vertexes.size() == 2);
+        assert(vertexes[1].id() == v2.id());
+        assert((*(vertexes.end() - 1)).id() == v2.id());
+        assert(std::ranges::count_if(vertexes, [](auto&& v) { return v.id() == "v1"; }) == 1);
+
         spoil(e12);
     }
 
+    static void check_find() {
+        struct gs {
+            using vertex_user_id_t = std::string;
+            using vertex_property_t = std::tuple<int>;
+
+            using edge_user_id_t = size_t;
+            using edge_property_t = std::tuple<double>;
+        };
+        using gdb_t = graph_db<gs>;
+        gdb_t gdb;
+
+        for (size_t i = 0; i < 100; ++i) {
+            gdb.add_vertex("v" + std::to_string(i), static_cast<int>(i));
+        }
+        for (size_t i = 0; i < 100; ++i) {
+            gdb.add_edge(i, *gdb.find_vertex("v" + std::to_string(i)), *gdb.find_vertex("v" + std::to_string((i + 1) % 100)), 0.5);
+        }
+
+        assert(gdb.find_vertex("v42")->template get_property<0>() == 42);
+        assert(!gdb.find_vertex("v100"));
+        assert(gdb.find_edge(42)->dst().id() == "v43");
+        assert(!gdb.find_edge(100));
+
+        bool thrown = false;
+        try {
+            gdb.add_vertex("v7");
+        }
+        catch (const std::invalid_argument&) {
+            thrown = true;
+        }
+        assert(thrown);
+        assert(!gdb.find_vertex("v100"));
+    }
+
+    static void check_bulk() {
+        struct gs {
+            using vertex_user_id_t = std::string;
+            using vertex_property_t = std::tuple<int, std::string>;
+
+            using edge_user_id_t = size_t;
+            using edge_property_t = std::tuple<double>;
+        };
+        using gdb_t = graph_db<gs>;
+        gdb_t gdb;
+
+        gdb.add_vertex("v0", 0, "first");
+        std::vector<std::tuple<std::string, int, std::string>> vertex_rows;
+        for (int i = 1; i < 10; ++i) {
+            vertex_rows.emplace_back("v" + std::to_string(i), i, "p" + std::to_string(i));
+        }
+        auto added = gdb.add_vertices(std::move(vertex_rows));
+        assert(std::ranges::distance(added) == 9);
+        assert((*added.begin()).id() == "v1");
+
+        std::vector<typename gdb_t::vertex_t> vertices;
+        for (auto&& v : gdb.get_vertexes()) {
+            vertices.push_back(v);
+        }
+        std::vector<std::tuple<size_t, typename gdb_t::vertex_t, typename gdb_t::vertex_t, double>> edge_rows;
+        for (size_t i = 0; i < 10; ++i) {
+            edge_rows.emplace_back(i, vertices[(i * 7) % 10], vertices[(i + 1) % 10], i / 10.0);
+        }
+        gdb.add_edges(edge_rows);
+
+        for (auto&& v : gdb.get_vertexes()) {
+            for (auto&& e : v.edges()) {
+                assert(e.src().id() == v.id());
+                spoil(e);
+            }
+        }
+        assert(gdb.find_vertex("v9")->template get_property<1>() == "p9");
+        assert(gdb.find_edge(3)->src().id() == "v1");
+
+        std::vector<std::tuple<std::string, int, std::string>> duplicates = { { "v10", 10, "" }, { "v3", 3, "" } };
+        bool thrown = false;
+        try {
+            gdb.add_vertices(duplicates);
+        }
+        catch (const std::invalid_argument&) {
+            thrown = true;
+        }
+        assert(thrown);
+        assert(!gdb.find_vertex("v10"));
+        assert(std::ranges::distance(gdb.get_vertexes()) == 10);
+    }
+
+    static void check_snapshot() {
+        struct gs {
+            using vertex_user_id_t = std::string;
+            using vertex_property_t = std::tuple<int, double, bool, std::string>;
+
+            using edge_user_id_t = float;
+            using edge_property_t = std::tuple<double>;
+        };
+        using gdb_t = graph_db<gs>;
+        gdb_t gdb;
+
+        auto v1 = gdb.add_vertex("v1", 1, 1.1, true, "jedna");
+        auto v2 = gdb.add_vertex("v2", 2, 2.2, false, "");
+        auto v3 = gdb.add_vertex("v3");
+        gdb.add_edge(1.2f, v1, v2, 12.0);
+        gdb.add_edge(3.1f, v3, v1, 31.0);
+        gdb.add_edge(1.3f, v1, v3, 13.0);
+
+        std::string path = (std::filesystem::temp_directory_path() / "graph_db_check_snapshot.bin").string();
+        gdb.save(path);
+        gdb_t loaded = gdb_t::open_mmap(path);
+
+        assert(std::ranges::distance(loaded.get_vertexes()) == 3);
+        assert(std::ranges::distance(loaded.get_edges()) == 3);
+        assert(loaded.find_vertex("v1")->get_properties() == v1.get_properties());
+        assert(loaded.find_vertex("v2")->template get_property<3>().empty());
+        assert(loaded.find_edge(3.1f)->dst().id() == "v1");
+        assert(std::ranges::distance(loaded.find_vertex("v1")->edges()) == 2);
+        print_gdb(loaded);
+
+        // Overwrites the element-th 8 bytes of the payload of the column-th column and expects the load to fail.
+        std::ifstream in(path, std::ios::binary);
+        std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        in.close();
+        std::filesystem::remove(path);
+        auto corrupted = [&bytes, &path](size_t column, size_t element, uint64_t value) {
+            auto align = [](size_t pos) { return (pos + snapshot_format::alignment - 1) / snapshot_format::alignment * snapshot_format::alignment; };
+            size_t pos = align(sizeof(snapshot_format::header));
+            for (size_t c = 0;; ++c) {
+                snapshot_format::column_header h;
+                std::memcpy(&h, bytes.data() + pos, sizeof(h));
+                pos = align(pos + sizeof(h));
+                if (c == column) {
+                    break;
+                }
+                pos = align(pos + static_cast<size_t>(h.payload_size));
+            }
+            std::vector<char> patched = bytes;
+            std::memcpy(patched.data() + pos + element * sizeof(uint64_t), &value, sizeof(value));
+            std::ofstream(path, std::ios::binary).write(patched.data(), static_cast<std::streamsize>(patched.size()));
+            bool thrown = false;
+            try {
+                gdb_t::open_mmap(path);
+            }
+            catch (const std::runtime_error&) {
+                thrown = true;
+            }
+            std::filesystem::remove(path);
+            return thrown;
+        };
+        // Columns: vertex ids, edge ids, 4 vertex properties, 1 edge property, sources, destinations, CSR offsets, CSR targets.
+        assert(corrupted(0, 1, 1000) && corrupted(0, 2, 0) && corrupted(5, 1, uint64_t(1) << 40));
+        assert(corrupted(7, 0, 3) && corrupted(8, 2, 1000) && corrupted(9, 1, 0) && corrupted(9, 3, 4));
+        assert(corrupted(10, 0, 7) && corrupted(10, 1, 0));
+    }
+
+    struct mapped_gs {
+        using vertex_user_id_t = size_t;
+        using vertex_property_t = std::tuple<int, double, std::string>;
+
+        using edge_user_id_t = size_t;
+        using edge_property_t = std::tuple<float>;
+
+        template<typename T>
+        using column_t = mapped_column_t<T>;
+    };
+
+    static void check_mapped_columns() {
+        using gdb_t = graph_db<mapped_gs>;
+        static_assert(std::is_same_v<std::tuple_element_t<0, typename gdb_t::vertex_properties_t>, mapped_column<int>>);
+        static_assert(std::is_same_v<std::tuple_element_t<2, typename gdb_t::vertex_properties_t>, std::vector<std::string>>);
+        const size_t n = 1000;
+        std::string path = (std::filesystem::temp_directory_path() / "graph_db_check_mapped.bin").string();
+        {
+            gdb_t gdb;
+            for (size_t i = 0; i < n; ++i) {
+                gdb.add_vertex(i, static_cast<int>(i), i * 0.5, std::to_string(i));
+                gdb.add_edge(i, gdb.vertex_at(i), gdb.vertex_at(i / 2), static_cast<float>(i));
+            }
+            gdb.save(path);
+        }
+        {
+            gdb_t loaded = gdb_t::open_mmap(path);
+            assert(loaded.template vertex_column<0>().is_mapped() && loaded.template vertex_column<1>().is_mapped());
+            assert(loaded.template edge_column<0>().is_mapped());
+            assert(loaded.template filter_vertices<0>(compare_op::lt, 100).count() == 100);
+            assert(loaded.template aggregate_edges<0>().max == static_cast<float>(n - 1));
+            for (auto&& v : loaded.get_vertexes()) {
+                size_t i = v.id();
+                assert(v.get_properties() == std::make_tuple(static_cast<int>(i), i * 0.5, std::to_string(i)));
+            }
+
+            // A copy shares the mapping, the first write copies only the column written to.
+            gdb_t copy(loaded);
+            copy.vertex_at(7).template set_property<0>(-7);
+            assert(!copy.template vertex_column<0>().is_mapped() && copy.template vertex_column<1>().is_mapped());
+            assert(copy.vertex_at(7).template get_property<0>() == -7 && loaded.vertex_at(7).template get_property<0>() == 7);
+            copy.add_vertex(n, 1, 1.0, "new");
+            assert(!copy.template vertex_column<1>().is_mapped() && copy.vertex_at(n).template get_property<1>() == 1.0);
+            copy.remove_vertex(copy.vertex_at(3));
+            copy.compact();
+            assert(copy.vertex_count() == n && copy.vertex_at(3).template get_property<0>() == 4);
+            assert(loaded.template vertex_column<0>().is_mapped() && loaded.vertex_at(3).template get_property<0>() == 3);
+        }
+        std::filesystem::remove(path);
+    }
+
+    struct compact_gs {
+        using vertex_user_id_t = std::string;
+        using vertex_property_t = std::tuple<int, double, bool, std::string>;
+
+        using edge_user_id_t = std::string;
+        using edge_property_t = std::tuple<bool, std::string>;
+
+        template<typename T>
+        using column_t = compact_column_t<T>;
+    };
+
+    static void check_compact_columns() {
+        using gdb_t = graph_db<compact_gs>;
+        static_assert(std::is_same_v<std::tuple_element_t<2, typename gdb_t::vertex_properties_t>, bit_column>);
+        static_assert(std::is_same_v<std::tuple_element_t<3, typename gdb_t::vertex_properties_t>, string_arena_column>);
+        gdb_t gdb;
+
+        for (int i = 0; i < 200; ++i) {
+            auto v = gdb.add_vertex("v" + std::to_string(i), i, i * 0.5, i % 3 == 0, std::string(i % 7, 'x'));
+            if (i > 0) {
+                gdb.add_edge("e" + std::to_string(i), v, *gdb.find_vertex("v" + std::to_string(i - 1)), i % 2 == 0, "edge");
+            }
+        }
+        gdb.add_vertex("default");
+        auto v7 = *gdb.find_vertex("v7");
+        v7.template set_property<3>("a much longer string than before");
+        v7.template set_property<3>("short");
+        v7.template set_property<2>(true);
+        assert(v7.template get_property<3>() == "short");
+        v7.set_properties(7, 3.5, false, std::string(0, 'x'));
+
+        std::string path = (std::filesystem::temp_directory_path() / "graph_db_check_compact.bin").string();
+        gdb.save(path);
+        gdb_t loaded = gdb_t::open_mmap(path);
+        std::filesystem::remove(path);
+
+        for (const gdb_t& db : { std::cref(gdb), std::cref(loaded) }) {
+            for (int i = 0; i < 200; ++i) {
+                auto v = *db.find_vertex("v" + std::to_string(i));
+                assert(v.get_properties() == std::make_tuple(i, i * 0.5, i % 3 == 0, std::string(i % 7, 'x')));
+            }
+            assert(db.find_vertex("default")->get_properties() == std::make_tuple(0, 0.0, false, std::string()));
+            assert(db.find_edge("e42")->get_properties() == std::make_tuple(true, std::string("edge")));
+        }
+    }
+
+    static void check_scan() {
+        struct gs {
+            using vertex_user_id_t = size_t;
+            using vertex_property_t = std::tuple<int, std::string, bool>;
+
+            using edge_user_id_t = size_t;
+            using edge_property_t = std::tuple<double>;
+        };
+        using gdb_t = graph_db<gs>;
+        gdb_t gdb;
+
+        for (size_t i = 0; i < 100000; ++i) {
+            gdb.add_vertex(i, static_cast<int>(i % 1000), "", i % 3 == 0);
+        }
+        auto selected = gdb.template scan_vertices<0, 2>([](int p0, bool p2) { return p0 > 900 && p2; });
+
+        size_t expected = 0;
+        for (auto&& v : gdb.get_vertexes()) {
+            bool match = v.template get_property<0>() > 900 && v.template get_property<2>();
+            assert(selected.test(v.get_index()) == match);
+            expected += match;
+        }
+        assert(selected.count() == expected);
+        assert(selected.indices().size() == expected);
+        assert(gdb.template scan_edges<0>([](double) { return true; }).count() == 0);
+    }
+
+    static void check_simd_kernels() {
+        std::vector<int> ints;
+        std::vector<float> floats;
+        std::vector<double> doubles;
+        for (int i = 0; i < 1000; ++i) {
+            ints.push_back((i * 7919) % 201 - 100);
+            floats.push_back(static_cast<float>(ints.back()) / 4);
+            doubles.push_back(static_cast<double>(ints.back()) / 8);
+        }
+        auto check = [](const auto& values, auto v, auto lo, auto hi) {
+            using T = typename std::decay_t<decltype(values)>::value_type;
+            std::vector<uint64_t> words((values.size() + 63) / 64);
+            for (int level = 0; level <= static_cast<int>(detected_simd_level()); ++level) {
+                auto l = static_cast<simd_level>(level);
+                for (auto op : { compare_op::eq, compare_op::ne, compare_op::lt, compare_op::le, compare_op::gt, compare_op::ge }) {
+                    simd_compare<T>(values.data(), values.size(), op, v, words.data(), l);
+                    for (size_t i = 0; i < values.size(); ++i) {
+                        T x = values[i];
+                        bool expected = op == compare_op::eq ? x == v : op == compare_op::ne ? x != v : op == compare_op::lt ? x < v
+                            : op == compare_op::le ? x <= v : op == compare_op::gt ? x > v : x >= v;
+                        assert(((words[i / 64] >> (i % 64)) & 1) == expected);
+                        spoil(expected);
+                    }
+                }
+                simd_range<T>(values.data(), values.size(), lo, hi, words.data(), l);
+                for (size_t i = 0; i < values.size(); ++i) {
+                    assert(((words[i / 64] >> (i % 64)) & 1) == (lo <= values[i] && values[i] <= hi));
+                }
+                auto agg = simd_aggregate<T>(values.data(), values.size(), l);
+                assert(agg.count == values.size());
+                assert(agg.min == *std::min_element(values.begin(), values.end()));
+                assert(agg.max == *std::max_element(values.begin(), values.end()));
+                double sum = 0;
+                for (auto x : values) {
+                    sum += x;
+                }
+                assert(agg.sum == sum);
+            }
+        };
+        check(ints, 3, -10, 10);
+        check(floats, 0.75f, -2.5f, 2.5f);
+        check(doubles, 0.375, -1.25, 1.25);
+
+        // Constants of another type compare exactly, not after conversion to the column type.
+        auto exact = [](auto x, auto v, compare_op op) {
+            auto cmp = [x, v]() {
+                if constexpr (std::is_integral_v<decltype(x)> && std::is_integral_v<decltype(v)>) {
+                    return std::cmp_less(x, v) ? -1 : std::cmp_greater(x, v) ? 1 : 0;
+                }
+                else {
+                    return static_cast<long double>(x) < v ? -1 : static_cast<long double>(x) > v ? 1 : 0;
+                }
+            };
+            if constexpr (std::is_floating_point_v<decltype(v)>) {
+                if (std::isnan(v) || std::isnan(x)) {
+                    return op == compare_op::ne;
+                }
+            }
+            int c = cmp();
+            return op == compare_op::eq ? c == 0 : op == compare_op::ne ? c != 0 : op == compare_op::lt ? c < 0
+                : op == compare_op::le ? c <= 0 : op == compare_op::gt ? c > 0 : c >= 0;
+        };
+        auto check_constant = [&exact](const auto& values, auto v) {
+            for (auto op : { compare_op::eq, compare_op::ne, compare_op::lt, compare_op::le, compare_op::gt, compare_op::ge }) {
+                selection_bitmap selected = filter_column(values, op, v);
+                for (size_t i = 0; i < values.size(); ++i) {
+                    assert(selected.test(i) == exact(values[i], v, op));
+                }
+            }
+        };
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        for (double v : { 2.5, -2.5, 3.0, 100.5, 1e10, -1e10, 2147483647.5, nan }) {
+            check_constant(ints, v);
+            check_constant(floats, v);
+        }
+        check_constant(ints, 2.5f);
+        check_constant(ints, int64_t(1) << 40);
+        check_constant(ints, -(int64_t(1) << 40));
+        check_constant(ints, std::numeric_limits<size_t>::max());
+        check_constant(ints, size_t(3));
+        for (double v : { 0.1, -0.3, 1e300, -1e300, std::numeric_limits<double>::infinity() }) {
+            check_constant(floats, v);
+        }
+        assert(filter_column(ints, compare_op::gt, 2.5).count() == filter_column(ints, compare_op::ge, 3).count());
+        assert(filter_column_range(ints, 2.5, 7.5).count() == filter_column_range(ints, 3, 7).count());
+        assert(filter_column_range(ints, -1e10, 1e10).count() == ints.size() && filter_column_range(ints, 1e10, 2e10).count() == 0);
+        assert(filter_column_range(floats, -0.3, 0.3).count() == filter_column_range(floats, -0.25f, 0.25f).count());
+
+        using gdb_t = graph_db<gs>;
+        gdb_t gdb;
+        auto v1 = gdb.add_vertex("v1");
+        for (int i = 0; i < 300; ++i) {
+            gdb.add_edge("e" + std::to_string(i), v1, v1, i * 0.5);
+        }
+        assert(gdb.template filter_edges<0>(compare_op::gt, 100.0).count() == 99);
+        assert(gdb.template filter_edges_between<0>(10.0, 20.0).count() == 21);
+        assert(gdb.template aggregate_edges<0>().max == 149.5);
+        assert(gdb.template aggregate_vertices<0>().count == 1);
+    }
+
+    static void check_traversal() {
+        struct gs {
+            using vertex_user_id_t = size_t;
+            using vertex_property_t = std::tuple<>;
+
+            using edge_user_id_t = size_t;
+            using edge_property_t = std::tuple<double>;
+        };
+        using gdb_t = graph_db<gs>;
+        gdb_t gdb;
+
+        const size_t n = 5000;
+        for (size_t i = 0; i < n; ++i) {
+            gdb.add_vertex(i);
+        }
+        uint64_t state = 42;
+        auto next = [&state]() { state = state * 6364136223846793005ULL + 1442695040888963407ULL; return state >> 33; };
+        auto vertices = gdb.get_vertexes();
+        for (size_t e = 0; e < 8 * n; ++e) {
+            // Vertexes above n - 100 get no outgoing edges to leave some of them unreachable.
+            size_t src = next() % (n - 100);
+            gdb.add_edge(e, vertices.begin()[src], vertices.begin()[next() % n], static_cast<double>(next() % 100) / 10);
+        }
+
+        std::vector<size_t> depth(n, bfs_unreachable);
+        std::vector<size_t> queue = { 0 };
+        depth[0] = 0;
+        for (size_t i = 0; i < queue.size(); ++i) {
+            for (auto&& e : vertices.begin()[queue[i]].edges()) {
+                size_t v = e.dst().get_index();
+                if (depth[v] == bfs_unreachable) {
+                    depth[v] = depth[queue[i]] + 1;
+                    queue.push_back(v);
+                }
+            }
+        }
+
+        std::vector<double> dist(n, std::numeric_limits<double>::infinity());
+        std::vector<bool> done(n, false);
+        dist[0] = 0;
+        for (size_t round = 0; round < n; ++round) {
+            size_t u = n;
+            for (size_t v = 0; v < n; ++v) {
+                if (!done[v] && (u == n || dist[v] < dist[u])) {
+                    u = v;
+                }
+            }
+            if (dist[u] == std::numeric_limits<double>::infinity()) {
+                break;
+            }
+            done[u] = true;
+            for (auto&& e : vertices.begin()[u].edges()) {
+                size_t v = e.dst().get_index();
+                dist[v] = std::min(dist[v], dist[u] + e.template get_property<0>());
+            }
+        }
+
+        thread_pool pool(4);
+        assert(bfs_depths(gdb, { 0 }, pool) == depth);
+        for (double delta : { 0.0, 0.5, 100.0 }) {
+            auto result = sssp_delta_stepping<0>(gdb, { 0 }, delta, pool);
+            for (size_t v = 0; v < n; ++v) {
+                assert(result[v] == dist[v] || std::abs(result[v] - dist[v]) < 1e-9);
+            }
+            spoil(result);
+        }
+
+        // Distances far beyond delta need no bucket per delta, removed edges do not count towards the default delta.
+        graph_db<reverse_gs> far;
+        for (size_t i = 0; i < 4; ++i) {
+            far.add_vertex(i, 0);
+        }
+        far.add_edge(size_t(0), far.vertex_at(0), far.vertex_at(1), 1e300);
+        far.add_edge(size_t(1), far.vertex_at(1), far.vertex_at(2), 1.0);
+        far.add_edge(size_t(2), far.vertex_at(0), far.vertex_at(3), 2.0);
+        far.add_edge(size_t(3), far.vertex_at(3), far.vertex_at(2), 1e12);
+        far.add_edge(size_t(4), far.vertex_at(2), far.vertex_at(3), 1e308);
+        far.remove_edge(far.edge_at(4));
+        for (double delta : { 0.0, 1e-300, 1.0 }) {
+            auto result = sssp_delta_stepping<0>(far, { 0 }, delta, pool);
+            assert(result == std::vector<double>({ 0, 1e300, 2.0 + 1e12, 2.0 }));
+        }
+    }
+
+    struct reverse_gs {
+        using vertex_user_id_t = size_t;
+        using vertex_property_t = std::tuple<int>;
+
+        using edge_user_id_t = size_t;
+        using edge_property_t = std::tuple<double>;
+
+        static constexpr bool reverse_index = true;
+    };
+
+    static void check_reverse_index() {
+        using gdb_t = graph_db<reverse_gs>;
+        static_assert(gdb_t::has_reverse_index && !graph_db<gs>::has_reverse_index);
+        gdb_t gdb;
+
+        const size_t n = 300;
+        std::vector<std::tuple<size_t, int>> vertex_rows;
+        for (size_t i = 0; i < n; ++i) {
+            vertex_rows.emplace_back(i, static_cast<int>(i));
+        }
+        auto vertices = gdb.add_vertices(vertex_rows);
+        std::vector<std::tuple<size_t, gdb_t::vertex_t, gdb_t::vertex_t, double>> edge_rows;
+        for (size_t e = 0; e < 4 * n; ++e) {
+            edge_rows.emplace_back(e, vertices[(e * 7) % n], vertices[(e * 13 + e / n) % n], 1.0);
+        }
+        gdb.add_edges(edge_rows);
+        auto extra = gdb.add_vertex(n);
+        gdb.add_edge(4 * n, extra, vertices[5], 1.0);
+        gdb.add_edge(4 * n + 1, vertices[5], extra, 1.0);
+
+        auto check = [](const gdb_t& db) {
+            std::vector<std::vector<size_t>> expected(db.vertex_count());
+            for (auto&& e : db.get_edges()) {
+                expected[e.dst().get_index()].push_back(e.get_index());
+            }
+            for (auto&& v : db.get_vertexes()) {
+                std::vector<size_t> in;
+                for (auto&& e : v.in_edges()) {
+                    assert(e.dst().get_index() == v.get_index());
+                    in.push_back(e.get_index());
+                }
+                assert(in == expected[v.get_index()]);
+                assert(v.in_degree() == in.size());
+            }
+        };
+
+        // The out of order edges above are still in the delta buffers, the first concurrent readers merge them.
+        for (size_t i = 0; i < 8; ++i) {
+            gdb.add_edge(4 * n + 2 + i, vertices[i * 31 % n], vertices[i * 17 % n], 1.0);
+        }
+        const gdb_t& reader = gdb;
+        std::vector<size_t> degrees(8);
+        std::vector<std::thread> readers;
+        for (size_t t = 0; t < degrees.size(); ++t) {
+            readers.emplace_back([&reader, &degrees, t]() {
+                for (auto&& v : reader.get_vertexes()) {
+                    degrees[t] += v.degree() + v.in_degree();
+                }
+            });
+        }
+        for (auto&& t : readers) {
+            t.join();
+        }
+        for (size_t d : degrees) {
+            assert(d == 2 * reader.edge_count());
+        }
+
+        check(gdb);
+        assert(extra.in_degree() == 1 && extra.degree() == 1);
+        assert((*extra.in_edges().begin()).src().id() == 5);
+
+        std::string path = (std::filesystem::temp_directory_path() / "graph_db_check_reverse_index.bin").string();
+        gdb.save(path);
+        gdb_t loaded = gdb_t::open_mmap(path);
+        std::filesystem::remove(path);
+        check(loaded);
+
+        thread_pool pool(4);
+        assert(bfs_depths(gdb, { 0 }, pool) == bfs_depths(loaded, { 0 }, pool));
+
+        // Reads between single inserts patch the touched rows until the index is rebuilt, in either order.
+        for (bool sorted : { false, true }) {
+            adjacency_index index(sorted);
+            std::vector<std::vector<std::pair<size_t, size_t>>> expected(50);
+            index.add_vertices(expected.size());
+            auto check_index = [&expected, sorted](const adjacency_index& idx) {
+                std::vector<size_t> offsets = idx.offsets_array();
+                std::vector<size_t> targets = idx.targets_array();
+                assert(offsets.size() == expected.size() + 1 && targets.size() == offsets.back());
+                for (size_t v = 0; v < expected.size(); ++v) {
+                    auto row = expected[v];
+                    if (sorted) {
+                        std::sort(row.begin(), row.end());
+                    }
+                    std::vector<size_t> edges;
+                    std::vector<size_t> keys;
+                    for (auto&& [key, e] : row) {
+                        keys.push_back(key);
+                        edges.push_back(e);
+                    }
+                    auto neighbors = idx.neighbors(v);
+                    assert(std::vector<size_t>(neighbors.begin(), neighbors.end()) == edges);
+                    assert(std::equal(edges.begin(), edges.end(), targets.begin() + static_cast<std::ptrdiff_t>(offsets[v])));
+                    if (sorted) {
+                        auto row_keys = idx.neighbor_keys(v);
+                        assert(std::vector<size_t>(row_keys.begin(), row_keys.end()) == keys);
+                    }
+                }
+            };
+            for (size_t e = 0; e < 3000; ++e) {
+                if (e % 700 == 0) {
+                    index.add_vertex();
+                    expected.emplace_back();
+                }
+                size_t src = (e * 7919) % expected.size();
+                size_t key = (e * 31) % 97;
+                index.add_edge(src, e, key);
+                expected[src].emplace_back(key, e);
+                assert(index.degree(src) == expected[src].size());
+                if (e % 250 == 0) {
+                    adjacency_index copy(index);
+                    check_index(copy);
+                    check_index(index);
+                }
+            }
+            check_index(index);
+        }
+    }
+
+    struct arena_gs {
+        using vertex_user_id_t = std::pmr::string;
+        using vertex_property_t = std::tuple<int, std::pmr::string>;
+
+        using edge_user_id_t = size_t;
+        using edge_property_t = std::tuple<double>;
+
+        using allocator_t = std::pmr::polymorphic_allocator<std::byte>;
+    };
+
+    static void check_arena() {
+        struct counting_resource : std::pmr::memory_resource {
+            size_t allocations = 0;
+            void* do_allocate(size_t bytes, size_t alignment) override {
+                ++allocations;
+                return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+            }
+            void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+                std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+            }
+            bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+                return this == &other;
+            }
+        };
+        using gdb_t = graph_db<arena_gs>;
+        static_assert(std::is_same_v<std::tuple_element_t<1, gdb_t::vertex_properties_t>, std::pmr::vector<std::pmr::string>>);
+
+        counting_resource upstream;
+        arena_resource arena(1 << 16, &upstream);
+        std::string path = (std::filesystem::temp_directory_path() / "graph_db_check_arena.bin").string();
+        {
+            gdb_t gdb(&arena);
+            assert(gdb.get_allocator().resource() == &arena);
+            const size_t n = 2000;
+            gdb.reserve_vertices(n);
+            for (size_t i = 0; i < n; ++i) {
+                std::string name = "a long vertex user id number " + std::to_string(i);
+                gdb.add_vertex(std::pmr::string(name), static_cast<int>(i), name + " with a long string property");
+            }
+            auto v0 = *gdb.find_vertex("a long vertex user id number 0");
+            for (size_t i = 0; i < n; ++i) {
+                gdb.add_edge(i, v0, *gdb.find_vertex(std::pmr::string("a long vertex user id number " + std::to_string(i))), 0.5);
+            }
+            // Strings are copied into the arena, so the upstream only sees a few growing chunks.
+            assert(upstream.allocations < 20);
+            assert(arena.bytes_allocated() > n * 60 && arena.bytes_reserved() >= arena.bytes_allocated());
+            assert(v0.template get_property<1>() == "a long vertex user id number 0 with a long string property");
+            v0.template set_property<1>(std::string("changed"));
+            assert(v0.template get_property<1>() == "changed");
+            gdb.save(path);
+        }
+        arena.release();
+        assert(arena.bytes_reserved() == 0);
+
+        gdb_t loaded = gdb_t::open_mmap(path, &arena);
+        std::filesystem::remove(path);
+        assert(loaded.vertex_count() == 2000 && loaded.edge_count() == 2000);
+        assert(loaded.find_vertex("a long vertex user id number 1999")->template get_property<0>() == 1999);
+        assert(loaded.find_vertex("a long vertex user id number 0")->template get_property<1>() == "changed");
+        assert(arena.bytes_allocated() > 0);
+    }
+
+    struct dictionary_gs {
+        using vertex_user_id_t = std::string;
+        using vertex_property_t = std::tuple<std::string, int, std::string>;
+
+        using edge_user_id_t = std::string;
+        using edge_property_t = std::tuple<std::string>;
+
+        static constexpr bool intern_ids = true;
+
+        template<typename T>
+        using column_t = dictionary_column_t<T>;
+    };
+
+    static void check_dictionary_columns() {
+        using gdb_t = graph_db<dictionary_gs>;
+        static_assert(std::is_same_v<gdb_t::vertex_ids_t, dictionary_column>);
+        static_assert(std::is_same_v<std::tuple_element_t<0, gdb_t::vertex_properties_t>, dictionary_column>);
+        gdb_t gdb;
+
+        const size_t n = 50000;
+        for (size_t i = 0; i < n; ++i) {
+            gdb.add_vertex("v" + std::to_string(i), "label" + std::to_string(i % 10), static_cast<int>(i), i % 2 ? "odd" : "even");
+        }
+        auto v0 = *gdb.find_vertex("v0");
+        static_assert(std::is_same_v<decltype(v0.id()), std::string_view>);
+        static_assert(std::is_same_v<decltype(v0.template get_property<0>()), std::string_view>);
+        assert(v0.id() == "v0");
+        for (size_t i = 1; i < 100; ++i) {
+            gdb.add_edge("e" + std::to_string(i), v0, *gdb.find_vertex("v" + std::to_string(i)), i % 3 ? "knows" : "likes");
+        }
+        bool thrown = false;
+        try {
+            gdb.add_vertex("v7");
+        }
+        catch (const std::invalid_argument&) {
+            thrown = true;
+        }
+        assert(thrown);
+        spoil(thrown);
+
+        // Ids, labels and edge types share one pool, each distinct string is stored once.
+        const auto& pool = gdb.template vertex_column<0>().pool();
+        assert(pool == gdb.template vertex_column<2>().pool() && pool == gdb.template edge_column<0>().pool());
+        assert(pool->size() == n + 10 + 2 + 99 + 2);
+        assert(gdb.find_edge("e3")->template get_property<0>() == "likes");
+
+        assert(gdb.template filter_vertices<0>(compare_op::eq, "label3").count() == n / 10);
+        assert(gdb.template filter_vertices<0>(compare_op::ne, std::string("label3")).count() == n - n / 10);
+        assert(gdb.template filter_vertices<0>(compare_op::eq, "missing").count() == 0);
+        assert(gdb.template filter_vertices<0>(compare_op::ne, "missing").count() == n);
+        assert(gdb.template filter_vertices<0>(compare_op::lt, "label2").count() == 2 * n / 10);
+        assert(gdb.template filter_edges<0>(compare_op::eq, "knows").count() == 66);
+
+        v0.template set_property<0>("label9");
+        v0.set_properties("root", -1, "even");
+        assert(v0.get_properties() == std::make_tuple(std::string("root"), -1, std::string("even")));
+        assert(gdb.template filter_vertices<0>(compare_op::eq, "root").indices() == std::vector<size_t>{ 0 });
+
+        std::string path = (std::filesystem::temp_directory_path() / "graph_db_check_dictionary.bin").string();
+        gdb.save(path);
+        gdb_t loaded = gdb_t::open_mmap(path);
+        std::filesystem::remove(path);
+        assert(loaded.find_vertex("v12345")->get_properties() == std::make_tuple(std::string("label5"), 12345, std::string("odd")));
+        assert(loaded.find_edge("e99")->dst().id() == "v99");
+        assert(loaded.template vertex_column<0>().pool() == loaded.template edge_column<0>().pool());
+    }
+
+    static void check_concurrent() {
+        struct gs {
+            using vertex_user_id_t = size_t;
+            using vertex_property_t = std::tuple<int, std::string>;
+
+            using edge_user_id_t = size_t;
+            using edge_property_t = std::tuple<double>;
+        };
+        using cdb_t = concurrent_graph_db<gs>;
+        cdb_t cdb;
+
+        // Vertex i links to i - 1, the first and the last vertex always carry the number of the batch.
+        auto check = [](const graph_db<gs>& db) {
+            size_t n = db.vertex_count();
+            assert(db.edge_count() == (n == 0 ? 0 : n - 1));
+            for (auto&& v : db.get_vertexes()) {
+                assert(v.id() == v.get_index());
+                assert(v.degree() == (v.get_index() == 0 ? 0 : 1));
+                for (auto&& e : v.edges()) {
+                    assert(e.dst().get_index() + 1 == v.get_index() && e.template get_property<0>() == v.get_index() * 0.5);
+                }
+            }
+            if (n > 0) {
+                auto vertices = db.get_vertexes();
+                assert(vertices[0].template get_property<1>() == vertices[n - 1].template get_property<1>());
+            }
+            return n;
+        };
+
+        const size_t batches = 200;
+        const size_t batch = 50;
+        auto held = cdb.snapshot();
+        std::atomic<bool> done{ false };
+        std::vector<std::thread> readers;
+        for (int r = 0; r < 3; ++r) {
+            readers.emplace_back([&]() {
+                size_t last = 0;
+                while (!done.load()) {
+                    auto snap = cdb.snapshot();
+                    size_t n = check(*snap);
+                    assert(n >= last && n % batch == 0);
+                    last = n;
+                    spoil(last, n);
+                }
+            });
+        }
+
+        typename cdb_t::vertex_t first;
+        typename cdb_t::vertex_t prev;
+        for (size_t b = 0; b < batches; ++b) {
+            for (size_t i = b * batch; i < (b + 1) * batch; ++i) {
+                auto v = cdb.add_vertex(i, static_cast<int>(i), std::to_string(b));
+                if (i == 0) {
+                    first = v;
+                }
+                else {
+                    cdb.add_edge(i, v, prev, i * 0.5);
+                }
+                prev = v;
+            }
+            cdb.template set_vertex_property<1>(first, std::to_string(b));
+            assert(cdb.pending() > 0);
+            cdb.publish();
+            assert(cdb.pending() == 0);
+            if (b == batches / 2) {
+                held = cdb.snapshot();
+            }
+        }
+        done.store(true);
+        for (auto&& t : readers) {
+            t.join();
+        }
+
+        assert(check(*held) == (batches / 2 + 1) * batch);
+        assert(check(*cdb.snapshot()) == batches * batch);
+        assert(cdb.writer_view().vertex_count() == batches * batch);
+        bool thrown = false;
+        try {
+            cdb.add_vertex(size_t(7));
+        }
+        catch (const std::invalid_argument&) {
+            thrown = true;
+        }
+        assert(thrown && cdb.pending() == 0);
+        spoil(thrown);
+
+        // The spare instance replays the compaction after the caller's pool is gone.
+        {
+            thread_pool pool(2);
+            cdb.remove_vertex(prev);
+            cdb.compact(pool);
+            cdb.publish();
+        }
+        assert(check(*cdb.snapshot()) == batches * batch - 1);
+        cdb.add_vertex(batches * batch);
+        cdb.publish();
+        assert(cdb.snapshot()->vertex_count() == batches * batch && cdb.snapshot()->removed_vertex_count() == 0);
+    }
+
+    struct segmented_gs {
+        using vertex_user_id_t = size_t;
+        using vertex_property_t = std::tuple<int, double, bool, std::string>;
+
+        using edge_user_id_t = size_t;
+        using edge_property_t = std::tuple<float>;
+
+        template<typename T>
+        using column_t = segmented_column<T, 14>;
+    };
+
+    static void check_segmented_columns() {
+        using gdb_t = graph_db<segmented_gs>;
+        static_assert(std::is_same_v<std::tuple_element_t<1, gdb_t::vertex_properties_t>, segmented_column<double, 14>>);
+        gdb_t gdb;
+
+        auto v0 = gdb.add_vertex(size_t(0), 0, 0.0, true, "zero");
+        const double* address = &v0.template get_property<1>();
+        const size_t n = 100000;
+        std::vector<std::tuple<size_t, int, double, bool, std::string>> rows;
+        for (size_t i = 1; i < n; ++i) {
+            rows.emplace_back(i, static_cast<int>(i % 1000) - 500, i * 0.25, i % 5 == 0, std::to_string(i));
+        }
+        gdb.add_vertices(rows);
+        bool thrown = false;
+        try {
+            gdb.add_vertices(std::vector<std::tuple<size_t, int, double, bool, std::string>>{ { n, 1, 1.0, true, "" }, { 5, 1, 1.0, true, "" } });
+        }
+        catch (const std::invalid_argument&) {
+            thrown = true;
+        }
+        assert(thrown && gdb.vertex_count() == n);
+        spoil(thrown, address);
+        // The column grew over several segments without moving the first one.
+        assert(&v0.template get_property<1>() == address);
+
+        auto v = *gdb.find_vertex(size_t(54321));
+        assert(v.get_properties() == std::make_tuple(321 - 500, 54321 * 0.25, false, std::string("54321")));
+        v.template set_property<3>(std::string("changed"));
+        assert(v.template get_property<3>() == "changed");
+
+        size_t expected = 0;
+        double sum = 0;
+        for (auto&& x : gdb.get_vertexes()) {
+            expected += x.template get_property<0>() < -400;
+            sum += x.template get_property<1>();
+        }
+        assert(gdb.template filter_vertices<0>(compare_op::lt, -400).count() == expected);
+        assert(gdb.template filter_vertices_between<1>(100.0, 200.0).count() == 401);
+        auto agg = gdb.template aggregate_vertices<1>();
+        assert(agg.count == n && agg.max == (n - 1) * 0.25 && agg.sum == sum);
+        assert(gdb.template scan_vertices<2>([](bool b) { return b; }).count() == (n - 1) / 5 + 1);
+        spoil(expected, sum, agg);
+
+        std::string path = (std::filesystem::temp_directory_path() / "graph_db_check_segmented.bin").string();
+        gdb.add_edge(size_t(1), v0, v, 1.5f);
+        gdb.save(path);
+        gdb_t loaded = gdb_t::open_mmap(path);
+        std::filesystem::remove(path);
+        assert(loaded.find_vertex(size_t(99999))->get_properties() == std::make_tuple(499, 99999 * 0.25, false, std::string("99999")));
+        assert(loaded.find_vertex(size_t(54321))->template get_property<3>() == "changed");
+        assert(loaded.find_edge(size_t(1))->template get_property<0>() == 1.5f);
+    }
+
+    struct indexed_gs {
+        using vertex_user_id_t = std::string;
+        using vertex_property_t = std::tuple<int, double, bool, std::string>;
+
+        using edge_user_id_t = size_t;
+        using edge_property_t = std::tuple<double>;
+
+        template<typename T>
+        using column_t = dictionary_column_t<T>;
+
+        using vertex_hash_indexes = std::index_sequence<0, 3>;
+        using vertex_sorted_indexes = std::index_sequence<1>;
+        using edge_sorted_indexes = std::index_sequence<0>;
+    };
+
+    static void check_property_indexes() {
+        using gdb_t = graph_db<indexed_gs>;
+        gdb_t gdb;
+        const size_t n = 1000;
+        for (size_t i = 0; i < n; ++i) {
+            gdb.add_vertex("v" + std::to_string(i), static_cast<int>(i % 10), i * 0.5, false, i % 3 == 0 ? "tri" : "x");
+        }
+        auto vertices = gdb.get_vertexes();
+        auto matching = [&gdb](const std::string& label) {
+            std::vector<size_t> rows;
+            for (auto&& v : gdb.get_vertexes()) {
+                if (v.template get_property<3>() == label) {
+                    rows.push_back(v.get_index());
+                }
+            }
+            return rows;
+        };
+        auto sorted = [](std::span<const size_t> rows) {
+            std::vector<size_t> result(rows.begin(), rows.end());
+            std::sort(result.begin(), result.end());
+            return result;
+        };
+
+        assert(gdb.template lookup_vertices<3>("tri").size() == 334);
+        vertices[1].template set_property<3>("tri");
+        vertices[0].set_properties(7, 0.0, true, "four");
+        assert(sorted(gdb.template lookup_vertices<3>("tri")) == matching("tri"));
+        assert(gdb.template lookup_vertices<3>("four").size() == 1 && gdb.template lookup_vertices<3>("four")[0] == 0);
+        assert(gdb.template lookup_vertices<3>("none").empty());
+        assert(gdb.template lookup_vertices<0>(7).size() == 101);
+
+        auto between = gdb.template lookup_vertices_between<1>(10.0, 20.0);
+        assert(sorted(between) == std::vector<size_t>({ 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40 }));
+        vertices[999].template set_property<1>(15.0);
+        vertices[30].template set_property<1>(-1.0);
+        between = gdb.template lookup_vertices_between<1>(10.0, 20.0);
+        assert(between.size() == 21 && gdb.template filter_vertices_between<1>(10.0, 20.0).count() == 21);
+        assert(std::is_sorted(between.begin(), between.end(), [&](size_t a, size_t b) {
+            return vertices[a].template get_property<1>() < vertices[b].template get_property<1>();
+        }));
+        assert(sorted(gdb.template lookup_vertices<1>(15.0)) == std::vector<size_t>({ 999 }));
+        assert(gdb.template lookup_vertices<1>(-1.0).size() == 1);
+
+        bool thrown = false;
+        try {
+            gdb.add_vertices(std::vector<std::tuple<std::string, int, double, bool, std::string>>{
+                { "new", 7, 1e9, true, "tri" }, { "v5", 7, 1e9, true, "tri" } });
+        }
+        catch (const std::invalid_argument&) {
+            thrown = true;
+        }
+        assert(thrown && sorted(gdb.template lookup_vertices<3>("tri")) == matching("tri"));
+        gdb.add_vertices(std::vector<std::tuple<std::string, int, double, bool, std::string>>{ { "new", 7, 1e9, true, "tri" } });
+        assert(gdb.template lookup_vertices<0>(7).size() == 102);
+        assert(gdb.template lookup_vertices_between<1>(1e8, 1e10).size() == 1);
+        spoil(thrown);
+
+        for (size_t i = 0; i < 100; ++i) {
+            gdb.add_edge(i, vertices[i], vertices[(i * 7) % n], i % 10 * 1.0);
+        }
+        auto e = *gdb.find_edge(size_t(42));
+        e.template set_property<0>(100.0);
+        assert(gdb.template lookup_edges_between<0>(2.0, 3.0).size() == 19);
+        assert(gdb.template lookup_edges<0>(100.0).size() == 1 && gdb.template lookup_edges<0>(100.0)[0] == e.get_index());
+
+        gdb_t copy(gdb);
+        copy.get_vertexes()[3].template set_property<3>("x");
+        assert(gdb.template lookup_vertices<3>("tri").size() == copy.template lookup_vertices<3>("tri").size() + 1);
+
+        std::string path = (std::filesystem::temp_directory_path() / "graph_db_check_property_indexes.bin").string();
+        gdb.save(path);
+        gdb_t loaded = gdb_t::open_mmap(path);
+        std::filesystem::remove(path);
+        assert(sorted(loaded.template lookup_vertices<3>("tri")) == matching("tri"));
+        assert(loaded.template lookup_vertices_between<1>(10.0, 20.0).size() == 21);
+        assert(loaded.template lookup_edges_between<0>(2.0, 3.0).size() == 19);
+
+        // NaN keys can be erased again, numbers are looked up exactly like filter_vertices compares them.
+        graph_db<nan_gs> ndb;
+        for (size_t i = 0; i < 10; ++i) {
+            ndb.add_vertex(i, i * 0.5, static_cast<int>(i));
+        }
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        auto v3 = *ndb.find_vertex(size_t(3));
+        auto v4 = *ndb.find_vertex(size_t(4));
+        v3.template set_property<0>(nan);
+        v4.template set_property<0>(nan);
+        v3.template set_property<0>(nan);
+        assert(ndb.template lookup_vertices<0>(nan).empty());
+        v3.template set_property<0>(7.0);
+        v4.template set_property<0>(7.0);
+        assert(ndb.template lookup_vertices<0>(7.0).size() == 2 && ndb.template lookup_vertices<0>(1.0).size() == 1);
+        assert(ndb.template lookup_vertices<1>(2.5).empty() && ndb.template lookup_vertices<1>(2.0).size() == 1);
+        assert(ndb.template lookup_vertices<1>(int64_t(1) << 32).empty() && ndb.template lookup_vertices<1>(-1e300).empty());
+        assert(ndb.template lookup_vertices<1>(2.5).size() == ndb.template filter_vertices<1>(compare_op::eq, 2.5).count());
+
+        // NaNs sort last in a sorted index, the first concurrent lookups merge the pending rows.
+        for (size_t i = 0; i < 100; ++i) {
+            ndb.add_edge(i, *ndb.find_vertex(i % 10), *ndb.find_vertex((i + 1) % 10), i % 4 == 0 ? nan : i * 1.0);
+        }
+        const graph_db<nan_gs>& reader = ndb;
+        std::vector<size_t> found(8);
+        std::vector<std::thread> readers;
+        for (size_t t = 0; t < found.size(); ++t) {
+            readers.emplace_back([&reader, &found, t]() {
+                found[t] = reader.template lookup_edges_between<0>(0.0, 1e9).size();
+            });
+        }
+        for (auto&& t : readers) {
+            t.join();
+        }
+        for (size_t f : found) {
+            assert(f == 75);
+        }
+        assert(reader.template lookup_edges<0>(nan).empty() && reader.template lookup_edges_between<0>(nan, 1e9).empty());
+        assert(reader.template lookup_edges_between<0>(-1e300, std::numeric_limits<double>::infinity()).size() == 75);
+        (*ndb.find_edge(size_t(4))).template set_property<0>(50.5);
+        assert(ndb.template lookup_edges_between<0>(50.0, 51.0).size() == 3);
+    }
+
+    struct nan_gs {
+        using vertex_user_id_t = size_t;
+        using vertex_property_t = std::tuple<double, int>;
+
+        using edge_user_id_t = size_t;
+        using edge_property_t = std::tuple<double>;
+
+        using vertex_hash_indexes = std::index_sequence<0, 1>;
+        using edge_sorted_indexes = std::index_sequence<0>;
+    };
+
+    struct tombstone_gs {
+        using vertex_user_id_t = std::string;
+        using vertex_property_t = std::tuple<int, double, std::string>;
+
+        using edge_user_id_t = size_t;
+        using edge_property_t = std::tuple<double>;
+
+        using vertex_hash_indexes = std::index_sequence<2>;
+        using edge_sorted_indexes = std::index_sequence<0>;
+    };
+
+    static void check_removal() {
+        using gdb_t = graph_db<tombstone_gs>;
+        gdb_t gdb;
+        const size_t n = 200;
+        for (size_t i = 0; i < n; ++i) {
+            gdb.add_vertex("v" + std::to_string(i), static_cast<int>(i), i * 1.0, i % 2 ? "odd" : "even");
+        }
+        for (size_t i = 0; i < n; ++i) {
+            gdb.add_edge(2 * i, gdb.vertex_at(i), gdb.vertex_at((i + 1) % n), 1.0);
+            gdb.add_edge(2 * i + 1, gdb.vertex_at(i), gdb.vertex_at((i * 3) % n), 2.0);
+        }
+        auto count = [](auto&& range) {
+            size_t c = 0;
+            for (auto&& x : range) {
+                spoil(x);
+                ++c;
+            }
+            return c;
+        };
+
+        gdb.remove_edge(*gdb.find_edge(size_t(5)));
+        assert(!gdb.find_edge(size_t(5)) && gdb.removed_edge_count() == 1 && count(gdb.get_edges()) == 2 * n - 1);
+        bool thrown = false;
+        try {
+            gdb.remove_edge(gdb.edge_at(5));
+        }
+        catch (const std::invalid_argument&) {
+            thrown = true;
+        }
+        assert(thrown);
+        assert(gdb.vertex_at(2).degree() == 1 && count(gdb.vertex_at(2).edges()) == 1);
+
+        // v10 has the forward edges 20, 21 and the incoming edges 18 (from v9) and 141 (from v70).
+        gdb.remove_vertex(*gdb.find_vertex("v10"));
+        assert(!gdb.find_vertex("v10") && gdb.removed_edge_count() == 5);
+        assert(gdb.vertex_at(9).degree() == 1 && (*gdb.vertex_at(9).edges().begin()).get_index() == 19);
+        thrown = false;
+        try {
+            gdb.add_edge(size_t(1000), gdb.vertex_at(10), gdb.vertex_at(11));
+        }
+        catch (const std::invalid_argument&) {
+            thrown = true;
+        }
+        assert(thrown);
+        spoil(thrown);
+
+        // Whole words of tombstones are skipped in both directions.
+        for (size_t i = 64; i < 192; ++i) {
+            gdb.remove_vertex(gdb.vertex_at(i));
+        }
+        size_t live = n - 1 - 128;
+        auto vertices = gdb.get_vertexes();
+        assert(count(vertices) == live);
+        std::vector<size_t> backwards;
+        for (auto it = vertices.end(); it != vertices.begin();) {
+            --it;
+            backwards.push_back(it.get_index());
+        }
+        assert(backwards.size() == live && backwards[7] == 192 && backwards[8] == 63);
+        // Arithmetic, subscripts and sizes skip removed elements like increments do.
+        auto check_arithmetic = [](auto&& range) {
+            std::vector<size_t> stepped;
+            for (auto it = range.begin(); it != range.end(); ++it) {
+                stepped.push_back(it.get_index());
+            }
+            auto size = static_cast<std::ptrdiff_t>(stepped.size());
+            assert(std::ranges::ssize(range) == size && range.end() - range.begin() == size);
+            for (std::ptrdiff_t k = 0; k < size; ++k) {
+                auto it = range.begin() + k;
+                assert(it.get_index() == stepped[k] && range[k].get_index() == stepped[k]);
+                assert(it - range.begin() == k && range.end() - it == size - k && range.end() - (size - k) == it);
+                assert(k == 0 || it - 1 == std::ranges::prev(it));
+            }
+            spoil(size);
+        };
+        check_arithmetic(vertices);
+        check_arithmetic(gdb.get_edges());
+        check_arithmetic(gdb.vertex_at(9).edges());
+        assert(std::ranges::size(gdb.vertex_at(9).edges()) == 1 && gdb.vertex_at(9).edges()[0].get_index() == 19);
+        for (auto&& e : gdb.get_edges()) {
+            assert(!gdb.vertex_removed(e.src().get_index()) && !gdb.vertex_removed(e.dst().get_index()));
+        }
+
+        assert(gdb.template filter_vertices<0>(compare_op::ge, 0).count() == live);
+        size_t odd = 0;
+        for (auto&& v : vertices) {
+            odd += v.template get_property<2>() == "odd";
+        }
+        assert(odd == 36 && gdb.template scan_vertices<2>([](std::string_view x) { return x == "odd"; }).count() == odd);
+        assert(gdb.template lookup_vertices<2>("odd").size() == odd);
+        auto agg = gdb.template aggregate_vertices<1>();
+        assert(agg.count == live && agg.max == 199.0);
+        spoil(agg);
+        auto depths = bfs_depths(gdb, { 0 });
+        assert(depths[9] == 3 && depths[11] == bfs_unreachable);
+        for (size_t i = 64; i < 192; ++i) {
+            assert(depths[i] == bfs_unreachable);
+        }
+
+        auto again = gdb.add_vertex("v10", 10, 10.0, "even");
+        gdb.add_edge(size_t(5), again, gdb.vertex_at(0), 3.0);
+        assert(gdb.find_vertex("v10")->get_index() == n);
+
+        // A failed batch leaves removed ids out of the index and re-added ones on their live row.
+        thrown = false;
+        try {
+            gdb.add_vertices(std::vector<std::tuple<std::string, int, double, std::string>>{
+                { "w0", 0, 0.0, "even" }, { "w1", 1, 1.0, "odd" }, { "w0", 2, 2.0, "even" } });
+        }
+        catch (const std::invalid_argument&) {
+            thrown = true;
+        }
+        assert(thrown && gdb.vertex_count() == n + 1 && !gdb.find_vertex("w0") && !gdb.find_vertex("w1"));
+        assert(!gdb.find_vertex("v64") && gdb.find_vertex("v10")->get_index() == n);
+        thrown = false;
+        try {
+            gdb.add_edges(std::vector<std::tuple<size_t, gdb_t::vertex_t, gdb_t::vertex_t, double>>{
+                { size_t(2000), gdb.vertex_at(0), gdb.vertex_at(1), 1.0 }, { size_t(0), gdb.vertex_at(1), gdb.vertex_at(2), 1.0 } });
+        }
+        catch (const std::invalid_argument&) {
+            thrown = true;
+        }
+        assert(thrown && gdb.edge_count() == 2 * n + 1 && !gdb.find_edge(size_t(2000)));
+        assert(gdb.find_edge(size_t(0))->get_index() == 0 && gdb.find_edge(size_t(5))->get_index() == 2 * n);
+        assert(!gdb.find_edge(size_t(18)) && !gdb.find_edge(size_t(20)));
+
+        std::vector<std::string> ids;
+        std::vector<std::tuple<size_t, std::string, std::string>> edges;
+        for (auto&& v : gdb.get_vertexes()) {
+            ids.emplace_back(v.id());
+        }
+        for (auto&& e : gdb.get_edges()) {
+            edges.emplace_back(e.id(), std::string(e.src().id()), std::string(e.dst().id()));
+        }
+        std::string path = (std::filesystem::temp_directory_path() / "graph_db_check_removal.bin").string();
+        gdb.save(path);
+        gdb_t loaded = gdb_t::open_mmap(path);
+        std::filesystem::remove(path);
+
+        for (gdb_t* db : { &gdb, &loaded }) {
+            db->compact();
+            assert(db->vertex_count() == ids.size() && db->edge_count() == edges.size());
+            assert(db->removed_vertex_count() == 0 && db->removed_edge_count() == 0);
+            size_t i = 0;
+            for (auto&& v : db->get_vertexes()) {
+                assert(v.id() == ids[i] && v.get_index() == i);
+                assert(db->find_vertex(ids[i])->get_index() == i);
+                ++i;
+            }
+            i = 0;
+            for (auto&& e : db->get_edges()) {
+                assert(edges[i] == std::make_tuple(e.id(), std::string(e.src().id()), std::string(e.dst().id())));
+                ++i;
+            }
+            assert(db->template lookup_vertices<2>("odd").size() == odd);
+            assert(db->template lookup_edges_between<0>(2.5, 3.5).size() == 1);
+            assert(db->find_vertex("v9")->degree() == 1 && db->find_vertex("v10")->degree() == 1);
+        }
+
+        graph_db<reverse_gs> rdb;
+        for (size_t i = 0; i < 10; ++i) {
+            rdb.add_vertex(i, static_cast<int>(i));
+        }
+        for (size_t i = 0; i < 30; ++i) {
+            rdb.add_edge(i, rdb.vertex_at(i % 10), rdb.vertex_at(i * 7 % 10), 1.0);
+        }
+        size_t incoming = rdb.vertex_at(3).in_degree();
+        size_t outgoing = rdb.vertex_at(3).degree();
+        rdb.remove_vertex(rdb.vertex_at(3));
+        assert(rdb.removed_edge_count() == incoming + outgoing);
+        assert(rdb.vertex_at(1).in_degree() == count(rdb.vertex_at(1).in_edges()));
+        rdb.compact();
+        assert(rdb.vertex_count() == 9 && rdb.edge_count() == 30 - (incoming + outgoing));
+        for (auto&& e : rdb.get_edges()) {
+            assert(e.src().id() != 3 && e.dst().id() != 3);
+        }
+        assert(build_reverse_index(rdb).targets_array() == rdb.backward_index().targets_array());
+    }
+
+    struct csv_gs {
+        using vertex_user_id_t = std::string;
+        using vertex_property_t = std::tuple<int, double, bool, std::string>;
+
+        using edge_user_id_t = size_t;
+        using edge_property_t = std::tuple<double>;
+
+        using vertex_hash_indexes = std::index_sequence<3>;
+    };
+
+    static void check_csv_import() {
+        auto dir = std::filesystem::temp_directory_path();
+        std::string vertex_path = (dir / "graph_db_check_csv_vertices.csv").string();
+        std::string edge_path = (dir / "graph_db_check_csv_edges.csv").string();
+        std::string list_path = (dir / "graph_db_check_csv_list.txt").string();
+        const size_t n = 2000;
+        {
+            std::ofstream vertices(vertex_path, std::ios::binary);
+            vertices << "id,number,half,flag,label\n";
+            for (size_t i = 0; i < n; ++i) {
+                vertices << "v" << i << "," << static_cast<int>(i) - 1000 << "," << i * 0.5 << "," << (i % 2 ? "true" : "0") << ",";
+                if (i % 7 == 0) {
+                    vertices << "\"a, \"\"quoted\"\" label\"\r\n";
+                }
+                else {
+                    vertices << "plain" << i % 3 << "\n";
+                }
+            }
+            std::ofstream edges(edge_path, std::ios::binary);
+            edges << "id,src,dst,weight\n";
+            for (size_t i = 0; i < n; ++i) {
+                edges << i << ",v" << i << ",v" << (i * 7 + 1) % n << "," << i * 0.25 << "\n";
+            }
+        }
+
+        using gdb_t = graph_db<csv_gs>;
+        gdb_t gdb;
+        // Small chunks split the files into many pieces parsed in parallel, their order must be kept.
+        csv_options options;
+        options.chunk_bytes = 100;
+        auto vertices = import_vertices(gdb, vertex_path, options);
+        assert(vertices.size() == n && gdb.vertex_count() == n);
+        for (size_t i = 0; i < n; ++i) {
+            auto v = gdb.find_vertex("v" + std::to_string(i));
+            assert(v && v->get_index() == i);
+            std::string label = i % 7 == 0 ? "a, \"quoted\" label" : "plain" + std::to_string(i % 3);
+            assert(v->get_properties() == std::make_tuple(static_cast<int>(i) - 1000, i * 0.5, i % 2 == 1, label));
+        }
+        assert(gdb.template lookup_vertices<3>("a, \"quoted\" label").size() == (n + 6) / 7);
+
+        auto edges = import_edges(gdb, edge_path, options);
+        assert(edges.size() == n && gdb.edge_count() == n);
+        for (auto&& e : gdb.get_edges()) {
+            size_t i = e.id();
+            assert(e.get_index() == i && e.template get_property<0>() == i * 0.25);
+            assert(e.src().get_index() == i && e.dst().get_index() == (i * 7 + 1) % n);
+        }
+
+        // Malformed files are rejected with the line number and leave the database unchanged.
+        auto rejects = [&](const std::string& text, const std::string& message, auto import) {
+            {
+                std::ofstream file(list_path, std::ios::binary);
+                file << text;
+            }
+            try {
+                import();
+                assert(false);
+            }
+            catch (const std::exception& e) {
+                assert(std::string(e.what()) == message);
+            }
+        };
+        rejects("id,number,half,flag,label\nw1,1,1,1,x\nw2,1,x,1,x\n", "csv_import: malformed line 3",
+            [&] { import_vertices(gdb, list_path); });
+        rejects("w1,1,1,1\n", "csv_import: malformed line 1", [&] {
+            csv_options no_header;
+            no_header.header = false;
+            import_vertices(gdb, list_path, no_header);
+        });
+        rejects("id,number,half,flag,label\nw1,1,1,1,\"open\n", "csv_import: malformed line 2",
+            [&] { import_vertices(gdb, list_path); });
+        rejects("id,src,dst,weight\n5000,v1,w1,1\n", "csv_import: unknown edge endpoint",
+            [&] { import_edges(gdb, list_path); });
+        rejects("id,src,dst,weight\n0,v1,v2,1\n", "graph_db: duplicate edge user id",
+            [&] { import_edges(gdb, list_path); });
+        assert(gdb.vertex_count() == n && gdb.edge_count() == n);
+
+        // A whitespace separated edge list without edge ids whose vertexes are created on the fly.
+        {
+            std::ofstream list(list_path, std::ios::binary);
+            list << "# comment\n";
+            for (size_t i = 0; i < 300; ++i) {
+                list << 1000 + i % 100 << "\t " << 1000 + (i * 3) % 100 << " " << i << "  \n";
+            }
+        }
+        graph_db<reverse_gs> rdb;
+        rdb.add_vertex(size_t(1050), 7);
+        csv_options edge_list;
+        edge_list.delimiter = ' ';
+        edge_list.comment = '#';
+        edge_list.header = false;
+        edge_list.edge_ids = false;
+        edge_list.add_missing_vertices = true;
+        edge_list.chunk_bytes = 64;
+        import_edges(rdb, list_path, edge_list);
+        assert(rdb.vertex_count() == 100 && rdb.edge_count() == 300);
+        assert(rdb.vertex_at(0).id() == 1050 && rdb.vertex_at(0).template get_property<0>() == 7);
+        assert(rdb.vertex_at(1).id() == 1000 && rdb.vertex_at(1).template get_property<0>() == 0);
+        for (auto&& e : rdb.get_edges()) {
+            size_t i = e.id();
+            assert(e.get_index() == i && e.template get_property<0>() == static_cast<double>(i));
+            assert(e.src().id() == 1000 + i % 100 && e.dst().id() == 1000 + (i * 3) % 100);
+        }
+        assert(rdb.find_vertex(size_t(1050))->in_degree() == 3);
+        // Generated edge ids continue after the edges already present.
+        {
+            std::ofstream list(list_path, std::ios::binary);
+            list << "1000 1001 0.5";
+        }
+        assert((*import_edges(rdb, list_path, edge_list).begin()).id() == 300);
+        // compact() lowers the edge count below the largest id, generated ids must still be fresh.
+        rdb.remove_edge(*rdb.find_edge(size_t(0)));
+        rdb.compact();
+        assert(rdb.edge_count() == 300);
+        assert((*import_edges(rdb, list_path, edge_list).begin()).id() == 301);
+        // A duplicate edge id is found before the missing endpoint 4242 is added.
+        edge_list.edge_ids = true;
+        rejects("900 1000 1001 1\n5 1000 4242 1\n", "graph_db: duplicate edge user id",
+            [&] { import_edges(rdb, list_path, edge_list); });
+        rejects("900 1000 1001 1\n900 1000 4242 1\n", "graph_db: duplicate edge user id",
+            [&] { import_edges(rdb, list_path, edge_list); });
+        assert(rdb.vertex_count() == 100 && rdb.edge_count() == 301 && !rdb.find_vertex(size_t(4242)));
+
+        std::filesystem::remove(vertex_path);
+        std::filesystem::remove(edge_path);
+        std::filesystem::remove(list_path);
+    }
+
+    struct analytics_gs {
+        using vertex_user_id_t = size_t;
+        using vertex_property_t = std::tuple<double, size_t, int>;
+
+        using edge_user_id_t = size_t;
+        using edge_property_t = std::tuple<int>;
+
+        using vertex_hash_indexes = std::index_sequence<1>;
+    };
+
+    template<class Gdb>
+    static std::vector<double> reference_pagerank(const Gdb& db, double damping) {
+        size_t n = db.vertex_count();
+        size_t live = n - db.removed_vertex_count();
+        std::vector<double> rank(n, 0);
+        for (auto&& v : db.get_vertexes()) {
+            rank[v.get_index()] = 1.0 / live;
+        }
+        for (size_t iteration = 0; iteration < 1000; ++iteration) {
+            std::vector<double> next(n, 0);
+            double dangling = 0;
+            for (auto&& v : db.get_vertexes()) {
+                if (v.degree() == 0) {
+                    dangling += rank[v.get_index()];
+                }
+            }
+            for (auto&& v : db.get_vertexes()) {
+                next[v.get_index()] = (1 - damping + damping * dangling) / live;
+            }
+            for (auto&& e : db.get_edges()) {
+                next[e.dst().get_index()] += damping * rank[e.src().get_index()] / e.src().degree();
+            }
+            rank = next;
+        }
+        return rank;
+    }
+
+    template<class Gdb>
+    static std::vector<size_t> reference_components(const Gdb& db) {
+        std::vector<size_t> parent(db.vertex_count());
+        for (size_t v = 0; v < parent.size(); ++v) {
+            parent[v] = v;
+        }
+        auto find = [&parent](size_t x) {
+            while (parent[x] != x) {
+                x = parent[x];
+            }
+            return x;
+        };
+        for (auto&& e : db.get_edges()) {
+            size_t u = find(e.src().get_index());
+            size_t v = find(e.dst().get_index());
+            parent[std::max(u, v)] = std::min(u, v);
+        }
+        std::vector<size_t> component(parent.size());
+        for (size_t v = 0; v < parent.size(); ++v) {
+            component[v] = find(v);
+        }
+        return component;
+    }
+
+    static void check_analytics() {
+        using gdb_t = graph_db<analytics_gs>;
+        gdb_t gdb;
+        const size_t n = 3000;
+        for (size_t i = 0; i < n; ++i) {
+            gdb.add_vertex(i, 0.0, size_t(0), static_cast<int>(i));
+        }
+        auto vertices = gdb.get_vertexes();
+        size_t edges = 0;
+        // Blocks of 30 vertexes closed into cycles, every third one also linked backwards,
+        // and edges skipping over block boundaries from every 500th vertex.
+        for (size_t i = 0; i < n; ++i) {
+            size_t next = i % 30 == 29 ? i - 29 : i + 1;
+            gdb.add_edge(edges++, vertices[i], vertices[next], 0);
+            if (i % 3 == 0) {
+                gdb.add_edge(edges++, vertices[next], vertices[i], 0);
+            }
+            if (i % 500 == 7) {
+                gdb.add_edge(edges++, vertices[i], vertices[(i * 37 + 11) % n], 0);
+            }
+        }
+        // Vertexes without outgoing edges.
+        for (size_t i = 0; i < 10; ++i) {
+            gdb.add_vertex(n + i, 0.0, size_t(0), 0);
+            gdb.add_edge(edges++, vertices[i * 7], gdb.vertex_at(n + i), 0);
+        }
+
+        auto check_pagerank = [](const auto& db) {
+            auto ranks = pagerank(db, 0.85, 1000, 1e-14);
+            auto expected = reference_pagerank(db, 0.85);
+            double sum = 0;
+            for (size_t v = 0; v < ranks.size(); ++v) {
+                assert(std::abs(ranks[v] - expected[v]) < 1e-9);
+                sum += ranks[v];
+            }
+            assert(std::abs(sum - 1) < 1e-9);
+        };
+        check_pagerank(gdb);
+        // A ring alone ranks all its vertexes equally.
+        {
+            graph_db<reverse_gs> ring;
+            for (size_t i = 0; i < 100; ++i) {
+                ring.add_vertex(i, 0);
+            }
+            for (size_t i = 0; i < 100; ++i) {
+                ring.add_edge(i, ring.vertex_at(i), ring.vertex_at((i + 1) % 100), 1.0);
+            }
+            for (double rank : pagerank(ring)) {
+                assert(std::abs(rank - 0.01) < 1e-12);
+            }
+        }
+
+        auto check_components = [](const auto& db) {
+            auto components = connected_components(db);
+            assert(components == reference_components(db));
+            return components;
+        };
+        auto components = check_components(gdb);
+        assert(components[29] == 0 && components[270] == 0 && components[n] == 0 && components[n + 9] == 60);
+
+        // Removals split components and drop out of the ranks.
+        gdb.remove_edge(*gdb.find_edge(0));
+        gdb.remove_edge(*gdb.find_edge(1));
+        for (auto&& e : gdb.vertex_at(14).edges()) {
+            gdb.remove_edge(e);
+        }
+        gdb.remove_vertex(vertices[45]);
+        check_pagerank(gdb);
+        components = check_components(gdb);
+        assert(components[45] == 45 && components[1] == 1 && components[14] == 1 && components[15] == 0);
+
+        pagerank_into<0>(gdb, 0.85, 1000, 1e-14);
+        connected_components_into<1>(gdb);
+        auto ranks = pagerank(gdb, 0.85, 1000, 1e-14);
+        for (auto&& v : gdb.get_vertexes()) {
+            assert(v.template get_property<0>() == ranks[v.get_index()]);
+            assert(v.template get_property<1>() == components[v.get_index()]);
+        }
+        assert(gdb.template lookup_vertices<1>(size_t(1)).size() == static_cast<size_t>(std::ranges::count(components, size_t(1))));
+        assert(gdb.template lookup_vertices<1>(size_t(45)).empty());
+
+        // The reverse index of the schema is used when it has one.
+        graph_db<reverse_gs> rdb;
+        for (size_t i = 0; i < 1000; ++i) {
+            rdb.add_vertex(i, 0);
+        }
+        for (size_t i = 0; i < 1500; ++i) {
+            rdb.add_edge(i, rdb.vertex_at((i * 7) % 1000), rdb.vertex_at((i * 13 + 5) % 1000), 1.0);
+        }
+        check_pagerank(rdb);
+        connected_components_into<0>(rdb);
+        auto expected = reference_components(rdb);
+        for (auto&& v : rdb.get_vertexes()) {
+            assert(static_cast<size_t>(v.template get_property<0>()) == expected[v.get_index()]);
+        }
+    }
+
+    struct sorted_gs {
+        using vertex_user_id_t = size_t;
+        using vertex_property_t = std::tuple<int>;
+
+        using edge_user_id_t = size_t;
+        using edge_property_t = std::tuple<double>;
+
+        static constexpr bool reverse_index = true;
+        static constexpr bool sorted_adjacency = true;
+    };
+
+    static void check_intersections() {
+        std::mt19937_64 rng(7);
+        auto random_set = [&rng](size_t n, size_t range) {
+            std::vector<size_t> values(n);
+            for (auto&& x : values) {
+                x = rng() % range;
+            }
+            std::sort(values.begin(), values.end());
+            values.erase(std::unique(values.begin(), values.end()), values.end());
+            return values;
+        };
+        std::vector<simd_level> levels = { simd_level::scalar };
+        if (detected_simd_level() != simd_level::scalar) {
+            levels.push_back(simd_level::avx2);
+        }
+        if (detected_simd_level() == simd_level::avx512) {
+            levels.push_back(simd_level::avx512);
+        }
+        for (auto [na, nb, range] : { std::tuple(0, 10, 10), std::tuple(7, 9, 20), std::tuple(100, 120, 300),
+            std::tuple(1000, 1000, 1500), std::tuple(3, 5000, 10000), std::tuple(5000, 40, 6000) }) {
+            auto a = random_set(na, range);
+            auto b = random_set(nb, range);
+            std::vector<size_t> expected;
+            std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+            for (simd_level level : levels) {
+                std::vector<size_t> out(std::min(a.size(), b.size()));
+                out.resize(simd_intersect(a.data(), a.size(), b.data(), b.size(), out.data(), level));
+                assert(out == expected);
+                assert(simd_intersect_count(a.data(), a.size(), b.data(), b.size(), level) == expected.size());
+            }
+        }
+
+        // Repeated values are reported once and never overflow min(na, nb) slots.
+        auto random_multiset = [&rng](size_t n, size_t range) {
+            std::vector<size_t> values(n);
+            for (auto&& x : values) {
+                x = rng() % range;
+            }
+            std::sort(values.begin(), values.end());
+            return values;
+        };
+        std::vector<std::pair<std::vector<size_t>, std::vector<size_t>>> repeated = {
+            { std::vector<size_t>(8, 5), { 5, 6, 7, 8 } },
+            { std::vector<size_t>(20, 5), std::vector<size_t>(9, 5) },
+            { { 1, 2, 2, 3, 3, 3, 3, 4, 9, 9, 9, 9, 9, 9, 9, 9, 9, 10 }, { 2, 3, 3, 9, 9, 9, 9, 9, 9, 9, 9, 10, 10 } },
+            { random_multiset(1000, 300), random_multiset(800, 300) },
+            { random_multiset(3, 5), random_multiset(500, 5) },
+        };
+        for (auto&& [a, b] : repeated) {
+            std::vector<size_t> ua = a;
+            std::vector<size_t> ub = b;
+            ua.erase(std::unique(ua.begin(), ua.end()), ua.end());
+            ub.erase(std::unique(ub.begin(), ub.end()), ub.end());
+            std::vector<size_t> expected;
+            std::set_intersection(ua.begin(), ua.end(), ub.begin(), ub.end(), std::back_inserter(expected));
+            for (simd_level level : levels) {
+                const size_t guard = 12345;
+                std::vector<size_t> out(std::min(a.size(), b.size()) + 1, guard);
+                size_t count = simd_intersect(a.data(), a.size(), b.data(), b.size(), out.data(), level);
+                assert(out.back() == guard);
+                out.resize(count);
+                assert(out == expected);
+                assert(simd_intersect_count(b.data(), b.size(), a.data(), a.size(), level) == expected.size());
+            }
+        }
+
+        // Edges listed by destination, whatever the order of insertion, removal, compaction or loading.
+        using gdb_t = graph_db<sorted_gs>;
+        static_assert(gdb_t::has_sorted_adjacency && !graph_db<reverse_gs>::has_sorted_adjacency);
+        gdb_t gdb;
+        graph_db<reverse_gs> plain;
+        const size_t n = 200;
+        for (size_t i = 0; i < n; ++i) {
+            gdb.add_vertex(i, 0);
+            plain.add_vertex(i, 0);
+        }
+        for (size_t i = 0; i < 3000; ++i) {
+            size_t src = rng() % n;
+            size_t dst = rng() % n;
+            gdb.add_edge(i, gdb.vertex_at(src), gdb.vertex_at(dst), 0.0);
+            plain.add_edge(i, plain.vertex_at(src), plain.vertex_at(dst), 0.0);
+        }
+        for (size_t i = 0; i < 40; ++i) {
+            gdb.add_edge(5000 + i, gdb.vertex_at(i % 2), gdb.vertex_at(7), 0.0);
+            plain.add_edge(5000 + i, plain.vertex_at(i % 2), plain.vertex_at(7), 0.0);
+        }
+        auto check_sorted = [](const gdb_t& db) {
+            for (auto&& v : db.get_vertexes()) {
+                std::vector<std::pair<size_t, size_t>> out;
+                for (auto&& e : v.edges()) {
+                    out.emplace_back(e.dst().get_index(), e.get_index());
+                }
+                assert(std::is_sorted(out.begin(), out.end()) && out.size() == v.degree());
+                std::vector<std::pair<size_t, size_t>> in;
+                for (auto&& e : v.in_edges()) {
+                    in.emplace_back(e.src().get_index(), e.get_index());
+                }
+                assert(std::is_sorted(in.begin(), in.end()) && in.size() == v.in_degree());
+            }
+        };
+        check_sorted(gdb);
+
+        auto brute_common = [](const auto& db, size_t v1, size_t v2) {
+            std::vector<size_t> a;
+            std::vector<size_t> b;
+            for (auto&& e : db.vertex_at(v1).edges()) {
+                a.push_back(e.dst().get_index());
+            }
+            for (auto&& e : db.vertex_at(v2).edges()) {
+                b.push_back(e.dst().get_index());
+            }
+            std::sort(a.begin(), a.end());
+            std::sort(b.begin(), b.end());
+            std::vector<size_t> common;
+            std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(common));
+            common.erase(std::unique(common.begin(), common.end()), common.end());
+            return common;
+        };
+        auto check_common = [&brute_common](const auto& db) {
+            for (size_t v1 = 0; v1 < 40; ++v1) {
+                for (size_t v2 = 0; v2 < 40; ++v2) {
+                    if (db.vertex_removed(v1) || db.vertex_removed(v2)) {
+                        continue;
+                    }
+                    std::vector<size_t> common;
+                    for (auto&& v : db.common_neighbors(db.vertex_at(v1), db.vertex_at(v2))) {
+                        common.push_back(v.get_index());
+                    }
+                    assert(common == brute_common(db, v1, v2));
+                }
+            }
+        };
+        check_common(gdb);
+        check_common(plain);
+
+        for (size_t i = 0; i < 3000; i += 7) {
+            gdb.remove_edge(gdb.edge_at(i));
+            plain.remove_edge(plain.edge_at(i));
+        }
+        gdb.remove_vertex(gdb.vertex_at(5));
+        plain.remove_vertex(plain.vertex_at(5));
+        for (size_t i = 3000; i < 3200; ++i) {
+            size_t src = rng() % 5;
+            size_t dst = 6 + rng() % (n - 6);
+            gdb.add_edge(i, gdb.vertex_at(src), gdb.vertex_at(dst), 0.0);
+            plain.add_edge(i, plain.vertex_at(src), plain.vertex_at(dst), 0.0);
+        }
+        check_sorted(gdb);
+        check_common(gdb);
+        check_common(plain);
+        assert(count_triangles(gdb) == count_triangles(plain));
+
+        gdb.compact();
+        check_sorted(gdb);
+        check_common(gdb);
+        std::string path = (std::filesystem::temp_directory_path() / "graph_db_check_intersections.bin").string();
+        plain.save(path);
+        auto loaded = gdb_t::open_mmap(path);
+        std::filesystem::remove(path);
+        check_sorted(loaded);
+        check_common(loaded);
+
+        // Triangles against a brute force count over the undirected simple graph.
+        auto brute_triangles = [](const auto& db) {
+            size_t count = db.vertex_count();
+            std::vector<std::vector<bool>> adjacent(count, std::vector<bool>(count, false));
+            for (auto&& e : db.get_edges()) {
+                size_t u = e.src().get_index();
+                size_t v = e.dst().get_index();
+                adjacent[u][v] = adjacent[v][u] = u != v;
+            }
+            size_t triangles = 0;
+            for (size_t u = 0; u < count; ++u) {
+                for (size_t v = u + 1; v < count; ++v) {
+                    for (size_t w = v + 1; w < count && adjacent[u][v]; ++w) {
+                        triangles += adjacent[u][w] && adjacent[v][w];
+                    }
+                }
+            }
+            return triangles;
+        };
+        size_t triangles = count_triangles(loaded);
+        assert(triangles == brute_triangles(loaded) && triangles == count_triangles(plain));
+        assert(triangles == brute_triangles(gdb) && triangles > 0);
+
+        graph_db<reverse_gs> clique;
+        for (size_t i = 0; i < 10; ++i) {
+            clique.add_vertex(i, 0);
+        }
+        size_t edges = 0;
+        for (size_t i = 0; i < 10; ++i) {
+            clique.add_edge(edges++, clique.vertex_at(i), clique.vertex_at(i), 1.0);
+            for (size_t j = 0; j < 10; ++j) {
+                if (i != j) {
+                    clique.add_edge(edges++, clique.vertex_at(i), clique.vertex_at(j), 1.0);
+                }
+            }
+        }
+        assert(count_triangles(clique) == 120);
+    }
+
+    struct reorder_gs {
+        using vertex_user_id_t = std::string;
+        using vertex_property_t = std::tuple<int, bool, std::string>;
+
+        using edge_user_id_t = size_t;
+        using edge_property_t = std::tuple<double>;
+
+        template<typename T>
+        using column_t = compact_column_t<T>;
+
+        static constexpr bool reverse_index = true;
+        using vertex_hash_indexes = std::index_sequence<2>;
+    };
+
+    static void check_reorder() {
+        // A 12 x 25 grid whose vertexes are inserted in a shuffled order.
+        using gdb_t = graph_db<reorder_gs>;
+        const size_t rows = 12;
+        const size_t cols = 25;
+        const size_t n = rows * cols;
+        std::vector<size_t> cells(n);
+        for (size_t i = 0; i < n; ++i) {
+            cells[i] = i;
+        }
+        std::shuffle(cells.begin(), cells.end(), std::mt19937_64(11));
+        gdb_t gdb;
+        for (size_t cell : cells) {
+            gdb.add_vertex("c" + std::to_string(cell), static_cast<int>(cell), cell % 3 == 0, "s" + std::to_string(cell % 5));
+        }
+        size_t edge = 0;
+        for (size_t cell = 0; cell < n; ++cell) {
+            auto v = *gdb.find_vertex("c" + std::to_string(cell));
+            if (cell % cols + 1 < cols) {
+                gdb.add_edge(edge, v, *gdb.find_vertex("c" + std::to_string(cell + 1)), edge * 0.5);
+                ++edge;
+            }
+            if (cell + cols < n) {
+                gdb.add_edge(edge, *gdb.find_vertex("c" + std::to_string(cell + cols)), v, edge * 0.5);
+                ++edge;
+            }
+        }
+
+        std::vector<std::string> ids;
+        for (auto&& v : gdb.get_vertexes()) {
+            ids.emplace_back(v.id());
+        }
+        std::vector<std::tuple<size_t, std::string, std::string, double>> edges;
+        for (auto&& e : gdb.get_edges()) {
+            edges.emplace_back(e.id(), e.src().id(), e.dst().id(), e.template get_property<0>());
+        }
+        auto bandwidth = [](const gdb_t& db) {
+            size_t width = 0;
+            for (auto&& e : db.get_edges()) {
+                size_t u = e.src().get_index();
+                size_t v = e.dst().get_index();
+                width = std::max(width, u > v ? u - v : v - u);
+            }
+            return width;
+        };
+        auto ranks = pagerank(gdb);
+        auto check_same = [&](const gdb_t& db) {
+            auto reordered_ranks = pagerank(db);
+            size_t i = 0;
+            for (auto&& v : db.get_vertexes()) {
+                assert(v.id() == ids[i] && db.find_vertex(ids[i])->get_index() == v.get_index());
+                size_t cell = std::stoul(ids[i].substr(1));
+                assert(v.template get_property<0>() == static_cast<int>(cell) && v.template get_property<1>() == (cell % 3 == 0));
+                assert(v.template get_property<2>() == "s" + std::to_string(cell % 5));
+                assert(std::abs(reordered_ranks[v.get_index()] - ranks[gdb.find_vertex(ids[i])->get_index()]) < 1e-12);
+                ++i;
+            }
+            assert(i == ids.size());
+            i = 0;
+            for (auto&& e : db.get_edges()) {
+                assert(edges[i] == std::make_tuple(e.id(), std::string(e.src().id()), std::string(e.dst().id()), e.template get_property<0>()));
+                ++i;
+            }
+            assert(db.template lookup_vertices<2>("s1").size() == n / 5);
+            assert(build_reverse_index(db).targets_array() == db.backward_index().targets_array());
+        };
+
+        thread_pool pool(3);
+        for (vertex_order strategy : { vertex_order::degree, vertex_order::bfs, vertex_order::rcm }) {
+            gdb_t db(gdb);
+            db.reorder(strategy, pool);
+            check_same(db);
+            if (strategy == vertex_order::degree) {
+                for (size_t v = 1; v < n; ++v) {
+                    auto a = db.vertex_at(v - 1);
+                    auto b = db.vertex_at(v);
+                    assert(a.degree() + a.in_degree() >= b.degree() + b.in_degree());
+                }
+            }
+            else if (strategy == vertex_order::bfs) {
+                // Edge directions are ignored, so the depths are those of the undirected grid.
+                std::vector<size_t> depths(n, bfs_unreachable);
+                std::vector<size_t> queue = { 0 };
+                depths[0] = 0;
+                for (size_t head = 0; head < queue.size(); ++head) {
+                    auto u = db.vertex_at(queue[head]);
+                    auto visit = [&](size_t w) {
+                        if (depths[w] == bfs_unreachable) {
+                            depths[w] = depths[u.get_index()] + 1;
+                            queue.push_back(w);
+                        }
+                    };
+                    for (auto&& e : u.edges()) {
+                        visit(e.dst().get_index());
+                    }
+                    for (auto&& e : u.in_edges()) {
+                        visit(e.src().get_index());
+                    }
+                }
+                assert(queue.size() == n && std::is_sorted(depths.begin(), depths.end()));
+            }
+            else {
+                assert(bandwidth(db) <= 2 * rows && bandwidth(gdb) > 4 * rows);
+            }
+
+            // Insertion order survives removal, appends, compaction and snapshots.
+            db.remove_vertex(*db.find_vertex(ids[7]));
+            db.add_vertex("extra", -1, false, "s9");
+            std::vector<std::string> expected = ids;
+            expected.erase(expected.begin() + 7);
+            expected.push_back("extra");
+            auto listed = [](const gdb_t& x) {
+                std::vector<std::string> out;
+                for (auto&& v : x.get_vertexes()) {
+                    out.emplace_back(v.id());
+                }
+                std::vector<std::string> backwards;
+                auto vertices = x.get_vertexes();
+                for (auto it = vertices.end(); it != vertices.begin();) {
+                    --it;
+                    backwards.emplace_back((*it).id());
+                }
+                std::reverse(backwards.begin(), backwards.end());
+                assert(out == backwards && std::ranges::size(vertices) == out.size());
+                for (size_t k = 0; k < out.size(); k += 7) {
+                    assert(vertices[k].id() == out[k] && static_cast<size_t>(vertices.end() - (vertices.begin() + k)) == out.size() - k);
+                }
+                return out;
+            };
+            assert(listed(db) == expected);
+            std::string path = (std::filesystem::temp_directory_path() / "graph_db_check_reorder.bin").string();
+            db.save(path);
+            gdb_t loaded = gdb_t::open_mmap(path);
+            std::filesystem::remove(path);
+            db.compact(pool);
+            assert(listed(db) == expected && listed(loaded) == expected);
+            for (size_t v = 0; v < db.vertex_count(); ++v) {
+                assert(loaded.vertex_at(v).id() == db.vertex_at(v).id());
+            }
+
+            db.reorder(vertex_order::insertion);
+            size_t i = 0;
+            for (auto&& v : db.get_vertexes()) {
+                assert(v.id() == expected[i] && v.get_index() == i);
+                ++i;
+            }
+        }
+
+        std::vector<int> values = { 0, 1, 2, 3, 4, 5 };
+        std::vector<bool> flags = { true, false, false, true, true, false };
+        std::vector<size_t> order = { 3, 0, 5, 1, 2, 4 };
+        column_permute(values, order);
+        column_permute(flags, order);
+        assert(values == std::vector<int>({ 3, 0, 5, 1, 2, 4 }));
+        assert(flags == std::vector<bool>({ true, true, false, false, false, true }));
+    }
+
+    struct instrumented_gs {
+        using vertex_user_id_t = size_t;
+        using vertex_property_t = std::tuple<int>;
+
+        using edge_user_id_t = size_t;
+        using edge_property_t = std::tuple<double>;
+
+        static constexpr bool reverse_index = true;
+        static constexpr bool instrumented = true;
+    };
+
+    static void check_instrumentation() {
+        using gdb_t = graph_db<instrumented_gs>;
+        static_assert(gdb_t::has_instrumentation && !graph_db<gs>::has_instrumentation);
+        static_assert(std::is_empty_v<graph_instruments<false>>);
+
+        for (uint64_t value : { uint64_t(0), uint64_t(31), uint64_t(32), uint64_t(47), uint64_t(1000), uint64_t(123456789), UINT64_MAX }) {
+            size_t b = latency_histogram::bucket_of(value);
+            assert(b < latency_histogram::bucket_count);
+            assert(latency_histogram::bucket_floor(b) <= value && value <= latency_histogram::bucket_ceiling(b));
+            assert(latency_histogram::bucket_ceiling(b) - latency_histogram::bucket_floor(b) <= value / latency_histogram::sub_count);
+        }
+        assert(latency_histogram::bucket_of(UINT64_MAX) == latency_histogram::bucket_count - 1);
+        latency_histogram h;
+        for (uint64_t value = 1; value <= 1000; ++value) {
+            h.record(value);
+        }
+        assert(h.count() == 1000 && h.min() == 1 && h.max() == 1000 && h.sum() == 500500);
+        assert(h.quantile(0) == 1 && h.quantile(1) == 1000);
+        for (double q : { 0.5, 0.9, 0.99 }) {
+            double exact = q * 999 + 1;
+            assert(h.quantile(q) >= exact && h.quantile(q) <= exact * 17 / 16 + 1);
+        }
+        latency_histogram other;
+        other.record(5000, 10);
+        h.merge(other);
+        assert(h.count() == 1010 && h.max() == 5000 && h.quantile(1) == 5000);
+
+        gdb_t gdb;
+        std::vector<typename gdb_t::vertex_t> vertices;
+        for (size_t i = 0; i < 10; ++i) {
+            vertices.push_back(gdb.add_vertex(i, static_cast<int>(i)));
+        }
+        std::vector<std::tuple<size_t, int>> vertex_rows;
+        for (size_t i = 10; i < 30; ++i) {
+            vertex_rows.emplace_back(i, static_cast<int>(i));
+        }
+        gdb.add_vertices(vertex_rows);
+        for (size_t e = 0; e < 15; ++e) {
+            gdb.add_edge(e, vertices[e % 10], vertices[(e * 3 + 1) % 10], 1.0);
+        }
+        std::vector<std::tuple<size_t, typename gdb_t::vertex_t, typename gdb_t::vertex_t, double>> edge_rows;
+        for (size_t e = 15; e < 20; ++e) {
+            edge_rows.emplace_back(e, vertices[0], vertices[e % 10], 2.0);
+        }
+        gdb.add_edges(edge_rows);
+        vertices[3].set_property<0>(-3);
+        (*gdb.find_edge(4)).set_property<0>(4.5);
+        assert(gdb.find_vertex(7) && !gdb.find_vertex(100) && !gdb.find_edge(100));
+        size_t scanned = 0;
+        for (size_t i = 0; i < 4; ++i) {
+            for (auto&& e : vertices[i].edges()) {
+                spoil(e);
+                ++scanned;
+            }
+        }
+        for (auto&& e : vertices[1].in_edges()) {
+            spoil(e);
+            ++scanned;
+        }
+        assert(std::ranges::distance(gdb.get_vertexes()) == 30);
+
+        graph_stats stats = gdb.stats();
+        assert(stats[graph_op::add_vertex].calls == 11 && stats[graph_op::add_vertex].items == 30);
+        assert(stats[graph_op::add_edge].calls == 16 && stats[graph_op::add_edge].items == 20);
+        assert(stats[graph_op::set_property].calls == 2 && stats[graph_op::set_property].items == 2);
+        assert(stats[graph_op::id_lookup].calls == 4 && stats[graph_op::id_lookup].items == 2);
+        assert(stats[graph_op::neighbor_scan].calls == 5 && stats[graph_op::neighbor_scan].items == scanned);
+        assert(stats[graph_op::traversal].calls == 1 && stats[graph_op::traversal].items == 30);
+        for (const operation_stats& op : stats.operations) {
+            assert(op.latency.count() == op.calls);
+            assert(op.calls == 0 || (op.latency.min() <= op.latency.quantile(0.5) && op.latency.quantile(0.5) <= op.latency.max()));
+        }
+        assert(stats.vertex_column_growths > 0 && stats.edge_column_growths > 0);
+        assert(stats.vertex_capacity >= 30 && stats.edge_capacity >= 20);
+
+        gdb.reserve_vertices(1000);
+        size_t growths = gdb.stats().vertex_column_growths;
+        assert(gdb.stats().vertex_capacity >= 1000);
+        for (size_t i = 30; i < 1000; ++i) {
+            gdb.add_vertex(i, 0);
+        }
+        assert(gdb.stats().vertex_column_growths == growths);
+        gdb.add_vertex(1000, 0);
+        assert(gdb.stats().vertex_column_growths == growths + 1);
+
+        std::ostringstream out;
+        stats.write_prometheus(out, "test_db");
+        std::string text = out.str();
+        assert(text.find("test_db_calls_total{op=\"add_edge\"} 16\n") != std::string::npos);
+        assert(text.find("test_db_items_total{op=\"id_lookup\"} 2\n") != std::string::npos);
+        assert(text.find("test_db_latency_seconds{op=\"add_vertex\",quantile=\"0.99\"} ") != std::string::npos);
+        assert(text.find("test_db_latency_seconds_count{op=\"traversal\"} 1\n") != std::string::npos);
+        assert(text.find("# TYPE test_db_column_capacity gauge\n") != std::string::npos);
+
+        gdb_t copy(gdb);
+        assert(copy.stats()[graph_op::add_edge].calls == 16);
+        gdb.reset_stats();
+        assert(gdb.stats()[graph_op::add_edge].calls == 0 && gdb.stats()[graph_op::add_edge].latency.count() == 0);
+        assert(copy.stats()[graph_op::add_edge].calls == 16);
+        gdb.add_edge(20, vertices[1], vertices[2], 0.0);
+        assert(gdb.stats()[graph_op::add_edge].calls == 1);
+    }
+
+    struct wal_gs {
+        using vertex_user_id_t = std::string;
+        using vertex_property_t = std::tuple<int, bool, std::string, double>;
+
+        using edge_user_id_t = int64_t;
+        using edge_property_t = std::tuple<std::string, float>;
+
+        template<typename T>
+        using column_t = compact_column_t<T>;
+
+        static constexpr bool reverse_index = true;
+    };
+
+    /**
+     * @brief Lists every live vertex and edge with its properties, sorted, to compare databases by content.
+     */
+    static std::vector<std::string> wal_contents(const graph_db<wal_gs>& gdb) {
+        std::vector<std::string> lines;
+        for (auto&& v : gdb.get_vertexes()) {
+            auto [i, b, str, d] = v.get_properties();
+            std::ostringstream line;
+            line << "v " << v.id() << ' ' << i << ' ' << b << ' ' << str << ' ' << d;
+            lines.push_back(line.str());
+        }
+        for (auto&& e : gdb.get_edges()) {
+            auto [str, f] = e.get_properties();
+            std::ostringstream line;
+            line << "e " << e.id() << ' ' << e.src().id() << ' ' << e.dst().id() << ' ' << str << ' ' << f;
+            lines.push_back(line.str());
+        }
+        std::sort(lines.begin(), lines.end());
+        return lines;
+    }
+
+    static void check_wal() {
+        using gdb_t = graph_db<wal_gs>;
+        assert(crc32c("123456789", 9) == 0xE3069283);
+        assert(crc32c("56789", 5, crc32c("1234", 4)) == 0xE3069283);
+
+        std::vector<std::byte> bytes;
+        wal_encoder out(bytes);
+        out.put<int>(-1);
+        out.put<int64_t>(std::numeric_limits<int64_t>::min());
+        out.put<uint64_t>(std::numeric_limits<uint64_t>::max());
+        out.put<size_t>(127);
+        out.put<bool>(true);
+        out.put<std::string>(std::string_view("abc"));
+        out.put<double>(2.5);
+        assert(bytes.size() == 1 + 10 + 10 + 1 + 1 + 4 + 8);
+        wal_decoder in(bytes.data(), bytes.data() + bytes.size());
+        assert(in.get<int>() == -1);
+        assert(in.get<int64_t>() == std::numeric_limits<int64_t>::min());
+        assert(in.get<uint64_t>() == std::numeric_limits<uint64_t>::max());
+        assert(in.get<size_t>() == 127 && in.get<bool>() && in.get<std::string>() == "abc" && in.get<double>() == 2.5);
+        assert(in.done());
+        bool thrown = false;
+        try {
+            in.get<int>();
+        }
+        catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+
+        std::string log_path = (std::filesystem::temp_directory_path() / "graph_db_check_wal.log").string();
+        std::string snapshot_path = (std::filesystem::temp_directory_path() / "graph_db_check_wal.bin").string();
+        std::filesystem::remove(log_path);
+        std::filesystem::remove(snapshot_path);
+
+        gdb_t gdb;
+        gdb.open_log(log_path, wal_options{ std::chrono::milliseconds(1) });
+        auto a = gdb.add_vertex("a", 1, true, "alpha", 1.5);
+        auto b = gdb.add_vertex("b");
+        std::vector<std::tuple<std::string, int, bool, std::string, double>> vertex_rows;
+        for (int i = 0; i < 50; ++i) {
+            vertex_rows.emplace_back("r" + std::to_string(i), i, i % 2 == 0, std::string(i % 5, 's'), i * 0.25);
+        }
+        auto added = gdb.add_vertices(vertex_rows);
+        gdb.add_edge(int64_t(-7), a, b, "ab", 0.5f);
+        gdb.add_edge(int64_t(8), b, a);
+        std::vector<std::tuple<int64_t, gdb_t::vertex_t, gdb_t::vertex_t, std::string, float>> edge_rows;
+        for (int64_t i = 0; i < 49; ++i) {
+            edge_rows.emplace_back(100 + i, added[i], added[i + 1], "chain", static_cast<float>(i));
+        }
+        gdb.add_edges(edge_rows);
+        b.set_property<2>("beta");
+        b.set_properties(2, false, "bravo", -2.0);
+        gdb.find_edge(8)->set_property<1>(8.5f);
+        gdb.find_edge(-7)->set_properties("changed", -1.0f);
+        gdb.remove_edge(*gdb.find_edge(100));
+        gdb.remove_vertex(*gdb.find_vertex("r10"));
+        gdb.add_vertex("r10", 10, false, "again", 0.0);
+        std::vector<int> values(gdb.vertex_count());
+        for (size_t i = 0; i < values.size(); ++i) {
+            values[i] = static_cast<int>(i * 3);
+        }
+        gdb.set_vertex_column<0>(values);
+        gdb.compact();
+        gdb.reorder(vertex_order::degree);
+        uint64_t position = gdb.sync_log();
+        assert(position == gdb.log_position() && position > 100);
+        gdb.close_log();
+        std::vector<std::string> expected = wal_contents(gdb);
+        assert(expected.size() == 52 + 48);
+
+        {
+            gdb_t replayed;
+            replayed.open_log(log_path);
+            assert(wal_contents(replayed) == expected);
+            assert(replayed.log_position() == position);
+        }
+
+        // Nothing is replayed twice, the log goes on behind the records it has.
+        gdb.open_log(log_path);
+        gdb.find_vertex("a")->set_property<3>(3.0);
+        assert(gdb.log_position() == position + 1);
+        // A crash between writing a snapshot and emptying the log leaves records the snapshot holds.
+        gdb.sync_log();
+        gdb.save(snapshot_path);
+        {
+            gdb_t recovered = gdb_t::open_mmap(snapshot_path);
+            assert(recovered.log_position() == position + 1);
+            recovered.open_log(log_path);
+            assert(wal_contents(recovered) == wal_contents(gdb));
+        }
+
+        gdb.checkpoint(snapshot_path);
+        assert(std::filesystem::file_size(log_path) == sizeof(wal_format::header));
+        assert(!std::filesystem::exists(snapshot_path + ".tmp"));
+        gdb.add_vertex("after", 7, true, "checkpoint", 7.0);
+        gdb.find_vertex("b")->set_property<1>(true);
+        gdb.close_log();
+        {
+            gdb_t recovered = gdb_t::open_mmap(snapshot_path);
+            recovered.open_log(log_path);
+            assert(wal_contents(recovered) == wal_contents(gdb));
+            assert(recovered.log_position() == position + 3);
+        }
+
+        // The log lacks the records between an empty database and the checkpoint.
+        thrown = false;
+        try {
+            gdb_t fresh;
+            fresh.open_log(log_path);
+        }
+        catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+        thrown = false;
+        try {
+            graph_db<reverse_gs> other;
+            other.open_log(log_path);
+        }
+        catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+        std::filesystem::remove(log_path);
+        std::filesystem::remove(snapshot_path);
+    }
+
+    static void check_wal_recovery() {
+        using gdb_t = graph_db<wal_gs>;
+        std::string log_path = (std::filesystem::temp_directory_path() / "graph_db_check_wal_recovery.log").string();
+        std::string crash_path = (std::filesystem::temp_directory_path() / "graph_db_check_wal_crash.log").string();
+        std::filesystem::remove(log_path);
+
+        // Every step is committed as a frame of its own, ends[k] and states[k] are what a crash after k steps leaves.
+        std::vector<size_t> ends;
+        std::vector<std::vector<std::string>> states;
+        {
+            gdb_t gdb;
+            gdb.open_log(log_path, wal_options{ std::chrono::hours(1) });
+            ends.push_back(std::filesystem::file_size(log_path));
+            states.push_back(wal_contents(gdb));
+            for (int step = 0; step < 40; ++step) {
+                std::string id = "v" + std::to_string(step);
+                auto v = gdb.add_vertex(id, step, step % 2 == 0, std::string(step % 9, 'x'), step * 0.5);
+                if (step > 0) {
+                    gdb.add_edge(int64_t(step), *gdb.find_vertex("v" + std::to_string(step - 1)), v, id, static_cast<float>(step));
+                }
+                if (step % 3 == 0) {
+                    gdb.find_vertex("v" + std::to_string(step / 2))->set_property<2>("set" + id);
+                }
+                if (step % 5 == 4 && gdb.find_edge(step - 3)) {
+                    gdb.remove_edge(*gdb.find_edge(step - 3));
+                }
+                if (step % 7 == 6) {
+                    gdb.remove_vertex(*gdb.find_vertex("v" + std::to_string(step - 6)));
+                }
+                gdb.sync_log();
+                ends.push_back(std::filesystem::file_size(log_path));
+                states.push_back(wal_contents(gdb));
+            }
+        }
+        std::string log;
+        {
+            std::ifstream file(log_path, std::ios::binary);
+            log.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        }
+        assert(log.size() == ends.back());
+
+        auto recover = [&](const std::string& bytes) {
+            {
+                std::ofstream file(crash_path, std::ios::binary | std::ios::trunc);
+                file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+            }
+            gdb_t gdb;
+            gdb.open_log(crash_path, wal_options{ std::chrono::milliseconds(0) });
+            return gdb;
+        };
+        auto state_at = [&](size_t length) {
+            size_t k = 0;
+            while (k + 1 < ends.size() && ends[k + 1] <= length) {
+                ++k;
+            }
+            return states[k];
+        };
+
+        // A crash tears the log at any byte, recovery keeps exactly the frames committed in full.
+        std::vector<size_t> cuts = { 0, 10, sizeof(wal_format::header) - 1 };
+        for (size_t k = 0; k + 1 < ends.size(); k += 3) {
+            for (size_t cut : { ends[k], ends[k] + 1, ends[k] + sizeof(wal_format::frame_header), ends[k + 1] - 1 }) {
+                cuts.push_back(cut);
+            }
+        }
+        std::mt19937_64 rng(25);
+        for (int i = 0; i < 20; ++i) {
+            cuts.push_back(rng() % log.size());
+        }
+        for (size_t cut : cuts) {
+            gdb_t gdb = recover(log.substr(0, cut));
+            assert(wal_contents(gdb) == state_at(cut));
+        }
+
+        // The torn tail is cut off, so records logged after the recovery are found behind the intact frames.
+        {
+            size_t cut = ends[20] + 5;
+            gdb_t gdb = recover(log.substr(0, cut));
+            gdb.add_vertex("after crash", -1, true, "", 0.0);
+            gdb.close_log();
+            gdb_t again;
+            again.open_log(crash_path);
+            std::vector<std::string> expected = states[20];
+            expected.push_back("v after crash -1 1  0");
+            std::sort(expected.begin(), expected.end());
+            assert(wal_contents(again) == expected);
+        }
+
+        // A corrupted frame ends the log, as nothing behind it can be trusted.
+        {
+            std::string corrupted = log;
+            corrupted[ends[20] + sizeof(wal_format::frame_header) + 2] ^= 0x10;
+            gdb_t gdb = recover(corrupted);
+            assert(wal_contents(gdb) == states[20]);
+        }
+
+#ifndef _WIN32
+        // A process killed with records pending loses only those, the committed ones are recovered.
+        std::filesystem::remove(crash_path);
+        pid_t child = fork();
+        if (child == 0) {
+            gdb_t gdb;
+            gdb.open_log(crash_path, wal_options{ std::chrono::hours(1) });
+            gdb.add_vertex("committed", 1, true, "x", 1.0);
+            gdb.sync_log();
+            gdb.add_vertex("pending", 2, false, "y", 2.0);
+            _exit(0);
+        }
+        int status = 0;
+        waitpid(child, &status, 0);
+        assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        {
+            gdb_t gdb;
+            gdb.open_log(crash_path);
+            assert(gdb.find_vertex("committed") && !gdb.find_vertex("pending"));
+        }
+#endif
+        std::filesystem::remove(log_path);
+        std::filesystem::remove(crash_path);
+    }
+
     class test_example {
         struct gs {
             using vertex_user_id_t = std::string;
@@ -483,6 +2831,28 @@ public:
         tests.push_back(test_edge_prop_set_through_neighbors);
         tests.push_back([]() { test_algorithms t; t.run(); });
         tests.push_back([]() { test_example t; t.run(); });
+        tests.push_back(check_find);
+        tests.push_back(check_bulk);
+        tests.push_back(check_snapshot);
+        tests.push_back(check_compact_columns);
+        tests.push_back(check_scan);
+        tests.push_back(check_simd_kernels);
+        tests.push_back(check_traversal);
+        tests.push_back(check_reverse_index);
+        tests.push_back(check_arena);
+        tests.push_back(check_dictionary_columns);
+        tests.push_back(check_concurrent);
+        tests.push_back(check_segmented_columns);
+        tests.push_back(check_property_indexes);
+        tests.push_back(check_removal);
+        tests.push_back(check_csv_import);
+        tests.push_back(check_analytics);
+        tests.push_back(check_intersections);
+        tests.push_back(check_reorder);
+        tests.push_back(check_instrumentation);
+        tests.push_back(check_wal);
+        tests.push_back(check_wal_recovery);
+        tests.push_back(check_mapped_columns);
     }
 
     void run_test(size_t i) const {
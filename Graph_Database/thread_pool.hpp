@@ -0,0 +1,152 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <latch>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief A fixed set of worker threads executing chunked parallel loops.
+ * @note A parallel_for called from inside a worker runs sequentially on that worker, so nesting never deadlocks.
+ */
+class thread_pool {
+public:
+    /**
+     * @brief Starts the workers.
+     * @param threads The number of threads including the calling one, hardware concurrency by default.
+     */
+    explicit thread_pool(size_t threads = std::thread::hardware_concurrency())
+    {
+        size_t helpers = threads > 1 ? threads - 1 : 0;
+        for (size_t i = 0; i < helpers; ++i) {
+            workers.emplace_back([this]() { worker_loop(); });
+        }
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    ~thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto&& w : workers) {
+            w.join();
+        }
+    }
+
+    /**
+     * @brief Returns the number of threads that execute a parallel_for, the calling one included.
+     */
+    size_t size() const
+    {
+        return workers.size() + 1;
+    }
+
+    /**
+     * @brief Calls body(chunk_begin, chunk_end) for consecutive chunks of [begin, end) in parallel and waits for all of them.
+     * @param grain The number of indices in one chunk, chunks are handed out dynamically.
+     * @note The first exception thrown by the body is rethrown in the calling thread.
+     */
+    template<typename Body>
+    void parallel_for(size_t begin, size_t end, size_t grain, Body&& body)
+    {
+        if (begin >= end) {
+            return;
+        }
+        grain = std::max<size_t>(grain, 1);
+        size_t chunks = (end - begin + grain - 1) / grain;
+        size_t helpers = std::min(workers.size(), chunks - 1);
+        if (helpers == 0 || inside_worker()) {
+            for (size_t b = begin; b < end; b += grain) {
+                body(b, std::min(b + grain, end));
+            }
+            return;
+        }
+
+        std::atomic<size_t> next{ begin };
+        std::exception_ptr error;
+        std::mutex error_mutex;
+        std::latch finished(static_cast<std::ptrdiff_t>(helpers));
+        auto run = [&]() {
+            try {
+                for (size_t b = next.fetch_add(grain); b < end; b = next.fetch_add(grain)) {
+                    body(b, std::min(b + grain, end));
+                }
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                next.store(end);
+            }
+        };
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (size_t i = 0; i < helpers; ++i) {
+                tasks.emplace_back([&]() { run(); finished.count_down(); });
+            }
+        }
+        wake.notify_all();
+        run();
+        finished.wait();
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    static bool& inside_worker()
+    {
+        thread_local bool inside = false;
+        return inside;
+    }
+
+    void worker_loop()
+    {
+        inside_worker() = true;
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this]() { return stopping || !tasks.empty(); });
+                if (tasks.empty()) {
+                    return;
+                }
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+};
+
+/**
+ * @brief Returns the process-wide pool used by the parallel algorithms of graph_db.
+ */
+inline thread_pool& default_thread_pool()
+{
+    static thread_pool pool;
+    return pool;
+}
+
+#endif // !THREAD_POOL_HPP
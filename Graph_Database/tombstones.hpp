@@ -0,0 +1,268 @@
+#ifndef TOMBSTONES_HPP
+#define TOMBSTONES_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "scan.hpp"
+#include "simd_kernels.hpp"
+
+/**
+ * @brief A bitmap of removed dense indices.
+ * @note It only grows when an element is removed, bits past its end read as live. Skipping removed elements
+ * looks at whole words, so a run of 64 removed elements costs a single step.
+ * @note A Fenwick tree of the removed counts of blocks of 512 bits is kept up to date by set(),
+ * so ranks and selections of live elements cost O(log n) and never modify the bitmap.
+ */
+class tombstone_bitmap {
+public:
+    bool test(size_t i) const
+    {
+        return (i >> 6) < words.size() && ((words[i >> 6] >> (i & 63)) & 1);
+    }
+
+    /**
+     * @brief Marks the i-th element as removed.
+     * @return False if it was removed already.
+     */
+    bool set(size_t i)
+    {
+        if ((i >> 6) >= words.size()) {
+            grow((i >> 6) + 1);
+        }
+        uint64_t mask = uint64_t(1) << (i & 63);
+        if (words[i >> 6] & mask) {
+            return false;
+        }
+        words[i >> 6] |= mask;
+        ++count_;
+        for (size_t j = i / block_bits + 1; j <= tree.size(); j += j & (0 - j)) {
+            ++tree[j - 1];
+        }
+        return true;
+    }
+
+    /**
+     * @brief Returns the number of removed elements.
+     */
+    size_t count() const
+    {
+        return count_;
+    }
+
+    bool empty() const
+    {
+        return count_ == 0;
+    }
+
+    /**
+     * @brief Returns the first live index not lower than i.
+     */
+    size_t next_live(size_t i) const
+    {
+        size_t w = i >> 6;
+        if (w >= words.size()) {
+            return i;
+        }
+        uint64_t live = ~words[w] & (~uint64_t(0) << (i & 63));
+        while (live == 0) {
+            if (++w == words.size()) {
+                return w * 64;
+            }
+            live = ~words[w];
+        }
+        return w * 64 + std::countr_zero(live);
+    }
+
+    /**
+     * @brief Returns the last live index not greater than i, or -1 cast to size_t if there is none.
+     */
+    size_t prev_live(size_t i) const
+    {
+        size_t w = i >> 6;
+        if (w >= words.size()) {
+            return i;
+        }
+        uint64_t live = ~words[w] & (~uint64_t(0) >> (63 - (i & 63)));
+        while (live == 0) {
+            if (w == 0) {
+                return static_cast<size_t>(-1);
+            }
+            live = ~words[--w];
+        }
+        return w * 64 + 63 - std::countl_zero(live);
+    }
+
+    /**
+     * @brief Returns the number of removed indices below i.
+     */
+    size_t removed_before(size_t i) const
+    {
+        size_t w = i >> 6;
+        if (w >= words.size()) {
+            return count_;
+        }
+        size_t block = w / block_words;
+        size_t result = 0;
+        for (size_t j = block; j > 0; j &= j - 1) {
+            result += tree[j - 1];
+        }
+        for (size_t x = block * block_words; x < w; ++x) {
+            result += std::popcount(words[x]);
+        }
+        return result + std::popcount(words[w] & ((uint64_t(1) << (i & 63)) - 1));
+    }
+
+    /**
+     * @brief Returns the live index of the given rank, the k-th live index counted from 0.
+     */
+    size_t select_live(size_t k) const
+    {
+        // Descends the Fenwick tree to the block holding the k-th live index, then counts its words.
+        size_t block = 0;
+        for (size_t step = std::bit_floor(tree.size()); step > 0; step >>= 1) {
+            size_t next = block + step;
+            if (next <= tree.size()) {
+                size_t live = step * block_bits - tree[next - 1];
+                if (live <= k) {
+                    block = next;
+                    k -= live;
+                }
+            }
+        }
+        size_t w = block * block_words;
+        if (w >= words.size()) {
+            return w * 64 + k;
+        }
+        for (size_t live = 64 - std::popcount(words[w]); k >= live; live = 64 - std::popcount(words[w])) {
+            k -= live;
+            ++w;
+        }
+        uint64_t live = ~words[w];
+        for (; k > 0; --k) {
+            live &= live - 1;
+        }
+        return w * 64 + std::countr_zero(live);
+    }
+
+    /**
+     * @brief Returns the live indices below n in increasing order.
+     */
+    std::vector<size_t> live_indices(size_t n) const
+    {
+        std::vector<size_t> result;
+        result.reserve(n - std::min(n, count_));
+        for (size_t i = next_live(0); i < n; i = next_live(i + 1)) {
+            result.push_back(i);
+        }
+        return result;
+    }
+
+    /**
+     * @brief Clears the bits of the removed elements in a selection.
+     */
+    void exclude(selection_bitmap& selection) const
+    {
+        size_t n = std::min(words.size(), selection.word_count());
+        uint64_t* bits = selection.word_data();
+        for (size_t w = 0; w < n; ++w) {
+            bits[w] &= ~words[w];
+        }
+    }
+
+    /**
+     * @brief Checks whether any element in [b, e) is removed.
+     */
+    bool any(size_t b, size_t e) const
+    {
+        for (size_t w = b >> 6; w < words.size() && w * 64 < e; ++w) {
+            uint64_t word = words[w];
+            if (w == b >> 6) {
+                word &= ~uint64_t(0) << (b & 63);
+            }
+            if (w == (e - 1) >> 6 && (e & 63) != 0) {
+                word &= ~uint64_t(0) >> (64 - (e & 63));
+            }
+            if (word != 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void clear()
+    {
+        words.clear();
+        tree.clear();
+        count_ = 0;
+    }
+
+private:
+    static constexpr size_t block_words = 8;
+    static constexpr size_t block_bits = block_words * 64;
+
+    /**
+     * @brief Extends the bitmap to at least n words, whole blocks and at least twice the words it had, and rebuilds the tree.
+     */
+    void grow(size_t n)
+    {
+        n = std::max(n, words.size() * 2);
+        words.resize((n + block_words - 1) / block_words * block_words, 0);
+        tree.assign(words.size() / block_words, 0);
+        for (size_t b = 0; b < tree.size(); ++b) {
+            for (size_t x = b * block_words; x < (b + 1) * block_words; ++x) {
+                tree[b] += std::popcount(words[x]);
+            }
+        }
+        for (size_t j = 1; j <= tree.size(); ++j) {
+            size_t parent = j + (j & (0 - j));
+            if (parent <= tree.size()) {
+                tree[parent - 1] += tree[j - 1];
+            }
+        }
+    }
+
+    std::vector<uint64_t> words;
+    // tree[j - 1] is the number of removed indices in the blocks (j - lowbit(j), j], counted from 1.
+    std::vector<size_t> tree;
+    size_t count_ = 0;
+};
+
+/**
+ * @brief Computes min, max, sum and count of the live values of a column.
+ * @note Chunks without removed values go through the SIMD kernel, the others are summed value by value.
+ */
+template<typename Column>
+column_aggregate<typename Column::value_type> aggregate_column(const Column& column, const tombstone_bitmap& removed)
+{
+    if (removed.empty()) {
+        return aggregate_column(column);
+    }
+    using T = typename Column::value_type;
+    size_t chunks = (column.size() + scan_chunk_rows - 1) / scan_chunk_rows;
+    std::vector<column_aggregate<T>> partial(chunks);
+    default_thread_pool().parallel_for(0, column.size(), scan_chunk_rows, [&](size_t b, size_t e) {
+        auto& p = partial[b / scan_chunk_rows];
+        if (!removed.any(b, e)) {
+            p = simd_aggregate<T>(column_block(column, b), e - b);
+            return;
+        }
+        for (size_t i = removed.next_live(b); i < e; i = removed.next_live(i + 1)) {
+            T x = column_get(column, i);
+            p.min = std::min(p.min, x);
+            p.max = std::max(p.max, x);
+            p.sum += x;
+            ++p.count;
+        }
+    });
+    column_aggregate<T> result;
+    for (auto&& p : partial) {
+        result += p;
+    }
+    return result;
+}
+
+#endif // !TOMBSTONES_HPP
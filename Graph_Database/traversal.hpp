@@ -0,0 +1,310 @@
+#ifndef TRAVERSAL_HPP
+#define TRAVERSAL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+#include "graph_db.hpp"
+#include "thread_pool.hpp"
+
+/**
+ * @brief The depth of vertexes not reachable from any seed.
+ */
+inline constexpr size_t bfs_unreachable = static_cast<size_t>(-1);
+
+/**
+ * @brief A fixed-size bitmap whose bits can be set concurrently.
+ */
+class atomic_bitmap {
+public:
+    explicit atomic_bitmap(size_t n) : words((n + 63) / 64) {}
+
+    bool test(size_t i) const
+    {
+        return (words[i >> 6].load(std::memory_order_relaxed) >> (i & 63)) & 1;
+    }
+
+    /**
+     * @brief Sets the i-th bit.
+     * @return True if this call changed the bit, i.e. exactly one of concurrent callers wins.
+     */
+    bool set(size_t i)
+    {
+        uint64_t mask = uint64_t(1) << (i & 63);
+        if (words[i >> 6].load(std::memory_order_relaxed) & mask) {
+            return false;
+        }
+        return (words[i >> 6].fetch_or(mask, std::memory_order_relaxed) & mask) == 0;
+    }
+
+private:
+    std::vector<std::atomic<uint64_t>> words;
+};
+
+/**
+ * @brief Builds the CSR index of incoming edges, grouped by the destination vertex.
+ * @note For databases whose schema does not maintain one, see graph_db::backward_index(). Removed edges are left out.
+ */
+template<class GraphSchema>
+adjacency_index build_reverse_index(const graph_db<GraphSchema>& db)
+{
+    adjacency_index reverse;
+    reverse.add_vertices(db.vertex_count());
+    reverse.reserve(db.vertex_count(), db.edge_count());
+    for (size_t e = 0; e < db.edge_count(); ++e) {
+        if (!db.edge_removed(e)) {
+            reverse.add_edge(db.target_of(e), e);
+        }
+    }
+    reverse.merge();
+    return reverse;
+}
+
+/**
+ * @brief Direction-optimizing parallel breadth-first search from a set of seeds.
+ * @param db The database.
+ * @param seeds Dense indices of the vertexes at depth 0.
+ * @param pool The threads to run on.
+ * @return The depth of every vertex by its dense index, bfs_unreachable for vertexes not reached.
+ * @note Levels are expanded top-down over forward edges while the frontier is small and bottom-up
+ * over incoming edges once the frontier has more edges than 1/14 of the unexplored ones (Beamer et al.).
+ * @note Incoming edges come from the reverse index of the database if the schema enables it,
+ * otherwise it is built on the first bottom-up level. Removed edges are not followed.
+ */
+template<class GraphSchema>
+std::vector<size_t> bfs_depths(const graph_db<GraphSchema>& db, const std::vector<size_t>& seeds,
+    thread_pool& pool = default_thread_pool())
+{
+    constexpr size_t alpha = 14;
+    constexpr size_t beta = 24;
+    constexpr size_t grain = 1024;
+
+    size_t n = db.vertex_count();
+    const adjacency_index& forward = db.forward_index();
+    adjacency_index local_reverse;
+    const adjacency_index* reverse = nullptr;
+    if constexpr (graph_db<GraphSchema>::has_reverse_index) {
+        reverse = &db.backward_index();
+    }
+
+    std::vector<size_t> depth(n, bfs_unreachable);
+    atomic_bitmap visited(n);
+    std::vector<size_t> frontier;
+    for (size_t s : seeds) {
+        if (visited.set(s)) {
+            depth[s] = 0;
+            frontier.push_back(s);
+        }
+    }
+
+    size_t unexplored_edges = db.edge_count();
+    bool bottom_up = false;
+    for (size_t d = 0; !frontier.empty(); ++d) {
+        size_t frontier_edges = 0;
+        for (size_t u : frontier) {
+            frontier_edges += forward.degree(u);
+        }
+        if (!bottom_up && frontier_edges > unexplored_edges / alpha) {
+            bottom_up = true;
+        }
+        else if (bottom_up && frontier.size() < n / beta) {
+            bottom_up = false;
+        }
+        unexplored_edges -= std::min(unexplored_edges, frontier_edges);
+
+        std::vector<std::vector<size_t>> parts;
+        if (!bottom_up) {
+            parts.resize((frontier.size() + grain - 1) / grain);
+            pool.parallel_for(0, frontier.size(), grain, [&](size_t b, size_t e) {
+                auto& part = parts[b / grain];
+                for (size_t i = b; i < e; ++i) {
+                    for (size_t edge : forward.neighbors(frontier[i])) {
+                        if (db.edge_removed(edge)) {
+                            continue;
+                        }
+                        size_t v = db.target_of(edge);
+                        if (visited.set(v)) {
+                            depth[v] = d + 1;
+                            part.push_back(v);
+                        }
+                    }
+                }
+            });
+        }
+        else {
+            if (reverse == nullptr) {
+                local_reverse = build_reverse_index(db);
+                reverse = &local_reverse;
+            }
+            std::vector<uint64_t> in_frontier((n + 63) / 64, 0);
+            for (size_t u : frontier) {
+                in_frontier[u >> 6] |= uint64_t(1) << (u & 63);
+            }
+            parts.resize((n + grain - 1) / grain);
+            pool.parallel_for(0, n, grain, [&](size_t b, size_t e) {
+                auto& part = parts[b / grain];
+                for (size_t v = b; v < e; ++v) {
+                    if (visited.test(v)) {
+                        continue;
+                    }
+                    for (size_t edge : reverse->neighbors(v)) {
+                        if (db.edge_removed(edge)) {
+                            continue;
+                        }
+                        size_t u = db.source_of(edge);
+                        if ((in_frontier[u >> 6] >> (u & 63)) & 1) {
+                            visited.set(v);
+                            depth[v] = d + 1;
+                            part.push_back(v);
+                            break;
+                        }
+                    }
+                }
+            });
+        }
+
+        frontier.clear();
+        for (auto&& part : parts) {
+            frontier.insert(frontier.end(), part.begin(), part.end());
+        }
+    }
+    return depth;
+}
+
+/**
+ * @brief Parallel delta-stepping single source shortest paths from a set of seeds.
+ * @tparam I An index of the arithmetic edge property used as the weight of the edge.
+ * @param db The database.
+ * @param seeds Dense indices of the vertexes at distance 0.
+ * @param delta The width of a distance bucket, the average weight of the edges not removed when it is not positive.
+ * @param pool The threads to run on.
+ * @return The distance of every vertex by its dense index, infinity for vertexes not reached.
+ * @throws std::invalid_argument If a reachable edge has a negative weight.
+ * @note Edges not heavier than delta are relaxed repeatedly within a bucket, heavier ones once per settled vertex.
+ * @note Only buckets holding vertexes are stored, in a map, so the memory does not grow with the distances.
+ */
+template<size_t I, class GraphSchema>
+std::vector<double> sssp_delta_stepping(const graph_db<GraphSchema>& db, const std::vector<size_t>& seeds,
+    double delta = 0, thread_pool& pool = default_thread_pool())
+{
+    constexpr double infinity = std::numeric_limits<double>::infinity();
+    constexpr size_t grain = 256;
+
+    size_t n = db.vertex_count();
+    const auto& weights = db.template edge_column<I>();
+    auto weight = [&weights](size_t e) { return static_cast<double>(column_get(weights, e)); };
+    const adjacency_index& forward = db.forward_index();
+
+    if (delta <= 0) {
+        double total = 0;
+        size_t live = 0;
+        for (size_t e = 0; e < db.edge_count(); ++e) {
+            if (!db.edge_removed(e)) {
+                total += weight(e);
+                ++live;
+            }
+        }
+        delta = live > 0 && total > 0 ? total / live : 1;
+    }
+
+    std::vector<std::atomic<double>> dist(n);
+    for (auto&& d : dist) {
+        d.store(infinity, std::memory_order_relaxed);
+    }
+    // Bucket numbers stay doubles, a distance far beyond delta does not fit a size_t.
+    std::map<double, std::vector<size_t>> buckets;
+    auto bucket_of = [delta](double d) { return std::floor(d / delta); };
+    auto push = [&](size_t v, double dv) {
+        buckets[bucket_of(dv)].push_back(v);
+    };
+    for (size_t s : seeds) {
+        dist[s].store(0, std::memory_order_relaxed);
+        push(s, 0);
+    }
+
+    struct request {
+        size_t v;
+        double d;
+    };
+    auto relax = [&](const std::vector<size_t>& vertices, bool light) {
+        std::vector<std::vector<request>> parts((vertices.size() + grain - 1) / grain);
+        pool.parallel_for(0, vertices.size(), grain, [&](size_t b, size_t e) {
+            auto& part = parts[b / grain];
+            for (size_t i = b; i < e; ++i) {
+                size_t u = vertices[i];
+                double du = dist[u].load(std::memory_order_relaxed);
+                for (size_t edge : forward.neighbors(u)) {
+                    if (db.edge_removed(edge)) {
+                        continue;
+                    }
+                    double w = weight(edge);
+                    if (w < 0) {
+                        throw std::invalid_argument("sssp_delta_stepping: negative edge weight");
+                    }
+                    if ((w <= delta) != light) {
+                        continue;
+                    }
+                    size_t v = db.target_of(edge);
+                    double nd = du + w;
+                    double current = dist[v].load(std::memory_order_relaxed);
+                    while (nd < current) {
+                        if (dist[v].compare_exchange_weak(current, nd, std::memory_order_relaxed)) {
+                            part.push_back({ v, nd });
+                            break;
+                        }
+                    }
+                }
+            }
+        });
+        for (auto&& part : parts) {
+            for (auto&& r : part) {
+                push(r.v, r.d);
+            }
+        }
+    };
+
+    std::vector<size_t> last_seen(n, static_cast<size_t>(-1));
+    std::vector<size_t> last_settled(n, static_cast<size_t>(-1));
+    size_t round = 0;
+    for (size_t phase = 0; !buckets.empty(); ++phase) {
+        double i = buckets.begin()->first;
+        std::vector<size_t> settled;
+        // Light edges only lead to this bucket or later ones, so it stays the first one until it is empty.
+        while (!buckets.empty() && buckets.begin()->first == i) {
+            std::vector<size_t> frontier = std::move(buckets.begin()->second);
+            buckets.erase(buckets.begin());
+            size_t kept = 0;
+            for (size_t v : frontier) {
+                // Skips duplicates and vertexes that have moved to a lower bucket since they were pushed.
+                if (last_seen[v] == round || bucket_of(dist[v].load(std::memory_order_relaxed)) != i) {
+                    continue;
+                }
+                last_seen[v] = round;
+                frontier[kept++] = v;
+                if (last_settled[v] != phase) {
+                    last_settled[v] = phase;
+                    settled.push_back(v);
+                }
+            }
+            frontier.resize(kept);
+            ++round;
+            relax(frontier, true);
+        }
+        relax(settled, false);
+    }
+
+    std::vector<double> result(n);
+    for (size_t v = 0; v < n; ++v) {
+        result[v] = dist[v].load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+#endif // !TRAVERSAL_HPP
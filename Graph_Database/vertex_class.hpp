@@ -1,7 +1,19 @@
 #ifndef VERTEX
 #define VERTEX
 
-class neighbour_it_t;
+#include <cstddef>
+#include <ranges>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "tombstones.hpp"
+
+template<class GraphSchema>
+class graph_db;
+
+template<class GraphSchema, bool IsConst>
+class neighbor_it_t_class;
 
 
 /*
@@ -16,20 +28,46 @@ struct make_vertex_tuple<std::tuple<Ts...>> {
 };*/
 
 
-template<class GraphSchema>
+/**
+ * @brief A lightweight handle of a vertex stored in a graph_db.
+ * @tparam IsConst Whether the handle came from a const graph_db, its setters do not compile then.
+ * @note It is trivially copyable, all reads and writes go straight into the columns of the database.
+ * @note A mutable handle converts implicitly to the const one.
+ */
+template<class GraphSchema, bool IsConst = false>
 class vertex {
 public:
+    /**
+     * @brief The pointer to the database the handle reads and writes through.
+     */
+    using db_pointer = std::conditional_t<IsConst, const graph_db<GraphSchema>*, graph_db<GraphSchema>*>;
+
     //using VertexTuple = typename make_vertex_tuple< vertex_property_t>::type;
     //using PropertyTuple = typename make_vertex_tuple<GraphSchema::vertex_property_t>::type;
 
-    template<typename ID, typename ...PropsType>//TODO not compile part
-    vertex(ID newid,): vid(newid),properties()
+    vertex() = default;
+
+    /**
+     * @brief Creates a handle of a vertex of the given database.
+     * @param db The database the vertex belongs to.
+     * @param index A dense index of the vertex in the database.
+     */
+    vertex(db_pointer db, size_t index) : db(db), index(index) {}
+
+    /**
+     * @brief Converts a mutable handle to a const one.
+     */
+    template<bool OtherConst>
+        requires (IsConst && !OtherConst)
+    vertex(const vertex<GraphSchema, OtherConst>& other) : db(other.db), index(other.index) {}
 
     /**
      * @brief Returns the immutable user id of the element.
+     * @note It is a std::string_view when the schema interns the ids.
+     * @see schema_id_column
      */
-    auto id() const {
-        return vid;
+    decltype(auto) id() const {
+        return db->vertex_id(index);
     }
 
 
@@ -39,7 +77,7 @@ public:
      */
     auto get_properties() const
     {
-        return properties;
+        return db->get_vertex_properties(index);
     }
 
     /**
@@ -52,7 +90,7 @@ public:
     template<size_t I>
     decltype(auto) get_property() const
     {
-        return std::get<I>(properties);
+        return db->template get_vertex_property<I>(index);
     }
 
     /**
@@ -61,10 +99,12 @@ public:
      * @param props The value of each individual property.
      * @note Should not compile if not provided with all properties.
      */
-    template<typename ...PropsType>//TODO not compile part
-    void set_properties(PropsType &&...props)
+    template<typename ...PropsType>
+        requires (sizeof...(PropsType) == std::tuple_size_v<typename GraphSchema::vertex_property_t>)
+    void set_properties(PropsType &&...props) const
+        requires (!IsConst)
     {
-        properties = std::make_tuple(std::forward<PropsType>(props)...);
+        db->set_vertex_properties(index, std::forward<PropsType>(props)...);
     }
 
     /**
@@ -75,26 +115,101 @@ public:
      * @note The first property is on index 0.
      */
     template<size_t I, typename PropType>
-    void set_property(const PropType& prop)
+    void set_property(const PropType& prop) const
+        requires (!IsConst)
     {
-        std::get<I>(properties) = prop;
+        db->template set_vertex_property<I>(index, prop);
     }
 
     /**
      * @see graph_db::neighbor_it_t
      */
-  //  using neighbor_it_t =
-
-        /**
-         * @brief Returns begin() and end() iterators to all forward edges from the vertex
-         * @return A ranges::subrange(begin(), end()) of a neighbor iterators.
-         * @see graph_db::neighbor_it_t
-         */
-     //   std::ranges::subrange<neighbor_it_t> edges() const;
+    using neighbor_it_t = neighbor_it_t_class<GraphSchema, IsConst>;
+
+    /**
+     * @brief Returns begin() and end() iterators to all forward edges from the vertex
+     * @return A ranges::subrange(begin(), end()) of a neighbor iterators.
+     * @note Ordered by the destination vertex if the schema enables schema_sorted_adjacency.
+     * @see graph_db::neighbor_it_t
+     */
+    std::ranges::subrange<neighbor_it_t> edges() const
+    {
+        auto timer = db->instruments.time(graph_op::neighbor_scan, 0);
+        auto targets = db->adjacency.neighbors(index);
+        timer.add_items(targets.size());
+        return neighbors(targets.data(), targets.data() + targets.size());
+    }
+
+    /**
+     * @brief Returns begin() and end() iterators to all edges going to the vertex, in insertion order.
+     * @return A ranges::subrange(begin(), end()) of a neighbor iterators.
+     * @note Ordered by the source vertex if the schema enables schema_sorted_adjacency.
+     * @note Available only if the schema enables the reverse index, a scan costs O(in-degree).
+     * @see schema_reverse_index
+     */
+    std::ranges::subrange<neighbor_it_t> in_edges() const
+        requires graph_db<GraphSchema>::has_reverse_index
+    {
+        auto timer = db->instruments.time(graph_op::neighbor_scan, 0);
+        auto sources = db->reverse_adjacency.neighbors(index);
+        timer.add_items(sources.size());
+        return neighbors(sources.data(), sources.data() + sources.size());
+    }
+
+    /**
+     * @brief Returns the number of forward edges from the vertex.
+     * @note O(1) unless some edges were removed since the last graph_db::compact(), O(degree) then.
+     */
+    size_t degree() const
+    {
+        if (db->removed_edge_count() == 0) {
+            return db->adjacency.degree(index);
+        }
+        return live_count(db->adjacency.neighbors(index));
+    }
+
+    /**
+     * @brief Returns the number of edges going to the vertex.
+     * @see degree
+     */
+    size_t in_degree() const
+        requires graph_db<GraphSchema>::has_reverse_index
+    {
+        if (db->removed_edge_count() == 0) {
+            return db->reverse_adjacency.degree(index);
+        }
+        return live_count(db->reverse_adjacency.neighbors(index));
+    }
+
+    /**
+     * @brief Returns the dense index of the vertex in the database.
+     */
+    size_t get_index() const
+    {
+        return index;
+    }
 private:
-    // vertex_user_id_t id;
-    GraphSchema::vertex_user_id_t vid;
-    GraphSchema::vertex_property_t properties;
-    //std::vector<GraphSchema::neighbour_it_t> neighbours;
+    template<class, bool>
+    friend class vertex;
+
+    std::ranges::subrange<neighbor_it_t> neighbors(const size_t* first, const size_t* last) const
+    {
+        const tombstone_bitmap* removed = db->removed_edge_count() == 0 ? nullptr : &db->removed_edges;
+        return std::ranges::subrange<neighbor_it_t>(neighbor_it_t(db, first, last, removed),
+            neighbor_it_t(db, last, last, removed));
+    }
+
+    template<typename Edges>
+    size_t live_count(const Edges& edges) const
+    {
+        size_t count = 0;
+        for (size_t e : edges) {
+            count += !db->edge_removed(e);
+        }
+        return count;
+    }
+
+    db_pointer db = nullptr;
+    size_t index = 0;
 };
 #endif // !VERTEX
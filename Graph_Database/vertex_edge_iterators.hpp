@@ -1,44 +1,350 @@
 #ifndef ITERATOR
 #define ITERATOR
 
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+#include "tombstones.hpp"
+
 template<class GraphSchema>
-class vertex_it_t_class {
+class graph_db;
+
+template<class GraphSchema, bool IsConst>
+class vertex;
+
+template<class GraphSchema, bool IsConst>
+class edge;
+
+/**
+ * @brief A random access iterator over the dense index space of vertexes or edges.
+ * @tparam GraphSchema The schema of the database.
+ * @tparam Element A vertex or edge handle type, it is returned by value and its constness is kept.
+ * @note Like std::vector<bool>::iterator it dereferences to a proxy and still reports random access,
+ * so ranges algorithms and parallel scans can split a range in O(1).
+ * @note Removed elements are skipped by every operation. Increment and decrement skip them word by word
+ * through the tombstone bitmap, arithmetic, subscripts and the distance of two iterators count live elements
+ * by the ranks of the bitmap in O(log n), so it + 1 == ++it and the size of a range is its number of live elements.
+ * @note Given an order, the iterator walks positions in it and hands out the element of the dense index
+ * stored there, this is how vertexes keep their insertion order after graph_db::reorder.
+ * Removed elements are then skipped one by one and arithmetic costs O(distance) while any are removed.
+ */
+template<class GraphSchema, class Element>
+class dense_it_t_class {
 private:
-    size_t index;
+    using db_pointer = typename Element::db_pointer;
+
+    db_pointer db = nullptr;
+    size_t index = 0;
+    const tombstone_bitmap* removed = nullptr;
+    const std::vector<size_t>* order = nullptr;
+
+    size_t dense(size_t i) const {
+        return order ? (*order)[i] : i;
+    }
+
+    size_t next_live(size_t i) const {
+        if (!removed || !order) {
+            return removed ? removed->next_live(i) : i;
+        }
+        while (i < order->size() && removed->test((*order)[i])) {
+            ++i;
+        }
+        return i;
+    }
+
+    size_t prev_live(size_t i) const {
+        if (!removed || !order) {
+            return removed ? removed->prev_live(i) : i;
+        }
+        while (i != static_cast<size_t>(-1) && removed->test((*order)[i])) {
+            --i;
+        }
+        return i;
+    }
+
+    /**
+     * @brief Returns the number of live positions in [b, e), by the ranks of the bitmap unless there is an order.
+     */
+    size_t live_between(size_t b, size_t e) const {
+        if (!removed) {
+            return e - b;
+        }
+        if (!order) {
+            return (e - removed->removed_before(e)) - (b - removed->removed_before(b));
+        }
+        size_t live = 0;
+        for (size_t p = next_live(b); p < e; p = next_live(p + 1)) {
+            ++live;
+        }
+        return live;
+    }
 public:
+    using value_type = Element;
+    using reference = Element;
+    using difference_type = std::ptrdiff_t;
+    using iterator_category = std::random_access_iterator_tag;
+    using iterator_concept = std::random_access_iterator_tag;
+
+    dense_it_t_class() = default;
+
     // Constructor
-    vertex_it_t_class(size_t index) : index(index) {}
+    dense_it_t_class(db_pointer db, size_t index, const tombstone_bitmap* removed = nullptr,
+        const std::vector<size_t>* order = nullptr)
+        : db(db), index(index), removed(removed), order(order) {}
+
+    /**
+     * @brief Returns the iterator at the first live element from the given position on.
+     */
+    static dense_it_t_class first_live(db_pointer db, size_t index, const tombstone_bitmap* removed = nullptr,
+        const std::vector<size_t>* order = nullptr) {
+        dense_it_t_class it(db, index, removed, order);
+        it.index = it.next_live(index);
+        return it;
+    }
 
     // Dereference operator
-    auto operator*() const {
-        // Return the current index
-        return index;
+    reference operator*() const {
+        // Return the handle of the element at the current index
+        return Element(db, dense(index));
+    }
+
+    reference operator[](difference_type n) const {
+        return *(*this + n);
+    }
+
+    /**
+     * @brief Returns the dense index the iterator points to.
+     */
+    size_t get_index() const {
+        return dense(index);
     }
 
     // Pre-increment operator
-    vertex_it_t_class& operator++() {
-        ++index; // Increment the index
+    dense_it_t_class& operator++() {
+        // Increment the index, past removed elements if there are any
+        index = next_live(index + 1);
         return *this;
     }
 
     // Post-increment operator
-    vertex_it_t_class operator++(int) {
-        vertex_it_t_class temp = *this; // Create a copy of the current iterator
+    dense_it_t_class operator++(int) {
+        dense_it_t_class temp = *this; // Create a copy of the current iterator
         ++(*this); // Increment the index
         return temp; // Return the copy of the original iterator
     }
 
+    dense_it_t_class& operator--() {
+        index = prev_live(index - 1);
+        return *this;
+    }
+
+    dense_it_t_class operator--(int) {
+        dense_it_t_class temp = *this;
+        --(*this);
+        return temp;
+    }
+
+    dense_it_t_class& operator+=(difference_type n) {
+        if (!removed) {
+            index += n;
+        }
+        else if (!order) {
+            index = removed->select_live(index - removed->removed_before(index) + n);
+        }
+        else {
+            for (; n > 0; --n) {
+                ++*this;
+            }
+            for (; n < 0; ++n) {
+                --*this;
+            }
+        }
+        return *this;
+    }
+
+    dense_it_t_class& operator-=(difference_type n) {
+        return *this += -n;
+    }
+
+    friend dense_it_t_class operator+(dense_it_t_class it, difference_type n) {
+        return it += n;
+    }
+
+    friend dense_it_t_class operator+(difference_type n, dense_it_t_class it) {
+        return it += n;
+    }
+
+    friend dense_it_t_class operator-(dense_it_t_class it, difference_type n) {
+        return it -= n;
+    }
+
+    friend difference_type operator-(const dense_it_t_class& a, const dense_it_t_class& b) {
+        if (a.index < b.index) {
+            return -static_cast<difference_type>(a.live_between(a.index, b.index));
+        }
+        return static_cast<difference_type>(a.live_between(b.index, a.index));
+    }
+
     // Equality comparison operator
-    bool operator==(const vertex_it_t_class& other) const {
+    bool operator==(const dense_it_t_class& other) const {
         return index == other.index;
     }
 
-    // Inequality comparison operator
-    bool operator!=(const vertex_it_t_class& other) const {
-        return !(*this == other);
+    std::strong_ordering operator<=>(const dense_it_t_class& other) const {
+        return index <=> other.index;
     }
 };
 
+template<class GraphSchema, bool IsConst = false>
+using vertex_it_t_class = dense_it_t_class<GraphSchema, vertex<GraphSchema, IsConst>>;
+
+template<class GraphSchema, bool IsConst = false>
+using edge_it_t_class = dense_it_t_class<GraphSchema, edge<GraphSchema, IsConst>>;
+
+/**
+ * @brief Iterates over the forward edges of a single vertex.
+ * @note Walks the contiguous slice of the CSR adjacency index that belongs to the vertex.
+ * @note Every operation skips removed edges, arithmetic, subscripts and distances count live edges
+ * and cost O(distance) while any edges are removed, O(1) otherwise.
+ * @note Hands out const edges when IsConst is set, see edge.
+ * @see adjacency_index
+ */
+template<class GraphSchema, bool IsConst = false>
+class neighbor_it_t_class {
+private:
+    using db_pointer = typename edge<GraphSchema, IsConst>::db_pointer;
+
+    db_pointer db = nullptr;
+    const size_t* pos = nullptr;
+    const size_t* last = nullptr;
+    const tombstone_bitmap* removed = nullptr;
+
+    void skip_removed() {
+        while (removed && pos != last && removed->test(*pos)) {
+            ++pos;
+        }
+    }
+
+    /**
+     * @brief Returns the number of live edges in [b, e) of the slice.
+     */
+    size_t live_between(const size_t* b, const size_t* e) const {
+        if (!removed) {
+            return static_cast<size_t>(e - b);
+        }
+        size_t live = 0;
+        for (; b != e; ++b) {
+            live += !removed->test(*b);
+        }
+        return live;
+    }
+public:
+    using value_type = edge<GraphSchema, IsConst>;
+    using reference = edge<GraphSchema, IsConst>;
+    using difference_type = std::ptrdiff_t;
+    using iterator_category = std::random_access_iterator_tag;
+    using iterator_concept = std::random_access_iterator_tag;
+
+    neighbor_it_t_class() = default;
+
+    // Constructor
+    neighbor_it_t_class(db_pointer db, const size_t* pos, const size_t* last = nullptr,
+        const tombstone_bitmap* removed = nullptr)
+        : db(db), pos(pos), last(last), removed(removed) {
+        skip_removed();
+    }
+
+    // Dereference operator
+    reference operator*() const {
+        // Return the edge whose dense index is stored in the adjacency index
+        return value_type(db, *pos);
+    }
 
+    reference operator[](difference_type n) const {
+        return *(*this + n);
+    }
+
+    /**
+     * @brief Returns the dense index of the edge the iterator points to.
+     */
+    size_t get_index() const {
+        return *pos;
+    }
+
+    // Pre-increment operator
+    neighbor_it_t_class& operator++() {
+        ++pos;
+        skip_removed();
+        return *this;
+    }
+
+    // Post-increment operator
+    neighbor_it_t_class operator++(int) {
+        neighbor_it_t_class temp = *this;
+        ++(*this);
+        return temp;
+    }
+
+    neighbor_it_t_class& operator--() {
+        do {
+            --pos;
+        } while (removed && removed->test(*pos));
+        return *this;
+    }
+
+    neighbor_it_t_class operator--(int) {
+        neighbor_it_t_class temp = *this;
+        --(*this);
+        return temp;
+    }
+
+    neighbor_it_t_class& operator+=(difference_type n) {
+        if (!removed) {
+            pos += n;
+            return *this;
+        }
+        for (; n > 0; --n) {
+            ++*this;
+        }
+        for (; n < 0; ++n) {
+            --*this;
+        }
+        return *this;
+    }
+
+    neighbor_it_t_class& operator-=(difference_type n) {
+        return *this += -n;
+    }
+
+    friend neighbor_it_t_class operator+(neighbor_it_t_class it, difference_type n) {
+        return it += n;
+    }
+
+    friend neighbor_it_t_class operator+(difference_type n, neighbor_it_t_class it) {
+        return it += n;
+    }
+
+    friend neighbor_it_t_class operator-(neighbor_it_t_class it, difference_type n) {
+        return it -= n;
+    }
+
+    friend difference_type operator-(const neighbor_it_t_class& a, const neighbor_it_t_class& b) {
+        if (a.pos < b.pos) {
+            return -static_cast<difference_type>(a.live_between(a.pos, b.pos));
+        }
+        return static_cast<difference_type>(a.live_between(b.pos, a.pos));
+    }
+
+    // Equality comparison operator
+    bool operator==(const neighbor_it_t_class& other) const {
+        return pos == other.pos;
+    }
+
+    std::strong_ordering operator<=>(const neighbor_it_t_class& other) const {
+        return pos <=> other.pos;
+    }
+};
 
 #endif // !ITERATOR
@@ -0,0 +1,168 @@
+#ifndef VERTEX_ORDER_HPP
+#define VERTEX_ORDER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "thread_pool.hpp"
+
+/**
+ * @brief The strategies of graph_db::reorder, i.e. how dense indices are assigned to vertexes.
+ */
+enum class vertex_order {
+    /**
+     * @brief Back to the order in which the vertexes were inserted.
+     */
+    insertion,
+    /**
+     * @brief By decreasing number of edges, so the hot hubs of skewed graphs share cache lines and pages.
+     */
+    degree,
+    /**
+     * @brief In breadth-first order, so vertexes are close to the ones they were discovered from.
+     */
+    bfs,
+    /**
+     * @brief Reverse Cuthill-McKee, which keeps the endpoints of every edge close and the adjacency matrix banded.
+     */
+    rcm,
+};
+
+namespace vertex_order_detail {
+    /**
+     * @brief The adjacency of the undirected graph behind the edges, self loops left out.
+     * @note The neighbors of every vertex are sorted, so orders computed from it do not depend on the number of threads.
+     */
+    struct undirected_graph {
+        std::vector<size_t> offsets;
+        std::vector<size_t> targets;
+
+        size_t degree(size_t v) const
+        {
+            return offsets[v + 1] - offsets[v];
+        }
+    };
+
+    template<typename Endpoints>
+    undirected_graph symmetrize(size_t n, const Endpoints& src, const Endpoints& dst, thread_pool& pool)
+    {
+        constexpr size_t grain = 4096;
+
+        size_t m = src.size();
+        std::vector<std::atomic<size_t>> cursor(n + 1);
+        pool.parallel_for(0, m, grain, [&](size_t b, size_t e) {
+            for (size_t i = b; i < e; ++i) {
+                if (src[i] != dst[i]) {
+                    cursor[src[i] + 1].fetch_add(1, std::memory_order_relaxed);
+                    cursor[dst[i] + 1].fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+        undirected_graph g;
+        g.offsets.assign(n + 1, 0);
+        for (size_t v = 0; v < n; ++v) {
+            g.offsets[v + 1] = g.offsets[v] + cursor[v + 1].load(std::memory_order_relaxed);
+            cursor[v].store(g.offsets[v], std::memory_order_relaxed);
+        }
+        g.targets.resize(g.offsets[n]);
+        pool.parallel_for(0, m, grain, [&](size_t b, size_t e) {
+            for (size_t i = b; i < e; ++i) {
+                if (src[i] != dst[i]) {
+                    g.targets[cursor[src[i]].fetch_add(1, std::memory_order_relaxed)] = dst[i];
+                    g.targets[cursor[dst[i]].fetch_add(1, std::memory_order_relaxed)] = src[i];
+                }
+            }
+        });
+        pool.parallel_for(0, n, grain, [&](size_t b, size_t e) {
+            for (size_t v = b; v < e; ++v) {
+                auto first = g.targets.begin() + static_cast<std::ptrdiff_t>(g.offsets[v]);
+                auto last = g.targets.begin() + static_cast<std::ptrdiff_t>(g.offsets[v + 1]);
+                std::sort(first, last);
+            }
+        });
+        return g;
+    }
+
+    /**
+     * @brief Appends the vertexes reachable from the root in breadth-first order and marks them visited.
+     * @param by_degree Visits the new neighbors of a vertex by increasing degree, as Cuthill-McKee does.
+     */
+    inline void breadth_first(const undirected_graph& g, size_t root, bool by_degree,
+        std::vector<bool>& visited, std::vector<size_t>& order)
+    {
+        size_t head = order.size();
+        visited[root] = true;
+        order.push_back(root);
+        while (head < order.size()) {
+            size_t u = order[head++];
+            size_t first = order.size();
+            for (size_t k = g.offsets[u]; k < g.offsets[u + 1]; ++k) {
+                size_t v = g.targets[k];
+                if (!visited[v]) {
+                    visited[v] = true;
+                    order.push_back(v);
+                }
+            }
+            if (by_degree) {
+                std::stable_sort(order.begin() + static_cast<std::ptrdiff_t>(first), order.end(), [&g](size_t a, size_t b) {
+                    return g.degree(a) < g.degree(b);
+                });
+            }
+        }
+    }
+}
+
+/**
+ * @brief Computes a cache-friendly order of the vertexes of a graph given by its edge endpoints.
+ * @param strategy The order to compute, vertex_order::insertion yields the identity.
+ * @param n The number of vertexes.
+ * @param src The dense index of the source of every edge.
+ * @param dst The dense index of the destination of every edge.
+ * @param pool The threads to build the undirected adjacency on.
+ * @return The old dense index of every vertex by its new one.
+ * @note Edge directions are ignored. Ties are broken by the old index and every connected component
+ * is started from its lowest old index, or from its vertex of the lowest degree for vertex_order::rcm.
+ */
+template<typename Endpoints>
+std::vector<size_t> vertex_permutation(vertex_order strategy, size_t n, const Endpoints& src, const Endpoints& dst,
+    thread_pool& pool = default_thread_pool())
+{
+    std::vector<size_t> order(n);
+    for (size_t v = 0; v < n; ++v) {
+        order[v] = v;
+    }
+    if (strategy == vertex_order::insertion) {
+        return order;
+    }
+    vertex_order_detail::undirected_graph g = vertex_order_detail::symmetrize(n, src, dst, pool);
+    if (strategy == vertex_order::degree) {
+        std::stable_sort(order.begin(), order.end(), [&g](size_t a, size_t b) {
+            return g.degree(a) > g.degree(b);
+        });
+        return order;
+    }
+
+    std::vector<size_t> roots;
+    roots.swap(order);
+    order.reserve(n);
+    bool rcm = strategy == vertex_order::rcm;
+    if (rcm) {
+        std::stable_sort(roots.begin(), roots.end(), [&g](size_t a, size_t b) {
+            return g.degree(a) < g.degree(b);
+        });
+    }
+    std::vector<bool> visited(n, false);
+    for (size_t root : roots) {
+        if (!visited[root]) {
+            vertex_order_detail::breadth_first(g, root, rcm, visited, order);
+        }
+    }
+    if (rcm) {
+        std::reverse(order.begin(), order.end());
+    }
+    return order;
+}
+
+#endif // !VERTEX_ORDER_HPP
@@ -0,0 +1,948 @@
+#ifndef WAL_HPP
+#define WAL_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "snapshot.hpp"
+#include "thread_pool.hpp"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief The kinds of write-ahead log records, every record is its kind byte followed by its fields.
+ * @note Elements are identified by their user ids, so records stay valid across compact() and reorder().
+ */
+enum class wal_record : uint8_t {
+    /**
+     * @brief Vertex user id, all vertex properties.
+     */
+    add_vertex = 1,
+    /**
+     * @brief Edge user id, source and destination vertex user ids, all edge properties.
+     */
+    add_edge = 2,
+    /**
+     * @brief Vertex user id, the index of the property as a varint, its value.
+     */
+    set_vertex_property = 3,
+    /**
+     * @brief Edge user id, the index of the property as a varint, its value.
+     */
+    set_edge_property = 4,
+    /**
+     * @brief Vertex user id, all vertex properties.
+     */
+    set_vertex_properties = 5,
+    /**
+     * @brief Edge user id, all edge properties.
+     */
+    set_edge_properties = 6,
+    /**
+     * @brief Vertex user id, its edges are removed with it.
+     */
+    remove_vertex = 7,
+    /**
+     * @brief Edge user id.
+     */
+    remove_edge = 8,
+};
+
+/**
+ * @brief How a write_ahead_log commits its records.
+ */
+struct wal_options {
+    /**
+     * @brief How long records may wait in memory for a group commit, a background thread writes and syncs them
+     * at this interval. Zero commits every record on its own before the mutation returns.
+     */
+    std::chrono::milliseconds sync_interval{ 5 };
+    /**
+     * @brief Pending records are committed right away by the appending thread once they reach this size.
+     */
+    size_t max_pending_bytes = size_t(1) << 20;
+    /**
+     * @brief Syncs the file to the storage device on every commit. Without it, commits only survive
+     * a crash of the process, not of the machine.
+     */
+    bool fsync = true;
+};
+
+/**
+ * @brief The on-disk layout of write-ahead logs.
+ * @note The file is a header followed by frames, one per group commit. A frame header holds the number
+ * and the sequence number of its first record and a CRC-32C of itself and of the payload of records,
+ * so a frame torn by a crash is detected and the log ends before it.
+ */
+struct wal_format {
+    static constexpr char magic[8] = { 'G', 'R', 'A', 'P', 'H', 'W', 'A', 'L' };
+    static constexpr uint32_t version = 1;
+    static constexpr uint32_t byte_order = 0x01020304;
+    static constexpr uint32_t frame_magic = 0x4D52464C;
+
+    struct header {
+        char magic[8];
+        uint32_t version;
+        uint32_t byte_order;
+        uint64_t schema;
+        /**
+         * @brief The sequence number of the last record before the log, the first frame continues after it.
+         */
+        uint64_t base_sequence;
+        uint64_t reserved[2];
+    };
+
+    struct frame_header {
+        uint32_t magic;
+        uint32_t records;
+        uint64_t first_sequence;
+        uint32_t payload_size;
+        uint32_t checksum;
+    };
+};
+
+/**
+ * @brief Computes the CRC-32C (Castagnoli) of a buffer, slicing by 8 bytes.
+ * @param crc The CRC of the preceding data to continue from.
+ */
+inline uint32_t crc32c(const void* data, size_t n, uint32_t crc = 0)
+{
+    static constexpr auto table = []() {
+        std::array<std::array<uint32_t, 256>, 8> t{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c >> 1) ^ (0x82F63B78u & (0u - (c & 1)));
+            }
+            t[0][i] = c;
+        }
+        for (size_t k = 1; k < 8; ++k) {
+            for (size_t i = 0; i < 256; ++i) {
+                t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xFF];
+            }
+        }
+        return t;
+    }();
+
+    const auto* p = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+    if constexpr (std::endian::native == std::endian::little) {
+        for (; n >= 8; n -= 8, p += 8) {
+            uint64_t word;
+            std::memcpy(&word, p, sizeof(word));
+            word ^= crc;
+            crc = table[7][word & 0xFF] ^ table[6][(word >> 8) & 0xFF] ^ table[5][(word >> 16) & 0xFF]
+                ^ table[4][(word >> 24) & 0xFF] ^ table[3][(word >> 32) & 0xFF] ^ table[2][(word >> 40) & 0xFF]
+                ^ table[1][(word >> 48) & 0xFF] ^ table[0][word >> 56];
+        }
+    }
+    for (; n > 0; --n, ++p) {
+        crc = (crc >> 8) ^ table[0][(crc ^ *p) & 0xFF];
+    }
+    return ~crc;
+}
+
+/**
+ * @brief How a value of a schema type is encoded in log records.
+ * @note bool takes one byte, strings (std::string with any allocator) a varint length and their characters,
+ * integers a varint, zigzag-mapped if signed, and other trivially copyable types their bytes.
+ */
+template<typename T>
+struct wal_codec {
+    enum kind : uint32_t {
+        boolean = 1,
+        string = 2,
+        signed_varint = 3,
+        unsigned_varint = 4,
+        raw = 5,
+    };
+
+    static constexpr uint32_t encoding()
+    {
+        if constexpr (std::is_same_v<T, bool>) {
+            return boolean;
+        }
+        else if constexpr (is_snapshot_string_v<T>) {
+            return string;
+        }
+        else if constexpr (std::is_integral_v<T>) {
+            return std::is_signed_v<T> ? signed_varint : unsigned_varint;
+        }
+        else {
+            static_assert(std::is_trivially_copyable_v<T>, "wal: unsupported property type");
+            return raw;
+        }
+    }
+
+    /**
+     * @brief Identifies the encoding and the size of the type, logs of schemas with different tags are incompatible.
+     */
+    static constexpr uint64_t tag = uint64_t(encoding()) << 32 | (is_snapshot_string_v<T> ? 0 : sizeof(T));
+};
+
+/**
+ * @brief Fingerprints the encodings of the user ids and properties of a schema, see wal_format::header.
+ */
+template<class GraphSchema>
+uint64_t wal_schema_fingerprint()
+{
+    uint64_t hash = 0xCBF29CE484222325;
+    auto mix = [&hash](uint64_t value) {
+        for (int b = 0; b < 8; ++b) {
+            hash = (hash ^ ((value >> (8 * b)) & 0xFF)) * 0x100000001B3;
+        }
+    };
+    auto mix_tuple = [&mix]<typename Tuple>(std::type_identity<Tuple>) {
+        mix(std::tuple_size_v<Tuple>);
+        [&mix]<size_t ...Is>(std::index_sequence<Is...>) {
+            (mix(wal_codec<std::tuple_element_t<Is, Tuple>>::tag), ...);
+        }(std::make_index_sequence<std::tuple_size_v<Tuple>>{});
+    };
+    mix(wal_codec<typename GraphSchema::vertex_user_id_t>::tag);
+    mix(wal_codec<typename GraphSchema::edge_user_id_t>::tag);
+    mix_tuple(std::type_identity<typename GraphSchema::vertex_property_t>{});
+    mix_tuple(std::type_identity<typename GraphSchema::edge_property_t>{});
+    return hash;
+}
+
+/**
+ * @brief Appends the fields of log records to a buffer.
+ */
+class wal_encoder {
+public:
+    explicit wal_encoder(std::vector<std::byte>& bytes) : bytes(bytes) {}
+
+    void put_byte(uint8_t b)
+    {
+        bytes.push_back(static_cast<std::byte>(b));
+    }
+
+    void put_varint(uint64_t v)
+    {
+        while (v >= 0x80) {
+            put_byte(static_cast<uint8_t>(v | 0x80));
+            v >>= 7;
+        }
+        put_byte(static_cast<uint8_t>(v));
+    }
+
+    void put_raw(const void* p, size_t n)
+    {
+        const auto* first = static_cast<const std::byte*>(p);
+        bytes.insert(bytes.end(), first, first + n);
+    }
+
+    /**
+     * @brief Encodes a value as the schema type T, see wal_codec.
+     * @param value A T or what a column of T hands out, like a std::string_view for strings.
+     */
+    template<typename T, typename U>
+    void put(const U& value)
+    {
+        if constexpr (std::is_same_v<T, bool>) {
+            put_byte(static_cast<bool>(value) ? 1 : 0);
+        }
+        else if constexpr (is_snapshot_string_v<T>) {
+            std::string_view s(value);
+            put_varint(s.size());
+            put_raw(s.data(), s.size());
+        }
+        else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            int64_t v = static_cast<T>(value);
+            put_varint((static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63));
+        }
+        else if constexpr (std::is_integral_v<T>) {
+            put_varint(static_cast<uint64_t>(static_cast<T>(value)));
+        }
+        else {
+            T v(value);
+            put_raw(&v, sizeof(T));
+        }
+    }
+
+private:
+    std::vector<std::byte>& bytes;
+};
+
+/**
+ * @brief Reads the fields of log records written by wal_encoder.
+ * @note Every read is bounds-checked, a record running past its frame throws std::runtime_error.
+ */
+class wal_decoder {
+public:
+    wal_decoder(const std::byte* first, const std::byte* last) : p(first), end(last) {}
+
+    bool done() const
+    {
+        return p == end;
+    }
+
+    uint8_t get_byte()
+    {
+        need(1);
+        return static_cast<uint8_t>(*p++);
+    }
+
+    uint64_t get_varint()
+    {
+        uint64_t v = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            uint8_t b = get_byte();
+            v |= uint64_t(b & 0x7F) << shift;
+            if ((b & 0x80) == 0) {
+                return v;
+            }
+        }
+        throw std::runtime_error("wal: corrupted record");
+    }
+
+    template<typename T>
+    T get()
+    {
+        if constexpr (std::is_same_v<T, bool>) {
+            return get_byte() != 0;
+        }
+        else if constexpr (is_snapshot_string_v<T>) {
+            uint64_t n = get_varint();
+            need(n);
+            T s(reinterpret_cast<const char*>(p), static_cast<size_t>(n));
+            p += n;
+            return s;
+        }
+        else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            uint64_t v = get_varint();
+            return static_cast<T>(static_cast<int64_t>((v >> 1) ^ (0 - (v & 1))));
+        }
+        else if constexpr (std::is_integral_v<T>) {
+            return static_cast<T>(get_varint());
+        }
+        else {
+            need(sizeof(T));
+            T v;
+            std::memcpy(&v, p, sizeof(T));
+            p += sizeof(T);
+            return v;
+        }
+    }
+
+private:
+    void need(uint64_t n)
+    {
+        if (n > static_cast<uint64_t>(end - p)) {
+            throw std::runtime_error("wal: corrupted record");
+        }
+    }
+
+    const std::byte* p;
+    const std::byte* end;
+};
+
+/**
+ * @brief A decoded log record of a schema.
+ * @note Only the fields of its kind are set, a single property is stored at its place in the properties tuple.
+ */
+template<class GraphSchema>
+struct wal_entry {
+    wal_record kind = wal_record::add_vertex;
+    size_t property = 0;
+    typename GraphSchema::vertex_user_id_t vertex{};
+    typename GraphSchema::vertex_user_id_t target{};
+    typename GraphSchema::edge_user_id_t edge{};
+    typename GraphSchema::vertex_property_t vertex_properties{};
+    typename GraphSchema::edge_property_t edge_properties{};
+};
+
+namespace wal_detail {
+    template<typename Tuple>
+    void get_all(wal_decoder& in, Tuple& values)
+    {
+        std::apply([&in](auto&... value) { ((value = in.template get<std::remove_cvref_t<decltype(value)>>()), ...); }, values);
+    }
+
+    template<typename Tuple>
+    size_t get_one(wal_decoder& in, Tuple& values)
+    {
+        size_t property = static_cast<size_t>(in.get_varint());
+        bool known = [&]<size_t ...Is>(std::index_sequence<Is...>) {
+            return ((property == Is && (std::get<Is>(values) = in.template get<std::tuple_element_t<Is, Tuple>>(), true)) || ...);
+        }(std::make_index_sequence<std::tuple_size_v<Tuple>>{});
+        if (!known) {
+            throw std::runtime_error("wal: corrupted record");
+        }
+        return property;
+    }
+}
+
+/**
+ * @brief Decodes the next record.
+ * @throws std::runtime_error If the record is not valid for the schema.
+ */
+template<class GraphSchema>
+wal_entry<GraphSchema> decode_wal_entry(wal_decoder& in)
+{
+    using vertex_id_t = typename GraphSchema::vertex_user_id_t;
+    using edge_id_t = typename GraphSchema::edge_user_id_t;
+
+    wal_entry<GraphSchema> e;
+    e.kind = static_cast<wal_record>(in.get_byte());
+    switch (e.kind) {
+    case wal_record::add_vertex:
+    case wal_record::set_vertex_properties:
+        e.vertex = in.get<vertex_id_t>();
+        wal_detail::get_all(in, e.vertex_properties);
+        break;
+    case wal_record::add_edge:
+        e.edge = in.get<edge_id_t>();
+        e.vertex = in.get<vertex_id_t>();
+        e.target = in.get<vertex_id_t>();
+        wal_detail::get_all(in, e.edge_properties);
+        break;
+    case wal_record::set_vertex_property:
+        e.vertex = in.get<vertex_id_t>();
+        e.property = wal_detail::get_one(in, e.vertex_properties);
+        break;
+    case wal_record::set_edge_property:
+        e.edge = in.get<edge_id_t>();
+        e.property = wal_detail::get_one(in, e.edge_properties);
+        break;
+    case wal_record::set_edge_properties:
+        e.edge = in.get<edge_id_t>();
+        wal_detail::get_all(in, e.edge_properties);
+        break;
+    case wal_record::remove_vertex:
+        e.vertex = in.get<vertex_id_t>();
+        break;
+    case wal_record::remove_edge:
+        e.edge = in.get<edge_id_t>();
+        break;
+    default:
+        throw std::runtime_error("wal: corrupted record");
+    }
+    return e;
+}
+
+/**
+ * @brief Makes a file durable, so it survives a crash of the machine.
+ * @param directory Syncs the directory entries of the path instead, after it was created or renamed.
+ * @note Failures are ignored, it is a best effort for files written through other means than write_ahead_log.
+ */
+inline void wal_sync_path(const std::string& path, bool directory = false)
+{
+    std::string target = directory ? std::filesystem::absolute(path).parent_path().string() : path;
+#ifdef _WIN32
+    if (directory) {
+        return;
+    }
+    HANDLE file = CreateFileA(target.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file != INVALID_HANDLE_VALUE) {
+        FlushFileBuffers(file);
+        CloseHandle(file);
+    }
+#else
+    int fd = ::open(target.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        ::fsync(fd);
+        ::close(fd);
+    }
+#endif
+}
+
+/**
+ * @brief The writing end of a write-ahead log, which batches records into frames committed together.
+ * @note Records are encoded straight into the pending frame under a short lock. A commit writes the whole frame
+ * with one write and syncs it, so many records share one sync. Commits happen in the background every
+ * wal_options::sync_interval, by the appending thread when the frame grows large, or on sync().
+ * @note An I/O error makes the log unusable, it is rethrown as std::runtime_error by every later call.
+ */
+class write_ahead_log {
+public:
+    /**
+     * @brief Opens a log for appending.
+     * @param path The log file, created if missing.
+     * @param schema The fingerprint of the schema, see wal_schema_fingerprint.
+     * @param options How records are committed.
+     * @param last_sequence The sequence number of the last record in the log, or of the state the log starts from.
+     * @param valid_length The length of the intact part of an existing log, a torn tail behind it is cut off.
+     * Zero starts the log over with a new header.
+     * @throws std::runtime_error If the file cannot be opened or written.
+     */
+    write_ahead_log(const std::string& path, uint64_t schema, const wal_options& options, uint64_t last_sequence,
+        uint64_t valid_length = 0)
+        : options(options), schema(schema), last_sequence(last_sequence), durable(last_sequence)
+    {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("wal: cannot open " + path);
+        }
+#else
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("wal: cannot open " + path);
+        }
+#endif
+        try {
+            if (valid_length == 0) {
+                start_over(last_sequence);
+                wal_sync_path(path, true);
+            }
+            else {
+                truncate(valid_length);
+            }
+        }
+        catch (...) {
+            close();
+            throw;
+        }
+        pending.resize(sizeof(wal_format::frame_header));
+        if (options.sync_interval.count() > 0) {
+            flusher = std::thread([this] { run_flusher(); });
+        }
+    }
+
+    write_ahead_log(const write_ahead_log&) = delete;
+    write_ahead_log& operator=(const write_ahead_log&) = delete;
+
+    /**
+     * @brief Commits the pending records and closes the log.
+     */
+    ~write_ahead_log()
+    {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        if (flusher.joinable()) {
+            flusher.join();
+        }
+        try {
+            sync();
+        }
+        catch (const std::exception&) {
+            // Nothing to report to, the records behind the failure are lost as in a crash.
+        }
+        close();
+    }
+
+    /**
+     * @brief Appends a record to the pending frame.
+     * @param encode Writes the fields of the record into the given wal_encoder.
+     * @return The sequence number of the record.
+     * @note The record is durable once durable_sequence() reaches its sequence number.
+     */
+    template<typename Encode>
+    uint64_t append(Encode&& encode)
+    {
+        std::unique_lock lock(mutex);
+        check();
+        size_t before = pending.size();
+        try {
+            wal_encoder out(pending);
+            encode(out);
+        }
+        catch (...) {
+            pending.resize(before);
+            throw;
+        }
+        ++pending_records;
+        uint64_t sequence = ++last_sequence;
+        bool commit = options.sync_interval.count() == 0 || pending.size() >= options.max_pending_bytes;
+        lock.unlock();
+        if (commit) {
+            flush();
+        }
+        return sequence;
+    }
+
+    /**
+     * @brief Commits the pending records now.
+     * @return The sequence number of the last durable record.
+     */
+    uint64_t sync()
+    {
+        flush();
+        std::lock_guard lock(mutex);
+        return durable;
+    }
+
+    /**
+     * @brief Waits until the record with the given sequence number is committed by a group commit.
+     * @note Appending threads acknowledging their writes this way share the syncs, unlike with sync().
+     */
+    void wait_durable(uint64_t sequence)
+    {
+        if (!flusher.joinable()) {
+            flush();
+        }
+        std::unique_lock lock(mutex);
+        committed.wait(lock, [&] { return durable >= sequence || failure; });
+        check();
+    }
+
+    /**
+     * @brief Returns the sequence number of the last appended record.
+     */
+    uint64_t sequence() const
+    {
+        std::lock_guard lock(mutex);
+        return last_sequence;
+    }
+
+    /**
+     * @brief Returns the sequence number of the last committed record.
+     */
+    uint64_t durable_sequence() const
+    {
+        std::lock_guard lock(mutex);
+        return durable;
+    }
+
+    /**
+     * @brief Drops all records, the log continues after the given sequence number.
+     * @note Called once a snapshot holds all records, see graph_db::checkpoint.
+     */
+    void reset(uint64_t base_sequence)
+    {
+        flush();
+        std::lock_guard io_lock(io);
+        std::lock_guard lock(mutex);
+        check();
+        try {
+            start_over(base_sequence);
+        }
+        catch (const std::exception&) {
+            failure = std::current_exception();
+            throw;
+        }
+        last_sequence = base_sequence;
+        durable = base_sequence;
+    }
+
+private:
+    void run_flusher()
+    {
+        std::unique_lock lock(mutex);
+        while (!stopping) {
+            wake.wait_for(lock, options.sync_interval, [this] { return stopping; });
+            if (pending_records != 0 && !failure) {
+                lock.unlock();
+                try {
+                    flush();
+                }
+                catch (const std::exception&) {
+                    // Kept in failure and rethrown to the next caller.
+                }
+                lock.lock();
+            }
+        }
+    }
+
+    /**
+     * @brief Writes the pending records as one frame and syncs it, frames are written in the order of their records.
+     */
+    void flush()
+    {
+        std::lock_guard io_lock(io);
+        std::vector<std::byte> frame;
+        wal_format::frame_header h{};
+        {
+            std::lock_guard lock(mutex);
+            check();
+            if (pending_records == 0) {
+                return;
+            }
+            frame.swap(pending);
+            pending.swap(spare);
+            pending.assign(sizeof(wal_format::frame_header), std::byte{ 0 });
+            h.records = pending_records;
+            h.first_sequence = last_sequence - pending_records + 1;
+            pending_records = 0;
+        }
+        h.magic = wal_format::frame_magic;
+        h.payload_size = static_cast<uint32_t>(frame.size() - sizeof(h));
+        h.checksum = crc32c(frame.data() + sizeof(h), h.payload_size, crc32c(&h, sizeof(h)));
+        std::memcpy(frame.data(), &h, sizeof(h));
+        try {
+            write(frame.data(), frame.size());
+            if (options.fsync) {
+                sync_file();
+            }
+        }
+        catch (const std::exception&) {
+            std::lock_guard lock(mutex);
+            failure = std::current_exception();
+            committed.notify_all();
+            throw;
+        }
+        std::lock_guard lock(mutex);
+        durable = h.first_sequence + h.records - 1;
+        spare.swap(frame);
+        committed.notify_all();
+    }
+
+    void check() const
+    {
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+    }
+
+    void start_over(uint64_t base_sequence)
+    {
+        truncate(0);
+        wal_format::header h{};
+        std::memcpy(h.magic, wal_format::magic, sizeof(h.magic));
+        h.version = wal_format::version;
+        h.byte_order = wal_format::byte_order;
+        h.schema = schema;
+        h.base_sequence = base_sequence;
+        write(&h, sizeof(h));
+        sync_file();
+    }
+
+    void truncate(uint64_t length)
+    {
+#ifdef _WIN32
+        LARGE_INTEGER position;
+        position.QuadPart = static_cast<LONGLONG>(length);
+        if (!SetFilePointerEx(file, position, nullptr, FILE_BEGIN) || !SetEndOfFile(file)) {
+            throw std::runtime_error("wal: write failed");
+        }
+#else
+        if (::ftruncate(fd, static_cast<off_t>(length)) != 0 || ::lseek(fd, static_cast<off_t>(length), SEEK_SET) < 0) {
+            throw std::runtime_error("wal: write failed");
+        }
+#endif
+    }
+
+    void write(const void* data, size_t n)
+    {
+        const auto* p = static_cast<const char*>(data);
+        while (n > 0) {
+#ifdef _WIN32
+            DWORD written = 0;
+            DWORD chunk = static_cast<DWORD>(std::min<size_t>(n, size_t(1) << 30));
+            if (!WriteFile(file, p, chunk, &written, nullptr)) {
+                throw std::runtime_error("wal: write failed");
+            }
+#else
+            ssize_t written = ::write(fd, p, n);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error("wal: write failed");
+            }
+#endif
+            p += written;
+            n -= static_cast<size_t>(written);
+        }
+    }
+
+    void sync_file()
+    {
+#ifdef _WIN32
+        bool ok = FlushFileBuffers(file);
+#elif defined(__APPLE__)
+        bool ok = ::fsync(fd) == 0;
+#else
+        bool ok = ::fdatasync(fd) == 0;
+#endif
+        if (!ok) {
+            throw std::runtime_error("wal: sync failed");
+        }
+    }
+
+    void close()
+    {
+#ifdef _WIN32
+        if (file != INVALID_HANDLE_VALUE) {
+            CloseHandle(file);
+        }
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        fd = -1;
+#endif
+    }
+
+    wal_options options;
+    uint64_t schema;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+#else
+    int fd = -1;
+#endif
+    // Serializes the writes of frames, so they reach the file in the order of their sequence numbers.
+    std::mutex io;
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable committed;
+    // The frame being filled, it starts with room for its header.
+    std::vector<std::byte> pending;
+    std::vector<std::byte> spare;
+    uint32_t pending_records = 0;
+    uint64_t last_sequence;
+    uint64_t durable;
+    std::exception_ptr failure;
+    bool stopping = false;
+    std::thread flusher;
+};
+
+/**
+ * @brief A frame of a log found intact by wal_reader.
+ */
+struct wal_frame {
+    size_t offset;
+    uint32_t payload_size;
+    uint32_t records;
+    uint64_t first_sequence;
+
+    uint64_t last_sequence() const
+    {
+        return first_sequence + records - 1;
+    }
+};
+
+/**
+ * @brief Reads a write-ahead log from a read-only memory mapping.
+ * @note The frames are chained by their headers first, then their checksums are verified in parallel.
+ * The log ends before the first frame which is torn, corrupted or does not continue the sequence numbers,
+ * everything behind it is treated as never committed.
+ */
+class wal_reader {
+public:
+    /**
+     * @brief Checks whether a log with a complete header exists at the path.
+     */
+    static bool exists(const std::string& path)
+    {
+        std::error_code error;
+        return std::filesystem::file_size(path, error) >= sizeof(wal_format::header) && !error;
+    }
+
+    /**
+     * @throws std::runtime_error If the file is not a log of the expected version and schema.
+     */
+    wal_reader(const std::string& path, uint64_t schema, thread_pool& pool = default_thread_pool()) : file(path)
+    {
+        if (file.size() < sizeof(wal_format::header)) {
+            throw std::runtime_error("wal: truncated header");
+        }
+        wal_format::header h;
+        std::memcpy(&h, file.data(), sizeof(h));
+        if (std::memcmp(h.magic, wal_format::magic, sizeof(h.magic)) != 0) {
+            throw std::runtime_error("wal: not a graph_db log");
+        }
+        if (h.version != wal_format::version || h.byte_order != wal_format::byte_order) {
+            throw std::runtime_error("wal: unsupported version or byte order");
+        }
+        if (h.schema != schema) {
+            throw std::runtime_error("wal: schema mismatch");
+        }
+        base = h.base_sequence;
+
+        size_t offset = sizeof(h);
+        uint64_t next = base + 1;
+        while (file.size() - offset >= sizeof(wal_format::frame_header)) {
+            wal_format::frame_header f;
+            std::memcpy(&f, file.data() + offset, sizeof(f));
+            if (f.magic != wal_format::frame_magic || f.records == 0 || f.first_sequence != next
+                || f.payload_size > file.size() - offset - sizeof(f)) {
+                break;
+            }
+            frame_list.push_back({ offset + sizeof(f), f.payload_size, f.records, f.first_sequence });
+            offset += sizeof(f) + f.payload_size;
+            next += f.records;
+        }
+
+        std::vector<uint8_t> intact(frame_list.size(), 0);
+        pool.parallel_for(0, frame_list.size(), 1, [&](size_t b, size_t e) {
+            for (size_t i = b; i < e; ++i) {
+                const wal_frame& frame = frame_list[i];
+                wal_format::frame_header f;
+                std::memcpy(&f, file.data() + frame.offset - sizeof(f), sizeof(f));
+                uint32_t checksum = f.checksum;
+                f.checksum = 0;
+                intact[i] = checksum == crc32c(file.data() + frame.offset, frame.payload_size, crc32c(&f, sizeof(f)));
+            }
+        });
+        frame_list.resize(static_cast<size_t>(std::find(intact.begin(), intact.end(), 0) - intact.begin()));
+    }
+
+    /**
+     * @brief Returns the sequence number the log continues after.
+     */
+    uint64_t base_sequence() const
+    {
+        return base;
+    }
+
+    /**
+     * @brief Returns the sequence number of the last intact record, or the base one if there is none.
+     */
+    uint64_t last_sequence() const
+    {
+        return frame_list.empty() ? base : frame_list.back().last_sequence();
+    }
+
+    /**
+     * @brief Returns the length of the log up to the end of its last intact frame.
+     */
+    uint64_t valid_length() const
+    {
+        return frame_list.empty() ? sizeof(wal_format::header) : frame_list.back().offset + frame_list.back().payload_size;
+    }
+
+    const std::vector<wal_frame>& frames() const
+    {
+        return frame_list;
+    }
+
+    /**
+     * @brief Returns a decoder over the records of a frame.
+     */
+    wal_decoder records(const wal_frame& frame) const
+    {
+        const std::byte* payload = file.data() + frame.offset;
+        return wal_decoder(payload, payload + frame.payload_size);
+    }
+
+private:
+    mapped_file file;
+    uint64_t base = 0;
+    std::vector<wal_frame> frame_list;
+};
+
+#endif // !WAL_HPP